@@ -0,0 +1,18 @@
+namespace Processes {
+	class AddressIndex { // Address-sorted intervals for the thread start addresses, stacks, TEBs, heaps and image base of a process. These are attributed to subregions in a single merge-join pass over the address-sorted subregion list.
+	public:
+		AddressIndex(const Process& OwnerProc);
+		std::vector<std::vector<Thread*>> Attribute(Memory::RegionTable& Regions) const; // Sets the flags column of the region table and returns the threads whose start address falls within each subregion. The table must be sorted by base address and non-overlapping, as it is when produced by VirtualQueryEx
+		size_t GetIntervalCount() const { return this->Intervals.size(); }
+	protected:
+		struct Interval {
+			const uint8_t* Start;
+			const uint8_t* End; // Exclusive
+			uint64_t Flag; // Subregion flag raised by an overlap, or 0 for a thread start address
+			Thread* Owner;
+		};
+
+		void Add(const void* pStart, const void* pEnd, uint64_t qwFlag, Thread* Owner);
+		std::vector<Interval> Intervals;
+	};
+}
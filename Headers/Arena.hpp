@@ -0,0 +1,35 @@
+class Arena { // Thread-safe monotonic allocator owning the objects produced by the scan of a single process. Objects are never freed individually: their destructors are run (in reverse order of construction) and all of their memory is released at once when the arena is destroyed.
+public:
+	Arena(size_t cbBlockSize = 0x10000);
+	virtual ~Arena();
+	void* Allocate(size_t cbSize, size_t cbAlignment);
+	uint64_t GetAllocationCount() const { return this->AllocationCount; }
+	size_t GetReservedSize() const { return this->ReservedSize; }
+	size_t GetBlockCount() const { return this->Blocks.size(); }
+
+	template<typename Object_t, typename... Args_t> Object_t* New(Args_t&&... Args) {
+		Object_t* NewObject = new (this->Allocate(sizeof(Object_t), alignof(Object_t))) Object_t(std::forward<Args_t>(Args)...);
+
+		if (!std::is_trivially_destructible<Object_t>::value) { // Registered only once construction has succeeded: an object which threw from its constructor is never destroyed
+			std::lock_guard<std::mutex> Guard(this->Lock);
+			Destructor NewDestructor = { NewObject, [](void* pObject) { static_cast<Object_t*>(pObject)->~Object_t(); } };
+			this->Destructors.push_back(NewDestructor);
+		}
+
+		return NewObject;
+	}
+protected:
+	struct Destructor {
+		void* Object;
+		void(*Destroy)(void*);
+	};
+
+	std::vector<uint8_t*> Blocks;
+	std::vector<Destructor> Destructors;
+	uint8_t* Cursor;
+	uint8_t* Limit;
+	size_t BlockSize;
+	size_t ReservedSize;
+	uint64_t AllocationCount;
+	std::mutex Lock;
+};
@@ -0,0 +1,44 @@
+enum class HashAlgorithm_t {
+	Unknown = 0,
+	Sha1,
+	Sha256
+};
+
+enum class AuthenticodeStatus_t {
+	NotImage = 0,
+	Unsigned, // No certificate table
+	Unsupported, // A signature which could not be parsed or uses an unknown digest algorithm
+	Modified, // The image digest differs from the signed digest
+	Intact
+};
+
+struct AuthenticodeSignature {
+	HashAlgorithm_t Algorithm;
+	std::vector<uint8_t> SignedDigest; // Image digest held by the SPC_INDIRECT_DATA content of the signature
+	std::wstring Signer; // Subject of the signer certificate
+	std::wstring Issuer;
+	AuthenticodeSignature() : Algorithm(HashAlgorithm_t::Unknown) {}
+};
+
+class Authenticode { // Self-contained Authenticode hashing and embedded signature parsing, usable without WinVerifyTrust or the catalog admin API. Matching digests shows that an image is unmodified since signing, but the certificate chain and the signature itself are not validated. All methods are reentrant.
+public:
+	static bool HashImage(const uint8_t* pImage, size_t cbImage, HashAlgorithm_t Algorithm, std::vector<uint8_t>& Digest);
+	static bool ParseSignature(const uint8_t* pImage, size_t cbImage, AuthenticodeSignature& Signature);
+	static AuthenticodeStatus_t CheckImage(const uint8_t* pImage, size_t cbImage, AuthenticodeSignature& Signature); // Parses the embedded signature and compares its digest to that of the image
+#ifdef _WIN32
+	static bool HashFile(const wchar_t* FilePath, HashAlgorithm_t Algorithm, std::vector<uint8_t>& Digest); // Implemented in AuthenticodeFile.cpp
+	static AuthenticodeStatus_t CheckFile(const wchar_t* FilePath, AuthenticodeSignature& Signature);
+#endif
+protected:
+	struct ImageLayout {
+		size_t ChecksumOffset;
+		size_t SecurityDirOffset; // Zero when the optional header has no security directory
+		size_t CertTableOffset;
+		size_t CertTableSize;
+	};
+
+	static bool GetLayout(const uint8_t* pImage, size_t cbImage, ImageLayout& Layout);
+#ifdef _WIN32
+	static bool MapFile(const wchar_t* FilePath, const std::function<void(const uint8_t*, size_t)>& Callback);
+#endif
+};
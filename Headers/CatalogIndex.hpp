@@ -0,0 +1,30 @@
+class CatalogIndex { // Sorted table of the member hashes of every catalog in a catalog store, so that finding the catalog which signs a file is a binary search of its hash rather than a catalog admin query. Parsing a catalog uses no Windows API and can be done on any platform.
+public:
+	struct Catalog {
+		std::wstring Path;
+		std::wstring Issuer; // Simple display name of the issuer of the catalog signer certificate
+	};
+
+	struct Member {
+		uint8_t Digest[32];
+		uint8_t DigestSize;
+		uint32_t CatalogIndex;
+		bool operator<(const Member& Other) const;
+	};
+
+	bool AddCatalog(const std::wstring& Path, const uint8_t* pData, size_t cbData); // Adds the members of one catalog file, returning false if it could not be parsed
+#ifdef _WIN32
+	size_t AddFolder(const std::wstring& Folder); // Adds every .cat file within the folder and its subfolders. Implemented in CatalogIndexFolder.cpp
+#endif
+	void Finalize(); // Sorts the members once every catalog has been added
+	const Catalog* Find(const uint8_t* pDigest, size_t cbDigest) const;
+	size_t GetCatalogCount() const { return this->Catalogs.size(); }
+	size_t GetMemberCount() const { return this->Members.size(); }
+	bool HasDigestSize(size_t cbDigest) const;
+#ifdef _WIN32
+	static const CatalogIndex& GetSystemIndex(); // Built from the system catalog store on first use
+#endif
+protected:
+	std::vector<Catalog> Catalogs;
+	std::vector<Member> Members;
+};
@@ -0,0 +1,16 @@
+namespace Der { // Minimal reader for the DER encoded ASN.1 of PKCS #7 and X.509 structures: single byte tags and definite lengths only
+	struct Element {
+		uint8_t Tag;
+		const uint8_t* Data;
+		size_t Size;
+	};
+
+	static const uint8_t Integer = 0x02, BitString = 0x03, OctetString = 0x04, Oid = 0x06, Sequence = 0x30, Set = 0x31, Context0 = 0xA0;
+
+	bool Next(const uint8_t** ppData, const uint8_t* pEnd, Element& Target); // Reads the element at the cursor and advances past it
+	bool Children(const Element& Parent, std::vector<Element>& Elements);
+	std::wstring String(const Element& Target);
+	std::wstring NameDisplay(const Element& Name); // Simple display name of an X.509 name
+	template<size_t nSize> bool IsOid(const Element& Target, const uint8_t(&Value)[nSize]) { return Target.Tag == Oid && Target.Size == nSize && memcmp(Target.Data, Value, nSize) == 0; }
+	bool Equal(const Element& First, const Element& Second);
+}
@@ -0,0 +1,39 @@
+class HashDigest { // Streaming Merkle-Damgard hash over 64 byte blocks. Instances are not shared between threads, so any number of files may be hashed in parallel.
+public:
+	HashDigest() : cbBuffered(0), qwTotalSize(0) {}
+	virtual ~HashDigest() {}
+	void Update(const uint8_t* pData, size_t cbData);
+	void Final(uint8_t* pDigest); // Writes GetSize() bytes
+	virtual size_t GetSize() const = 0;
+	static const size_t BlockSize = 64;
+protected:
+	virtual void Compress(const uint8_t* pBlocks, size_t nBlockCount) = 0;
+	virtual void Output(uint8_t* pDigest) const = 0;
+	uint8_t Buffer[BlockSize];
+	size_t cbBuffered;
+	uint64_t qwTotalSize;
+};
+
+class Sha1Digest : public HashDigest {
+public:
+	Sha1Digest();
+	size_t GetSize() const { return Size; }
+	static const size_t Size = 20;
+protected:
+	void Compress(const uint8_t* pBlocks, size_t nBlockCount);
+	void Output(uint8_t* pDigest) const;
+	uint32_t State[5];
+};
+
+class Sha256Digest : public HashDigest {
+public:
+	Sha256Digest();
+	size_t GetSize() const { return Size; }
+	static const size_t Size = 32;
+	static bool IsAccelerated(); // True when the CPU supports the SHA extensions
+protected:
+	void Compress(const uint8_t* pBlocks, size_t nBlockCount);
+	void Output(uint8_t* pDigest) const;
+	void CompressShaNi(const uint8_t* pBlocks, size_t nBlockCount);
+	uint32_t State[8];
+};
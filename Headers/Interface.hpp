@@ -14,6 +14,22 @@ public:
 		Yellow = 14
 	};
 
+	class OutputCapture { // Holds the formatted output of a single unit of work (such as one process scan) so that it may be written to the log as one atomic block at a later time
+	public:
+		void Append(const char* Text, bool bColored, ConsoleColor Color);
+		void Flush();
+		bool IsEmpty() const { return this->Segments.empty(); }
+	protected:
+		struct Segment {
+			std::string Text;
+			bool Colored;
+			ConsoleColor Color;
+		};
+
+		std::vector<Segment> Segments;
+		std::mutex Lock; // Work spawned by the owner of the capture may log from other threads
+	};
+
 	static void Initialize(std::wstring LogFilePath, VerbosityLevel Vlvl = Interface::VerbosityLevel::Surface);
 	static void Initialize(VerbosityLevel Vlvl = Interface::VerbosityLevel::Surface);
 	static void Initialize(std::vector<std::wstring> &Args);
@@ -24,7 +40,12 @@ public:
 	static void SetVerbosity(VerbosityLevel Vlvl) { Interface::VerbosityLvl = Vlvl; }
 	static void EnumColors();
 	static void AlignStr(const wchar_t* pOriginalStr, wchar_t* pAlignedStr, int32_t nAlignTo);
+	static OutputCapture* GetCapture() { return Interface::ActiveCapture; }
+	static OutputCapture* SetCapture(OutputCapture* Capture); // Redirects all output from the calling thread into the capture (nullptr restores direct output). Returns the previous capture.
 private:
+	static bool Write(const char* Text, bool bColored, ConsoleColor Color);
+	static thread_local OutputCapture* ActiveCapture;
+	static std::mutex WriteLock;
 	static std::wstring LogFilePath;
 	static HANDLE Handle;
 	static VerbosityLevel VerbosityLvl;
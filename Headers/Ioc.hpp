@@ -21,16 +21,21 @@ protected:
 	const Memory::Subregion* Sbr;
 	const Processes::Process* ParentProcess;
 	Ioc::Type IocType;
+	const Processes::LoaderList::Module* LoaderModule; // Set only for a loader entry with no allocation at its base, which has neither a parent object nor a subregion
 public:
 	Ioc::Type GetType() const { return this->IocType; }
 	static std::wstring GetDescription(Ioc::Type Type);
 	static bool InspectEntity(Processes::Process& ParentProc, Memory::Entity& ParentObj, std::map <uint8_t*, std::map<uint8_t*, std::list<Ioc *>>> * IocMap);
+	static int32_t InspectLoaderList(Processes::Process& ParentProc, std::map <uint8_t*, std::map<uint8_t*, std::list<Ioc *>>>* IocMap); // Raises an IOC for each loader entry without an image at its base, returning their count
 	static void EnumerateMap(std::map <uint8_t*, std::map<uint8_t*, std::list<Ioc *>>> *IocMap);
 	bool IsFullEntityIoc() const { return (this->Sbr == nullptr ? true : false); }
+	bool IsProcessIoc() const { return (this->ParentObject == nullptr ? true : false); }
 	Ioc(Processes::Process* ParentProc, Memory::Entity* Parent, Memory::Subregion* Block, Ioc::Type Type);
+	Ioc(Processes::Process* ParentProc, const Processes::LoaderList::Module* Module, Ioc::Type Type);
 	const Memory::Entity* GetParentObject() const { return this->ParentObject; }
 	const Memory::Subregion* GetSubregion() const { return this->Sbr; }
 	const Processes::Process* GetProcess() const { return this->ParentProcess; }
+	const Processes::LoaderList::Module* GetLoaderModule() const { return this->LoaderModule; }
 };
 
 class IocMap {
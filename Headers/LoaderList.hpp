@@ -0,0 +1,27 @@
+namespace Processes {
+	class LoaderList { // The modules linked into the loader data of a process, walked once from its PEB rather than by a psapi query per module (each of which walks the remote list again)
+	public:
+		struct Module {
+			uint64_t Base;
+			uint64_t EntryPoint;
+			uint32_t ImageSize;
+			std::wstring Name;
+			std::wstring Path;
+			bool InLoadOrder; // Linked into the load order list
+			bool InMemoryOrder; // Linked into the memory order list
+		};
+
+		typedef std::function<bool(uint64_t qwAddress, void* pBuf, size_t cbSize)> Reader_t; // Reads remote memory: the process page cache in practice, or any buffer laid out as a loader list
+		bool Walk32(const Reader_t& Read, uint64_t qwPeb); // Walks the list of a 32-bit PEB (a Wow64 process, or any process in a 32-bit build)
+		bool Walk64(const Reader_t& Read, uint64_t qwPeb);
+		const Module* Find(const void* pBase) const;
+		const std::unordered_map<uint64_t, Module>& GetModules() const { return this->Modules; }
+	protected:
+		static const size_t MaxEntries = 0x2000; // A list corrupted into a cycle which does not return to its head ends here
+		static const uint32_t MaxNameSize = 0x1000;
+		template<typename Peb_t, typename LdrData_t, typename Entry_t, typename Pointer_t> bool Walk(const Reader_t& Read, uint64_t qwPeb);
+		template<typename Entry_t, typename Pointer_t> size_t WalkList(const Reader_t& Read, uint64_t qwHead, size_t nLinksOffset, bool bLoadOrder);
+		static std::wstring ReadName(const Reader_t& Read, uint64_t qwBuffer, uint16_t wLength);
+		std::unordered_map<uint64_t, Module> Modules; // Keyed by DllBase
+	};
+}
@@ -6,7 +6,6 @@ public:
 	MemDump(HANDLE hProcess, uint32_t dwPid);
 	bool Create(const MEMORY_BASIC_INFORMATION *, wchar_t* DumpFilePath, size_t ccDumpFilePathLen) const;
 	bool Create(std::wstring Folder, const MEMORY_BASIC_INFORMATION *, wchar_t* DumpFilePath, size_t ccDumpFilePathLen) const;
-	bool Create(const MEMORY_BASIC_INFORMATION* Mbi, uint8_t** ppDmpBuf, uint32_t* pdwDmpSize) const;
 	uint32_t GetPid() const { return this->Pid; }
 	static bool Initialize();
 protected:
@@ -8,36 +8,115 @@ typedef class Thread;
 typedef class MemDump;
 typedef class FileBase;
 typedef class PeFile;
+typedef class PeImage;
 typedef enum class Signing_t;
 
 namespace Processes {
 	typedef class Thread;
 	typedef class Process;
+	typedef class LoaderList;
 }
 
 namespace Memory {
-	class Subregion {
+	class PageBitmap { // Packed bitmap holding one bit per 4KB page of a subregion
+	public:
+		PageBitmap() : PageCount(0) {}
+		void Resize(size_t nPageCount);
+		void Set(size_t nPage) { this->Words[nPage / 64] |= (1ULL << (nPage % 64)); }
+		bool Test(size_t nPage) const { return (this->Words[nPage / 64] & (1ULL << (nPage % 64))) ? true : false; }
+		size_t Count() const;
+		std::vector<std::pair<size_t, size_t>> GetRuns() const; // Coalesces set pages into runs of first page index and page count, in ascending order
+		size_t GetPageCount() const { return this->PageCount; }
 	protected:
-		const MEMORY_BASIC_INFORMATION* Basic;
-		std::vector<Processes::Thread*> Threads;
-		uint32_t PrivateSize;
+		std::vector<uint64_t> Words;
+		size_t PageCount;
+	};
+
+	class PageAttributeProvider { // Source of working set attributes for pages in a remote process. Abstracted so that the number of queries made for a scan can be measured and replaced.
+	public:
+		virtual bool Query(HANDLE hProcess, PSAPI_WORKING_SET_EX_INFORMATION* pPages, size_t nPageCount) = 0; // The virtual address of each entry must be set by the caller
+		uint64_t GetQueryCount() const { return this->QueryCount; }
+		uint64_t GetPageCount() const { return this->PageCount; }
+		PageAttributeProvider() : QueryCount(0), PageCount(0) {}
+		virtual ~PageAttributeProvider() {}
+	protected:
+		std::atomic<uint64_t> QueryCount;
+		std::atomic<uint64_t> PageCount;
+	};
+
+	class WorkingSetProvider : public PageAttributeProvider { // Queries all of the pages requested in a single K32QueryWorkingSetEx call
+	public:
+		bool Query(HANDLE hProcess, PSAPI_WORKING_SET_EX_INFORMATION* pPages, size_t nPageCount);
+	};
+
+	class RegionTable { // Columnar table of the basic information, flags and private size of every subregion of a process. Subregions are thin handles into it, so passes over many subregions read contiguous columns rather than chasing a pointer per subregion.
+	public:
+		size_t Append(const MEMORY_BASIC_INFORMATION& Mbi);
+		size_t GetCount() const { return this->Bases.size(); }
+		size_t Find(const void* pAddress) const; // Returns the index of the subregion containing the address, or the row count if there is none
+		MEMORY_BASIC_INFORMATION GetBasic(size_t nIndex) const;
+		uint8_t* GetBase(size_t nIndex) const { return this->Bases[nIndex]; }
+		SIZE_T GetSize(size_t nIndex) const { return this->Sizes[nIndex]; }
+		uint8_t* GetAllocationBase(size_t nIndex) const { return this->AllocationBases[nIndex]; }
+		uint32_t GetProtect(size_t nIndex) const { return this->Protects[nIndex]; }
+		uint32_t GetAllocationProtect(size_t nIndex) const { return this->AllocationProtects[nIndex]; }
+		uint32_t GetType(size_t nIndex) const { return this->Types[nIndex]; }
+		uint32_t GetState(size_t nIndex) const { return this->States[nIndex]; }
+		uint64_t GetFlags(size_t nIndex) const { return this->Flags[nIndex]; }
+		void SetFlags(size_t nIndex, uint64_t qwFlags) { this->Flags[nIndex] = qwFlags; }
+		uint32_t GetPrivateSize(size_t nIndex) const { return this->PrivateSizes[nIndex]; }
+		void SetPrivateSize(size_t nIndex, uint32_t dwPrivateSize) { this->PrivateSizes[nIndex] = dwPrivateSize; }
+		void ExecutableMask(size_t nFirst, size_t nCount, uint8_t* pMask) const; // Sets each byte of the mask to 1 where the subregion at that index is executable, otherwise 0
+		bool AnyFlag(size_t nFirst, size_t nCount, uint64_t qwFlag) const;
+		bool AnyExecutable(size_t nFirst, size_t nCount) const;
+	protected:
+		std::vector<uint8_t*> Bases;
+		std::vector<SIZE_T> Sizes;
+		std::vector<uint8_t*> AllocationBases;
+		std::vector<uint32_t> Protects;
+		std::vector<uint32_t> AllocationProtects;
+		std::vector<uint32_t> Types;
+		std::vector<uint32_t> States;
+		std::vector<uint64_t> Flags;
+		std::vector<uint32_t> PrivateSizes;
+	};
+
+	class Subregion { // A handle to one row of the region table of a process, along with its threads and private page bitmap
+	protected:
+		RegionTable* Table;
+		size_t Index;
+		std::vector<Processes::Thread*> Threads; // Non-owning: the threads belong to the thread table of the owner process
+		PageBitmap PrivatePages; // Pages of the subregion which are not shared (for example copy-on-write pages of an image which have been written to)
 		HANDLE ProcessHandle;
-		uint64_t Flags;
 	public:
-		Subregion(Processes::Process& OwnerProc, const MEMORY_BASIC_INFORMATION* Mbi);
+		Subregion(Processes::Process& OwnerProc, RegionTable* Table, size_t nIndex, const std::vector<Processes::Thread*>& Threads);
 		virtual ~Subregion();
-		const MEMORY_BASIC_INFORMATION* GetBasic() const { return this->Basic; }
+		MEMORY_BASIC_INFORMATION GetBasic() const { return this->Table->GetBasic(this->Index); }
+		void* GetBase() const { return this->Table->GetBase(this->Index); }
+		SIZE_T GetSize() const { return this->Table->GetSize(this->Index); }
+		void* GetAllocationBase() const { return this->Table->GetAllocationBase(this->Index); }
+		uint32_t GetProtect() const { return this->Table->GetProtect(this->Index); }
+		uint32_t GetAllocationProtect() const { return this->Table->GetAllocationProtect(this->Index); }
+		uint32_t GetMemoryType() const { return this->Table->GetType(this->Index); }
+		uint32_t GetState() const { return this->Table->GetState(this->Index); }
+		size_t GetIndex() const { return this->Index; }
+		const RegionTable* GetTable() const { return this->Table; }
 		std::vector<Processes::Thread*> GetThreads() const { return this->Threads; }
-		void SetPrivateSize(uint32_t dwPrivateSize) { this->PrivateSize = dwPrivateSize; }
-		uint32_t GetPrivateSize() const { return this->PrivateSize; }
-		uint32_t QueryPrivateSize() const;
-		uint64_t GetFlags() const { return this->Flags; }
-		void SetFlags(uint64_t qwFlags) { this->Flags = qwFlags; }
+		uint32_t GetPrivateSize() const { return this->Table->GetPrivateSize(this->Index); }
+		const PageBitmap& GetPrivatePages() const { return this->PrivatePages; }
+		bool QueryPrivatePages();
+		uint64_t GetFlags() const { return this->Table->GetFlags(this->Index); }
 		static const wchar_t* ProtectSymbol(uint32_t dwProtect);
 		static const wchar_t* AttribDesc(const MEMORY_BASIC_INFORMATION* Mbi);
 		static const wchar_t* TypeSymbol(uint32_t dwType);
 		static const wchar_t* StateSymbol(uint32_t dwState);
 		static bool PageExecutable(uint32_t dwProtect);
+		static uint64_t GetThreadOpensSaved() { return ThreadOpensSaved; }
+		static PageAttributeProvider* GetPageProvider() { return PageProvider; }
+		static void SetPageProvider(PageAttributeProvider* Provider) { PageProvider = Provider; }
+	protected:
+		static std::atomic<uint64_t> ThreadOpensSaved; // Each thread reference taken from the process thread table replaces a re-open and re-query of that thread
+		static PageAttributeProvider* PageProvider;
 	};
 
 	class Entity {
@@ -87,11 +166,31 @@ namespace Memory {
 			 uint8_t* PeData;
 		};
 
-		typedef class Section;
+		class Body;
+
+		class Section { // A view of one section of a PE body: its header and the range of the subregions of the body which overlap it. Sections do not own subregions of their own.
+		public:
+			Section(const Body* Parent, const IMAGE_SECTION_HEADER* SectHdr, uint32_t dwSectionSize, size_t nFirstSubregion, size_t nSubregionCount);
+			const IMAGE_SECTION_HEADER* GetHeader() const { return this->Hdr; }
+			std::vector<Subregion*> GetSubregions() const;
+			const void* GetStartVa() const; // The base of the first overlapping subregion
+			uint32_t GetEntitySize() const { return this->SectionSize; }
+			size_t GetFirstSubregion() const { return this->FirstSubregion; }
+			size_t GetSubregionCount() const { return this->SubregionCount; }
+		protected:
+			const Body* Parent;
+			const IMAGE_SECTION_HEADER* Hdr; // Owned by the shared PE image of the parent body
+			size_t FirstSubregion;
+			size_t SubregionCount;
+			uint32_t SectionSize;
+		};
+
 		class Body : public MappedFile, public Component {
+			friend class Section;
 		protected:
-			std::vector<Section*> Sections;
-			::PeFile* FilePe;
+			std::vector<Section> Sections;
+			std::vector<std::vector<size_t>> SubregionSections; // Indexes of the sections overlapping each subregion of the body, in section header order
+			std::shared_ptr<const PeImage> Image;
 			Signing_t Signed;
 			bool NonExecutableImage;
 			bool PartiallyMapped;
@@ -106,7 +205,7 @@ namespace Memory {
 				std::wstring GetPath() const { return this->Path; }
 				std::wstring GetName() const { return this->Name; }
 				uint32_t GetSize() const { return this->Info.SizeOfImage; }
-				PebModule(HANDLE hProcess, const uint8_t* pModBase);
+				PebModule(const Processes::LoaderList* Loader, const uint8_t* pModBase);
 				bool Exists() const { return (this->Missing ? false : true); }
 			protected:
 				MODULEINFO Info;
@@ -116,28 +215,19 @@ namespace Memory {
 			} PebMod;
 		public:
 			Entity::Type GetType() { return Entity::Type::PE_FILE; }
-			::PeFile* GetPeFile() const { return this->FilePe; }
+			const ::PeFile* GetPeFile() const;
 			bool IsSigned() const;
 			Signing_t GetSisningType() const;
 			bool IsNonExecutableImage() const { return this->NonExecutableImage; }
 			bool IsPartiallyMapped() const { return this->PartiallyMapped; }
-			std::vector<Section*> GetSections() const { return Sections; }
-			Section* GetSection(std::string) const;
+			const std::vector<Section>& GetSections() const { return Sections; }
+			const Section* GetSection(std::string) const;
 			PebModule& GetPebModule() { return PebMod; }
-			std::vector<Section*> FindOverlapSect(Subregion& Address);
+			std::vector<const Section*> FindOverlapSect(size_t nSubregionIndex) const;
 			uint32_t GetImageSize() const { return this->ImageSize; }
 			uint32_t GetSigningLevel() const { return this->SigningLevel; }
 			Body(Processes::Process& OwnerProc, std::vector<Subregion*> Subregions, const wchar_t* FilePath);
 			virtual ~Body();
 		};
-
-		class Section : public Component {
-		public:
-			Section(HANDLE hProcess, std::vector<Subregion*> Subregions, IMAGE_SECTION_HEADER* SectHdr, uint8_t* pPeBuf);
-			const IMAGE_SECTION_HEADER* GetHeader() { return &this->Hdr; }
-			Entity::Type GetType() { return Entity::Type::PE_SECTION; }
-		protected:
-			IMAGE_SECTION_HEADER Hdr;
-		};
 	}
 }
\ No newline at end of file
@@ -84,6 +84,45 @@ typedef struct _RTL_USER_PROCESS_PARAMETERS64
     PTR64                   Environment;                   //0x80
 } RTL_USER_PROCESS_PARAMETERS64;
 
+typedef struct _PEB_LDR_DATA64
+{
+    DWORD                   Length;                        //0x00
+    BYTE                    Initialized[4];                //0x04
+    PTR64                   SsHandle;                      //0x08
+    LIST_ENTRY64            InLoadOrderModuleList;         //0x10
+    LIST_ENTRY64            InMemoryOrderModuleList;       //0x20
+    LIST_ENTRY64            InInitializationOrderModuleList; //0x30
+    PTR64                   EntryInProgress;               //0x40
+} PEB_LDR_DATA64;
+
+//NOTE: the members of this structure are not yet complete
+typedef struct _LDR_DATA_TABLE_ENTRY64
+{
+    LIST_ENTRY64            InLoadOrderLinks;              //0x00
+    LIST_ENTRY64            InMemoryOrderLinks;            //0x10
+    LIST_ENTRY64            InInitializationOrderLinks;    //0x20
+    PTR64                   DllBase;                       //0x30
+    PTR64                   EntryPoint;                    //0x38
+    DWORD                   SizeOfImage;                   //0x40
+    UNICODE_STRING64        FullDllName;                   //0x48
+    UNICODE_STRING64        BaseDllName;                   //0x58
+} LDR_DATA_TABLE_ENTRY64;
+
+//NOTE: the members of this structure are not yet complete. The layout is that of an NT heap segment from Vista onward: the first segment of a heap is the
+//_HEAP itself, and every segment of the heap is linked by its SegmentListEntry
+typedef struct _HEAP_SEGMENT64
+{
+    BYTE                    Entry[0x10];                   //0x00
+    DWORD                   SegmentSignature;              //0x10
+    DWORD                   SegmentFlags;                  //0x14
+    LIST_ENTRY64            SegmentListEntry;              //0x18
+    PTR64                   Heap;                          //0x28
+    PTR64                   BaseAddress;                   //0x30
+    DWORD                   NumberOfPages;                 //0x38
+    PTR64                   FirstEntry;                    //0x40
+    PTR64                   LastValidEntry;                //0x48
+} HEAP_SEGMENT64;
+
 //
 // PEB64 structure - TODO: comb more through http://terminus.rewolf.pl/terminus/structures/ntdll/_PEB_x64.html and add OS delineations and Windows 10 updates
 //
@@ -189,7 +228,8 @@ struct PEB64
 struct TEB64
 {
     void* ExceptionList;                              //0x0000 / Current Structured Exception Handling (SEH) frame
-    void* StackBase;
+    void* StackBase;                                  //0x0008 / Bottom of stack (high address)
+    void* StackLimit;                                 //0x0010 / Ceiling of stack (low address)
     //uint32_t StackBase;                                  //0x0004 / Bottom of stack (high address)
     //uint32_t StackLimit;                                 //0x0008 / Ceiling of stack (low address)
     /*
@@ -534,17 +574,51 @@ typedef struct _RTL_DRIVE_LETTER_CURDIR
     STRING     DosPath;
 } RTL_DRIVE_LETTER_CURDIR;
 
-typedef struct _PEB_LDR_DATA32
+typedef struct _PEB_LDR_DATA32 // Pointers are held as 32-bit values so that the layout is the same in a 64-bit build reading a Wow64 process
 {
     DWORD          Length;                             //0x00
     BYTE           Initialized[4];                     //0x04
-    void* SsHandle;                           //0x08
-    LIST_ENTRY     InLoadOrderModuleList;              //0x0C
-    LIST_ENTRY     InMemoryOrderModuleList;            //0x14
-    LIST_ENTRY     InInitializationOrderModuleList;    //0x1C
-    void* EntryInProgress;                    //0x24
+    uint32_t       SsHandle;                           //0x08
+    LIST_ENTRY32   InLoadOrderModuleList;              //0x0C
+    LIST_ENTRY32   InMemoryOrderModuleList;            //0x14
+    LIST_ENTRY32   InInitializationOrderModuleList;    //0x1C
+    uint32_t       EntryInProgress;                    //0x24
 } PEB_LDR_DATA32;
 
+struct UNICODE_STRING32
+{
+    WORD           Length;                             //0x00
+    WORD           MaximumLength;                      //0x02
+    uint32_t       Buffer;                             //0x04
+};
+
+//NOTE: the members of this structure are not yet complete
+typedef struct _LDR_DATA_TABLE_ENTRY32
+{
+    LIST_ENTRY32   InLoadOrderLinks;                   //0x00
+    LIST_ENTRY32   InMemoryOrderLinks;                 //0x08
+    LIST_ENTRY32   InInitializationOrderLinks;         //0x10
+    uint32_t       DllBase;                            //0x18
+    uint32_t       EntryPoint;                         //0x1C
+    DWORD          SizeOfImage;                        //0x20
+    UNICODE_STRING32 FullDllName;                      //0x24
+    UNICODE_STRING32 BaseDllName;                      //0x2C
+} LDR_DATA_TABLE_ENTRY32;
+
+//NOTE: the members of this structure are not yet complete
+typedef struct _HEAP_SEGMENT32
+{
+    BYTE           Entry[0x8];                         //0x00
+    DWORD          SegmentSignature;                   //0x08
+    DWORD          SegmentFlags;                       //0x0C
+    LIST_ENTRY32   SegmentListEntry;                   //0x10
+    uint32_t       Heap;                               //0x18
+    uint32_t       BaseAddress;                        //0x1C
+    DWORD          NumberOfPages;                      //0x20
+    uint32_t       FirstEntry;                         //0x24
+    uint32_t       LastValidEntry;                     //0x28
+} HEAP_SEGMENT32;
+
 typedef struct PEB_FREE_BLOCK PEB_FREE_BLOCK;
 struct PEB_FREE_BLOCK
 {
@@ -0,0 +1,33 @@
+class PrefixTrie { // Case insensitive map of path prefixes to replacement prefixes. A prefix only matches at a path component boundary, so that \Device\HarddiskVolume1 does not match \Device\HarddiskVolume10, and the longest matching prefix wins.
+public:
+	PrefixTrie();
+	void Insert(const std::wstring& Prefix, const std::wstring& Replacement);
+	bool Rewrite(const wchar_t* Path, wchar_t* OutputPath, size_t ccOutputPath) const; // Does not allocate: fails if no prefix matches or the output buffer is too small
+	size_t GetCount() const { return this->Replacements.size(); }
+protected:
+	struct Node {
+		wchar_t Char;
+		uint32_t FirstChild;
+		uint32_t NextSibling;
+		int32_t Replacement; // Index of the replacement for a prefix ending at this node, or -1
+	};
+
+	std::vector<Node> Nodes; // The root is the first node. Child and sibling links of zero are null since the root can never be either.
+	std::vector<std::wstring> Replacements;
+};
+
+class PathCanonicalizer { // Translation of NT device paths to DOS paths and of native paths to their Wow64 equivalents. The tables are built once per scan and may be injected directly, so that no lookup touches the object manager or the environment.
+public:
+	void AddDevice(const std::wstring& DevicePrefix, const std::wstring& DosPrefix); // e.g. \Device\HarddiskVolume3 -> C:
+	void AddWow64Redirect(const std::wstring& NativePrefix, const std::wstring& Wow64Prefix); // e.g. C:\Windows\System32 -> C:\Windows\SysWOW64
+	bool TranslateDevicePath(const wchar_t* DevicePath, wchar_t* TranslatedPath, size_t ccTranslatedPath) const;
+	bool Wow64Redirect(const wchar_t* TargetFilePath, wchar_t* OutputPath, size_t ccOutputPath) const; // Copies paths outside of the redirected folders unchanged
+	size_t GetDeviceCount() const { return this->Devices.GetCount(); }
+	size_t GetRedirectCount() const { return this->Redirects.GetCount(); }
+#ifdef _WIN32
+	static const PathCanonicalizer& GetSystem(); // Built from the DOS devices and the native system folders on first use. Implemented in PathCanonicalizerSystem.cpp
+#endif
+protected:
+	PrefixTrie Devices;
+	PrefixTrie Redirects;
+};
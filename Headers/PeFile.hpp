@@ -7,33 +7,34 @@ protected:
 	uint32_t Size;
 	uint16_t PeMagic;
 	uint16_t PeArch;
-	PeFile(const uint8_t* pPeBuf, uint32_t dwPeFileSize);
+	PeFile(std::unique_ptr<uint8_t[]> PeBuf, uint32_t dwPeFileSize); // Takes ownership of the buffer rather than copying it
+	static PeFile* Load(std::unique_ptr<uint8_t[]> PeBuf, uint32_t dwPeFileSize);
 public:
-	virtual bool IsPe32() = 0;
-	virtual bool IsPe64() = 0;
-	virtual uint16_t GetPeFileMagic() = 0;
-	virtual uint16_t GetPeFileArch() = 0;
+	virtual bool IsPe32() const = 0;
+	virtual bool IsPe64() const = 0;
+	virtual uint16_t GetPeFileMagic() const = 0;
+	virtual uint16_t GetPeFileArch() const = 0;
 	virtual bool Validate() = 0;
-	virtual bool GetDataDir(int8_t nIndex, uint32_t* pdwRva, uint32_t* pdwSize) = 0;
+	virtual bool GetDataDir(int8_t nIndex, uint32_t* pdwRva, uint32_t* pdwSize) const = 0;
 	virtual uint32_t RefreshCrc32() = 0;
 	virtual void SetCrc32(uint32_t dwCrc32) = 0;
 	virtual void SetDataDir(int8_t nIndex, uint32_t dwRva, uint32_t dwSize) = 0;
-	virtual uint32_t GetSubsystem() = 0;
-	virtual uint8_t* GetEntryPoint() = 0;
+	virtual uint32_t GetSubsystem() const = 0;
+	virtual uint8_t* GetEntryPoint() const = 0;
 	virtual void SetSubsystem(uint32_t dwSubSystem) = 0;
-	virtual void* GetImageBase() = 0;
+	virtual void* GetImageBase() const = 0;
 	virtual void SetImageBase(const void* pNewImageBase) = 0;
-	virtual uint16_t GetDllCharacteristics() = 0;
+	virtual uint16_t GetDllCharacteristics() const = 0;
 	virtual void SetDllCharacteristics(uint16_t wDllCharacteristics) = 0;
-	virtual uint32_t GetImageSize() = 0;
-	virtual bool IsDotNet() = 0;
+	virtual uint32_t GetImageSize() const = 0;
+	virtual bool IsDotNet() const = 0;
 	uint8_t* GetData() const { return this->Data; }
 	uint32_t GetSize() const { return this->Size; }
 	PIMAGE_DOS_HEADER GetDosHdr() const { return this->DosHdr; }
 	IMAGE_FILE_HEADER* GetFileHdr() const { return this->FileHdr; }
 	IMAGE_SECTION_HEADER* GetSectHdrs() const { return this->SectHdrs; }
-	bool IsExe();
-	bool IsDll();
+	bool IsExe() const;
+	bool IsDll() const;
 	virtual ~PeFile();
 	static PeFile* Load(const uint8_t* pPeBuf, uint32_t dwPeFileSize); // Factory
 	static PeFile* Load(const std::wstring PeFilePath); // Factory
@@ -44,39 +45,39 @@ template<typename NtHdrType> class PeArch : public PeFile {
 	// This derived class is appropriate for holding methods which are type-specific but can be handled with a simple difference in template, not something so fundamental that it must be placed in an architecture-specific sub class.
 protected:
 	NtHdrType* NtHdr;
-	PeArch(const uint8_t* pPeBuf, uint32_t dwPeFileSize);
+	PeArch(std::unique_ptr<uint8_t[]> PeBuf, uint32_t dwPeFileSize);
 public:
 	bool Validate();
-	NtHdrType* GetNtHdrs();
+	NtHdrType* GetNtHdrs() const;
 	uint32_t RefreshCrc32();
 	void SetCrc32(uint32_t dwCrc32);
-	bool GetDataDir(int8_t nIndex, uint32_t* pdwRva, uint32_t* pdwSize);
+	bool GetDataDir(int8_t nIndex, uint32_t* pdwRva, uint32_t* pdwSize) const;
 	void SetDataDir(int8_t nIndex, uint32_t dwRva, uint32_t dwSize);
-	uint32_t GetSubsystem();
+	uint32_t GetSubsystem() const;
 	void SetSubsystem(uint32_t dwSubSystem);
-	void* GetImageBase();
+	void* GetImageBase() const;
 	void SetImageBase(const void* pNewImageBase);
-	uint8_t* GetEntryPoint();
-	uint16_t GetDllCharacteristics();
+	uint8_t* GetEntryPoint() const;
+	uint16_t GetDllCharacteristics() const;
 	void SetDllCharacteristics(uint16_t wDllCharacteristics);
-	uint32_t GetImageSize();
-	bool IsDotNet();
+	uint32_t GetImageSize() const;
+	bool IsDotNet() const;
 };
 
 class PeArch32 : public PeArch<IMAGE_NT_HEADERS32> {
 public:
-	bool IsPe32() { return true; }
-	bool IsPe64() { return false; }
-	uint16_t GetPeFileMagic() { return IMAGE_NT_OPTIONAL_HDR32_MAGIC; }
-	uint16_t GetPeFileArch() { return IMAGE_FILE_MACHINE_I386; }
-	PeArch32(const uint8_t* pPeBuf, uint32_t dwPeFileSize);
+	bool IsPe32() const { return true; }
+	bool IsPe64() const { return false; }
+	uint16_t GetPeFileMagic() const { return IMAGE_NT_OPTIONAL_HDR32_MAGIC; }
+	uint16_t GetPeFileArch() const { return IMAGE_FILE_MACHINE_I386; }
+	PeArch32(std::unique_ptr<uint8_t[]> PeBuf, uint32_t dwPeFileSize);
 };
 
 class PeArch64 : public PeArch<IMAGE_NT_HEADERS64> {
 public:
-	bool IsPe32() { return false; }
-	bool IsPe64() { return true; }
-	uint16_t GetPeFileMagic() { return IMAGE_NT_OPTIONAL_HDR64_MAGIC; }
-	uint16_t GetPeFileArch() { return IMAGE_FILE_MACHINE_AMD64; }
-	PeArch64(const uint8_t* pPeBuf, uint32_t dwPeFileSize);
+	bool IsPe32() const { return false; }
+	bool IsPe64() const { return true; }
+	uint16_t GetPeFileMagic() const { return IMAGE_NT_OPTIONAL_HDR64_MAGIC; }
+	uint16_t GetPeFileArch() const { return IMAGE_FILE_MACHINE_AMD64; }
+	PeArch64(std::unique_ptr<uint8_t[]> PeBuf, uint32_t dwPeFileSize);
 };
\ No newline at end of file
@@ -0,0 +1,30 @@
+class PeImage { // Immutable parse of the headers of a PE file on disk together with the data derived from them. An image is shared by every entity which maps the same file, so nothing may modify it once it is built.
+public:
+	struct SectionExtent {
+		IMAGE_SECTION_HEADER Hdr;
+		uint32_t Size; // Virtual extent of the section: the larger of its raw and virtual sizes
+	};
+
+	PeImage(std::unique_ptr<PeFile> Pe);
+	const PeFile* GetPe() const { return this->Pe.get(); }
+	const std::vector<SectionExtent>& GetSections() const { return this->Sections; } // An artificial "Header" section followed by each section header of the file
+	const std::vector<size_t>& GetRvaOrder() const { return this->RvaOrder; } // Indexes of the sections ordered by RVA
+protected:
+	std::unique_ptr<PeFile> Pe;
+	std::vector<SectionExtent> Sections;
+	std::vector<size_t> RvaOrder;
+};
+
+class PeImageCache { // Scan-wide cache of parsed PE images keyed by file identity, so that a module mapped into many processes is read and parsed once. Concurrent loads of a file which is still being parsed wait on the same result.
+public:
+	static std::shared_ptr<const PeImage> Load(const wchar_t* FilePath); // Null if the file is not a valid PE
+	static void Clear();
+	static uint64_t GetHitCount() { return HitCount; }
+	static uint64_t GetMissCount() { return MissCount; }
+protected:
+	static std::shared_ptr<const PeImage> Parse(const wchar_t* FilePath);
+	static std::map<FileIdentity, std::shared_future<std::shared_ptr<const PeImage>>> Images;
+	static std::mutex Lock;
+	static std::atomic<uint64_t> HitCount;
+	static std::atomic<uint64_t> MissCount;
+};
@@ -0,0 +1,36 @@
+class PointerScan { // Finds every pointer-sized value within a buffer which falls in a target address range. The range test is done with SSE2 or AVX2 when the CPU supports it, selected once at runtime.
+public:
+	enum class Isa_t { Scalar, Sse2, Avx2 };
+	PointerScan(uint32_t dwPointerSize, bool bAligned); // Pointers are 4 bytes in Wow64 targets and 8 bytes otherwise. An aligned scan only tests offsets which are a multiple of the pointer size.
+	size_t Find(const uint8_t* pBuf, size_t cbBuf, const uint8_t* pRangeStart, uint32_t dwRangeSize, std::vector<uint32_t>& Offsets, size_t nMaxHits = 0) const; // A range size of 0 matches the start address exactly. Offsets are appended in ascending order, and a maximum hit count of 0 collects all of them.
+	template<typename Size_t> void SetTargets(const std::vector<std::pair<const uint8_t*, Size_t>>& Targets); // Each target is a start address and range size (0 for an exact address), of 32 or 64 bits. Targets may be given in any order and may overlap.
+	size_t FindTargets(const uint8_t* pBuf, size_t cbBuf, std::vector<std::pair<uint32_t, size_t>>& Hits) const; // Appends an offset and target index pair for each target matched by each pointer in the buffer, in ascending order of offset
+	uint32_t GetPointerSize() const { return this->PointerSize; }
+	static Isa_t GetIsa();
+	static void SetIsa(Isa_t Isa); // Overrides the detected instruction set, for example to compare the vectorized kernels against the scalar one
+	static const wchar_t* IsaSymbol(Isa_t Isa);
+protected:
+	struct Target {
+		uint64_t Start;
+		uint64_t End; // Exclusive
+		size_t Index; // Position of the target in the list it was set from
+		uint64_t MaxEnd; // Greatest end of this and all preceding targets, which bounds the backward walk over overlapping targets
+	};
+
+	struct Cluster { // A range of addresses holding some of the targets, scanned for by one pass of the kernel
+		uint64_t Low;
+		uint64_t Span;
+	};
+
+	// Scattered targets are split into a few clusters at the widest gaps between them, so that the vectorized filter is not reduced to a range spanning most of
+	// the address space. Each cluster costs a pass over the buffer, so their count is bounded.
+
+	static const size_t MaxClusters = 8;
+	static const uint64_t MinClusterGap = 0x100000;
+	uint32_t PointerSize;
+	bool Aligned;
+	std::vector<Target> Targets; // Sorted by start address
+	std::vector<Cluster> Clusters; // Sorted by address
+	static Isa_t DetectIsa();
+	static Isa_t SelectedIsa;
+};
@@ -0,0 +1,21 @@
+#pragma once
+
+// The subset of StdAfx.h used by the units which parse and hash files or rewrite paths without any Win32 API (DER, digests, Authenticode, the catalog index
+// and the path canonicalizer) so that they also build off Windows, for instance on the triage servers.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <wchar.h>
+#include <wctype.h>
+#include <assert.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <algorithm>
+#include <memory>
+#include <functional>
+#include <stdexcept>
+#include <locale>
+#include <codecvt>
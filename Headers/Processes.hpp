@@ -1,11 +1,13 @@
 #define PROCESS_ENUM_FLAG_MEMDUMP 0x1
 #define PROCESS_ENUM_FLAG_FROM_BASE 0x2
 #define PROCESS_ENUM_FLAG_STATISTICS 0x4
+#define PROCESS_ENUM_FLAG_REFERENCE_INDEX 0x8
 
 typedef enum class VerbosityLevel;
 typedef class Ioc;
 
 namespace Memory {
+	typedef class RegionTable;
 	typedef class Subregion;
 	typedef class Entity;
 
@@ -15,9 +17,13 @@ namespace Memory {
 	
 }
 typedef class MemDump;
+typedef class Arena;
 
 namespace Processes {
 	typedef class Process;
+	typedef class ReferenceIndex;
+	typedef class RemotePageCache;
+	typedef class LoaderList;
 }
 
 typedef class ScannerContext;
@@ -28,6 +34,7 @@ namespace Processes {
 		uint32_t GetTid() const { return this->Id; }
 		const void* GetEntryPoint() const { return this->StartAddress; }
 		const void* GetStackAddress() const { return this->StackAddress; }
+		const void* GetStackLimit() const { return this->StackLimit; }
 		const void* GetTebAddress() const { return this->TebAddress; }
 		HANDLE GetHandle() const { return this->Handle; }
 		Thread(uint32_t dwTid, Processes::Process& OwnerProc);
@@ -38,6 +45,27 @@ namespace Processes {
 		const void* StartAddress;
 		const void* TebAddress;
 		const void* StackAddress;
+		const void* StackLimit;
+	};
+
+	class SystemSnapshot { // A single bulk capture of every process and thread on the system. It is taken once per scan and shared read-only by every process mapped during it.
+	public:
+		struct ProcessEntry {
+			uint32_t Pid;
+			std::wstring Name;
+			std::wstring ImageFilePath;
+			std::vector<uint32_t> Tids;
+		};
+
+		bool Capture();
+		const ProcessEntry* GetProcess(uint32_t dwPid) const;
+		std::vector<uint32_t> GetPids() const { return this->Pids; }
+		size_t GetThreadCount() const { return this->ThreadCount; }
+		SystemSnapshot() : ThreadCount(0) {}
+	protected:
+		std::map<uint32_t, ProcessEntry> Entries;
+		std::vector<uint32_t> Pids; // PIDs in the order the system listed them
+		size_t ThreadCount;
 	};
 
 	class Process {
@@ -49,30 +77,43 @@ namespace Processes {
 		BOOL Wow64; // bool and BOOL translate to different sizes, IsWow64Process pointed at a bool will corrupt memory.
 		std::vector<Thread*> Threads;
 		std::vector<void*> Heaps;
+		std::vector<std::pair<void*, void*>> HeapSegments; // Start and exclusive end of each segment of each NT heap, including the first which holds the heap itself
 		MemDump* DmpCtx;
+		std::unique_ptr<Arena> Allocator; // Owns the threads, entities, subregions and IOC of the process, and releases them even when the constructor throws
+		Memory::RegionTable* Regions; // Basic information, flags and private size of every subregion of the process
+		ReferenceIndex* RefIndex; // Built on first use
+		RemotePageCache* PageCache; // Small structure reads made while mapping the process
+		LoaderList* Loader; // Modules linked into the PEB loader data, keyed by base
 		uint32_t ClrVersion;
 		void* ImageBase;
 		std::map<uint8_t*, Memory::Entity*> Entities; // A region can only map to one entity by design. If an allocation range has multiple entities in it (such as a PE) then these entities must be encompassed within the parent entity itself by design (such as PE sections)
 	public:
-		Process(uint32_t);
+		Process(uint32_t dwPid, const SystemSnapshot& Snapshot);
 		virtual ~Process();
 		HANDLE GetHandle() const { return this->Handle; }
 		uint32_t GetPid() const { return this->Pid; }
 		void* GetImageBase() const { return this->ImageBase; }
 		std::vector<void*> GetHeaps() const { return this->Heaps; }
+		const std::vector<std::pair<void*, void*>>& GetHeapSegments() const { return this->HeapSegments; }
 		std::vector<Thread*> GetThreads() const { return this->Threads; }
 		std::wstring GetName() const { return this->Name; }
 		std::wstring GetImageFilePath() const { return this->ImageFilePath; }
-		std::map<uint8_t*, Memory::Entity*> GetEntities() const { return this->Entities; }
+		const std::map<uint8_t*, Memory::Entity*>& GetEntities() const { return this->Entities; }
 		Memory::PeVm::Body* GetLoadedModule(std::wstring Name) const;
 		MemDump* GetDmpCtx() const { return this->DmpCtx; }
+		Arena* GetArena() const { return this->Allocator.get(); }
+		Memory::RegionTable* GetRegionTable() const { return this->Regions; }
+		RemotePageCache* GetPageCache() const { return this->PageCache; }
+		const LoaderList* GetLoaderList() const { return this->Loader; }
+		const ReferenceIndex* GetReferenceIndex();
 		bool DumpBlock(const MEMORY_BASIC_INFORMATION* Mbi, std::wstring Indent);
 		BOOL IsWow64() const { return this->Wow64; }
 		uint32_t GetClrVersion() const { return this->ClrVersion; }
 		void Enumerate(ScannerContext& ScannerCtx, std::vector<Ioc*>* SelectedIocs, std::vector<Memory::Subregion*>* SelectedSbrs);
-		bool CheckDotNetAffiliation(const uint8_t* pReferencedAddress, const uint32_t dwRegionSize) const;
-		int32_t SearchDllDataReferences(const uint8_t* pReferencedAddress, const uint32_t dwRegionSize) const;
+		std::vector<bool> CheckDotNetAffiliation(const std::vector<std::pair<const uint8_t*, uint32_t>>& Targets) const; // Targets are start address and region size pairs
+		int32_t SearchDllDataReferences(std::vector<int32_t>& RefCounts, const std::vector<std::pair<const uint8_t*, uint32_t>>& Targets) const;
 		int32_t SearchReferences(std::map <uint8_t*, std::vector<uint8_t*>>& ReferencesMap, const uint8_t* pReferencedAddress, const uint32_t dwRegionSize) const;
+		int32_t SearchReferences(std::vector<std::map <uint8_t*, std::vector<uint8_t*>>>& ReferenceMaps, const std::vector<std::pair<const uint8_t*, uint32_t>>& Targets) const; // Searches for all of the targets in a single pass over the address space, producing one reference map per target
 		static void EnumerateThreads(const std::wstring Indent, std::vector<Processes::Thread*> Threads);
 		static int32_t AppendOverlapIoc(std::map<uint8_t*, std::list<Ioc*>>* Iocs, uint8_t* pSubregionAddress, bool bEntityTop, std::vector<Ioc*>* SelectedIocs);
 		static int32_t AppendSubregionAttributes(Memory::Subregion* Sbr);
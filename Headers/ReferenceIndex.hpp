@@ -0,0 +1,39 @@
+namespace Processes {
+	class ReferenceIndex { // Reverse pointer index of a process: every aligned pointer-sized value within its committed memory which lands inside a committed region, sorted by the address it points to. Built once, it answers direct and transitive reference queries without re-reading the address space.
+	public:
+		ReferenceIndex(const Process& OwnerProc);
+		size_t Lookup(const uint8_t* pStart, uint32_t dwSize, std::vector<std::pair<const uint8_t*, const uint8_t*>>& References) const; // Appends the target and source address of each pointer into [pStart, pStart + dwSize), ordered by target. A size of 0 selects an exact address.
+		int32_t Search(std::map <uint8_t*, std::vector<uint8_t*>>& ReferencesMap, const uint8_t* pReferencedAddress, const uint32_t dwRegionSize, uint32_t dwDepth) const; // Fills the same entity to subregion map as Process::SearchReferences. Each additional level of depth adds the regions which reference a region selected by the previous one.
+		size_t GetReferenceCount() const { return this->ReferenceCount; }
+		size_t GetEncodedSize() const { return this->Encoded.size(); }
+	protected:
+		struct Block {
+			uint64_t FirstTarget;
+			size_t Offset; // Position of the first reference of the block within the encoded stream
+		};
+
+		// References are stored as variable length deltas in blocks of a fixed count. The first reference of each block is stored in full, so that a lookup only
+		// has to decode from the block preceding its start address.
+
+		static const size_t BlockSize = 64;
+
+		// While the index is built, the references of each entity are sorted and encoded the same way into runs of up to a fixed count, which are then merged
+		// into the blocks. Only one run of each task is held uncompressed at a time.
+
+		struct Run {
+			std::vector<uint8_t> Encoded;
+			size_t Count;
+		};
+
+		static const size_t RunSize = 0x100000;
+		static void EncodeRun(std::vector<std::pair<uint64_t, uint64_t>>& References, std::vector<Run>& Runs); // Sorts and encodes the references into a new run, then empties them
+		static void EncodeValue(std::vector<uint8_t>& Stream, uint64_t qwValue);
+		static uint64_t DecodeValue(const uint8_t** ppStream);
+		static void EncodeEntry(std::vector<uint8_t>& Stream, uint64_t qwTarget, uint64_t qwSource, uint64_t qwPrevTarget, uint64_t qwPrevSource, bool bFirst);
+		static void DecodeEntry(const uint8_t** ppStream, uint64_t& qwTarget, uint64_t& qwSource, bool bFirst); // Updates the target and source of the previous entry to those of the next
+		const Process& OwnerProc;
+		std::vector<uint8_t> Encoded;
+		std::vector<Block> Blocks;
+		size_t ReferenceCount;
+	};
+}
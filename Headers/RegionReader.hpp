@@ -0,0 +1,52 @@
+#define REGION_READER_FLAG_SKIP_ZERO_PAGES 0x1 // Pages which are entirely zero are not returned, for consumers which search for non-zero values
+#define REGION_READER_FLAG_FILL_UNREADABLE 0x2 // Pages which cannot be read are returned zero filled rather than skipped, keeping the data contiguous (for example in a dump)
+
+class ReadBufferPool { // Page-aligned buffers of one chunk each, pooled per thread so that region reads reuse the same few allocations rather than allocating the size of each region
+public:
+	static const size_t ChunkSize = 0x100000;
+	static const size_t BufferSize = ChunkSize + 0x1000; // Room for the bytes carried over from the previous chunk
+	static uint8_t* Acquire();
+	static void Release(uint8_t* pBuf);
+	static uint64_t GetAllocationCount() { return AllocationCount; }
+protected:
+	static const size_t MaxPooledBuffers = 4; // Buffers beyond this count are freed when released, bounding the memory held by each thread
+	static std::atomic<uint64_t> AllocationCount;
+};
+
+class RegionReader { // Streams a region of memory in another process through a pooled chunk buffer as a series of contiguous runs of data. Each chunk is read in one call where possible, falling back to page by page reads around pages which cannot be read. Runs are extended by the overlap size into neighbouring skipped zero pages and the next chunk, so that a value spanning the boundary between two runs is still seen whole.
+public:
+	RegionReader(HANDLE hProcess, const void* pBase, size_t cbSize, size_t cbOverlap = 0, uint32_t dwFlags = 0);
+	virtual ~RegionReader();
+	bool Next(); // Advances to the next run of data, returning false once the end of the region has been reached
+	const uint8_t* GetData() const { return this->Data; }
+	size_t GetSize() const { return this->DataSize; }
+	size_t GetOffset() const { return this->DataOffset; } // Offset of the start of the current run within the region
+	const std::vector<std::pair<size_t, size_t>>& GetUnreadableRanges() const { return this->UnreadableRanges; } // Offset and size of each run of pages which could not be read
+	static uint64_t GetZeroPagesSkipped() { return ZeroPagesSkipped; }
+	static uint64_t GetUnreadablePageCount() { return UnreadablePageCount; }
+	static const size_t PageSize = 0x1000;
+protected:
+	enum class PageState_t : uint8_t { Data, Zero, Unreadable };
+	bool ReadChunk();
+	size_t GetPagePosition(size_t nPage) const { return this->Carried + nPage * PageSize; }
+	size_t GetPageEnd(size_t nPage) const { return std::min(this->GetPagePosition(nPage + 1), this->Carried + this->ChunkBytes); }
+	static bool IsZeroPage(const uint8_t* pPage, size_t cbSize);
+	HANDLE ProcessHandle;
+	const uint8_t* Base;
+	size_t RegionSize;
+	size_t Overlap;
+	uint32_t Flags;
+	uint8_t* Buf;
+	const uint8_t* Data;
+	size_t DataSize;
+	size_t DataOffset;
+	size_t Carried; // Bytes at the start of the buffer carried over from the end of the previous chunk
+	size_t ChunkOffset; // Offset of the current chunk within the region, excluding the carried bytes
+	size_t ChunkBytes;
+	std::vector<PageState_t> Pages; // State of each page of the current chunk
+	PageState_t PreviousState; // State of the last page of the previous chunk
+	size_t NextPage;
+	std::vector<std::pair<size_t, size_t>> UnreadableRanges;
+	static std::atomic<uint64_t> ZeroPagesSkipped;
+	static std::atomic<uint64_t> UnreadablePageCount;
+};
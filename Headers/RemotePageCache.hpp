@@ -0,0 +1,24 @@
+namespace Processes {
+	class RemotePageCache { // Serves the small structure reads made while mapping a process (PEB, heap list, TEBs, loader data) from copies of the pages they fall within. The missing pages of a read are fetched together in a single call, so that neighbouring structures and repeated reads of the same page cost no further system calls.
+	public:
+		RemotePageCache(HANDLE hProcess);
+		bool Read(const void* pAddress, void* pBuf, size_t cbSize);
+		template<typename Field_t> bool ReadField(const void* pStruct, size_t nOffset, Field_t& Value) { return this->Read(static_cast<const uint8_t*>(pStruct) + nOffset, &Value, sizeof(Value)); } // Reads a single field of a remote structure, typically located with offsetof
+		void Clear();
+		static uint64_t GetHitCount() { return HitCount; }
+		static uint64_t GetMissCount() { return MissCount; }
+		static uint64_t GetSyscallsSaved() { return ReadCount > SyscallCount ? ReadCount - SyscallCount : 0; } // Relative to one call per read
+		static const size_t PageSize = 0x1000;
+	protected:
+		static const size_t MaxCoalescedPages = 16; // Larger reads bypass the cache
+		static const size_t MaxCachedPages = 256; // The cache is emptied when it grows beyond this count
+		bool FetchPages(uintptr_t qwFirstPage, size_t nPageCount);
+		HANDLE ProcessHandle;
+		std::unordered_map<uintptr_t, std::unique_ptr<uint8_t[]>> Pages; // Keyed by page address. A null page could not be read.
+		std::mutex Lock; // Entities may read through the cache of their process while being constructed in parallel
+		static std::atomic<uint64_t> HitCount;
+		static std::atomic<uint64_t> MissCount;
+		static std::atomic<uint64_t> ReadCount;
+		static std::atomic<uint64_t> SyscallCount;
+	};
+}
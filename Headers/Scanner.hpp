@@ -13,11 +13,37 @@ public:
 	const uint8_t* GetAddress() const { return this->Address; }
 	const uint32_t GetRegionSize() const { return this->RegionSize; }
 	const uint64_t GetFilters() const { return this->Filters; }
-	ScannerContext(uint64_t qwFlags, MemorySelection_t Mst, uint8_t* pAddress, uint32_t dwRegionSize, uint64_t qwFilters) : Flags(qwFlags), Mst(Mst), Address(pAddress), RegionSize(dwRegionSize), Filters(qwFilters) {}
+	const uint32_t GetReferenceDepth() const { return this->ReferenceDepth; }
+	ScannerContext(uint64_t qwFlags, MemorySelection_t Mst, uint8_t* pAddress, uint32_t dwRegionSize, uint64_t qwFilters, uint32_t dwReferenceDepth) : Flags(qwFlags), Mst(Mst), Address(pAddress), RegionSize(dwRegionSize), Filters(qwFilters), ReferenceDepth(dwReferenceDepth) {}
 protected:
 	const uint64_t Flags;
 	const MemorySelection_t Mst;
 	const uint8_t* Address;
 	const uint32_t RegionSize;
 	const uint64_t Filters;
+	const uint32_t ReferenceDepth; // Levels of referencing regions selected by the "referenced" memory selection
+};
+
+typedef class PermissionRecord;
+typedef class IocRecord;
+
+namespace Processes {
+	typedef class SystemSnapshot;
+}
+
+class ProcessScanner { // Maps and enumerates a list of processes, optionally as tasks on the shared task pool. Output is always written in target list order, one process at a time.
+public:
+	ProcessScanner(ScannerContext& ScannerCtx, const Processes::SystemSnapshot& Snapshot);
+	virtual ~ProcessScanner();
+	void Scan(const std::vector<uint32_t>& Targets);
+	const PermissionRecord* GetPermissionRecords() const { return this->PermissionRecords; }
+	const IocRecord* GetIocRecords() const { return this->IocRecords; }
+protected:
+	struct ScanSlot;
+	void ScanTarget(ScanSlot& Slot);
+	void MergeRecords(ScanSlot& Slot);
+	ScannerContext& ScannerCtx;
+	const Processes::SystemSnapshot& Snapshot;
+	PermissionRecord* PermissionRecords;
+	IocRecord* IocRecords;
 };
\ No newline at end of file
@@ -6,4 +6,25 @@ enum class Signing_t {
 
 Signing_t CheckSigning(const wchar_t* TargetFilePath);
 const wchar_t* TranslateSigningLevel(uint32_t dwSigningLevel);
-const wchar_t* TranslateSigningType(Signing_t Type);
\ No newline at end of file
+const wchar_t* TranslateSigningType(Signing_t Type);
+
+struct FileIdentity { // Identifies the content of a file independently of the path it was opened by: a file which is replaced or modified has a new identity
+	uint32_t VolumeSerial;
+	uint64_t FileId;
+	uint64_t LastWriteTime;
+	uint64_t FileSize;
+	bool operator<(const FileIdentity& Other) const { return std::tie(this->VolumeSerial, this->FileId, this->LastWriteTime, this->FileSize) < std::tie(Other.VolumeSerial, Other.FileId, Other.LastWriteTime, Other.FileSize); }
+	static bool Query(const wchar_t* FilePath, FileIdentity& Identity);
+};
+
+class SigningCache { // Scan-wide results of CheckSigning keyed by file identity, so that a module loaded into many processes is verified once. Concurrent lookups of a file which is still being verified wait on the same result.
+public:
+	static Signing_t Check(const wchar_t* FilePath);
+	static uint64_t GetHitCount() { return HitCount; }
+	static uint64_t GetMissCount() { return MissCount; }
+protected:
+	static std::map<FileIdentity, std::shared_future<Signing_t>> Results;
+	static std::mutex Lock;
+	static std::atomic<uint64_t> HitCount;
+	static std::atomic<uint64_t> MissCount;
+};
\ No newline at end of file
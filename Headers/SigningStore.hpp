@@ -0,0 +1,36 @@
+class SigningStore { // Signing verdicts persisted between runs in a memory-mapped file, as an open-addressed hash table of file identities. A file which has changed since its verdict was stored no longer matches its record, which is replaced once the file has been verified again.
+public:
+	static bool Open(const wchar_t* FilePath);
+	static void Close();
+	static bool IsOpen() { return Records != nullptr; }
+	static bool Lookup(const FileIdentity& Identity, Signing_t& Signed);
+	static void Store(const FileIdentity& Identity, Signing_t Signed);
+	static uint64_t GetHitCount() { return HitCount; }
+	static uint64_t GetStoreCount() { return StoreCount; }
+protected:
+	struct Header {
+		uint32_t Signature;
+		uint32_t Version;
+		uint32_t SlotCount;
+		uint32_t Reserved;
+	};
+
+	struct Record {
+		FileIdentity Identity;
+		uint32_t Occupied;
+		uint32_t Signed;
+	};
+
+	static const uint32_t StoreSignature = 0x4749534D; // MSIG
+	static const uint32_t StoreVersion = 1;
+	static const uint32_t SlotCount = 0x10000;
+	static const uint32_t MaxProbes = 32; // A verdict which finds no free slot within this distance of its hash is not stored
+	static uint32_t Hash(const FileIdentity& Identity); // Covers only the volume and file ID, so that the record of a changed file is found and replaced
+	static HANDLE FileHandle;
+	static HANDLE MappingHandle;
+	static Header* StoreHdr;
+	static Record* Records;
+	static std::mutex Lock;
+	static std::atomic<uint64_t> HitCount;
+	static std::atomic<uint64_t> StoreCount;
+};
@@ -10,7 +10,9 @@ protected:
 	int32_t TotalRegions;
 public:
 	void UpdateMap(std::vector<Memory::Subregion*> SubregionRecords);
+	void Merge(const PermissionRecord& Records);
 	PermissionRecord(std::vector<Memory::Subregion*> SubregionRecords);
+	virtual ~PermissionRecord();
 	void ShowRecords() const;
 };
 
@@ -20,6 +22,8 @@ protected:
 	int32_t TotalIoc;
 public:
 	void UpdateMap(std::vector<Ioc*> *Records);
+	void Merge(const IocRecord& Records);
 	IocRecord(std::vector<Ioc*>* Records);
+	virtual ~IocRecord();
 	void ShowRecords() const;
 };
@@ -20,10 +20,26 @@
 #include <wincrypt.h>
 #include <wintrust.h>
 #include <list>
+#include <deque>
+#include <queue>
 #include <map>
+#include <unordered_set>
+#include <unordered_map>
 #include <string>
 #include <iostream>
 #include <vector>
 #include <algorithm>
 #include <codecvt>
+#include <memory>
+#include <bitset>
+#include <type_traits>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <future>
+#include <functional>
+#include <tuple>
+#include <intrin.h>
+#include <immintrin.h>
 #include "Typedefs.h"
\ No newline at end of file
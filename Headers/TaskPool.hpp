@@ -0,0 +1,59 @@
+class TaskGroup;
+
+class TaskPool { // Shared work-stealing scheduler used to parallelize a scan. Each worker owns a deque of tasks: it works LIFO from its own deque and steals FIFO from the deques of other workers when it runs dry.
+	friend class TaskGroup;
+public:
+	static void Initialize(uint32_t dwWorkerCount);
+	static void Shutdown();
+	static uint32_t GetWorkerCount();
+	static void ParallelFor(size_t nCount, const std::function<void(size_t)>& Task); // Invokes the task once for each index in [0, nCount) and returns once all of them have completed. The first exception thrown by a task is re-thrown to the caller.
+	static void OrderedFor(size_t nCount, const std::function<void(size_t)>& Task, const std::function<void(size_t)>& Retire); // Invokes the task once for each index as ParallelFor does, with the output of each redirected to a capture of its own. The calling thread then writes each capture to the log and retires its index in index order, so the output is that of a serial loop. An exception thrown by a task does not stop the others: the first one in index order is re-thrown once every index has been retired.
+	static void HelpUntil(const std::function<bool()>& Condition); // Executes pending tasks on the calling thread until the condition is met
+	static void Signal(); // Wakes threads blocked in HelpUntil so they may re-evaluate their condition
+protected:
+	struct Task {
+		std::function<void()> Routine;
+		TaskGroup* Group;
+		Interface::OutputCapture* Capture;
+		int32_t Depth; // Tasks may only be executed by a thread waiting on a shallower task. This bounds the nesting of stolen work on the stack of a waiting thread.
+	};
+
+	struct Worker {
+		std::deque<Task> Tasks;
+		std::mutex Lock;
+		uint64_t Executed;
+		uint64_t Stolen;
+	};
+
+	static void WorkerMain(uint32_t dwWorkerIndex);
+	static void Push(Task& NewTask);
+	static bool RunOne(int32_t nMinimumDepth);
+	static bool Pop(Task* pTask, int32_t nMinimumDepth);
+	static void RetireIndex(const std::function<void(size_t)>& Retire, size_t nIndex, std::exception_ptr& Error); // Retires an index of OrderedFor, keeping the first exception of the index
+	static std::vector<std::unique_ptr<Worker>> Workers;
+	static std::vector<std::thread> Threads;
+	static std::deque<Task> Injected; // Tasks pushed from threads which are not workers of the pool
+	static std::mutex InjectedLock;
+	static std::mutex IdleLock;
+	static std::condition_variable IdleSignal;
+	static std::atomic<uint64_t> Pending;
+	static std::atomic<bool> Stopping;
+	static thread_local int32_t CurrentWorker;
+	static thread_local int32_t CurrentDepth;
+};
+
+class TaskGroup { // A set of tasks which can be waited on as a unit. Waiting threads execute pending tasks rather than blocking.
+	friend class TaskPool;
+public:
+	TaskGroup();
+	virtual ~TaskGroup();
+	void Run(const std::function<void()>& Routine);
+	void Wait();
+	bool IsComplete() const { return this->Outstanding == 0; }
+protected:
+	void Complete(std::exception_ptr Error);
+	std::atomic<uint64_t> Outstanding;
+	std::exception_ptr Error;
+	std::mutex Lock;
+	int32_t Depth;
+};
@@ -0,0 +1,102 @@
+/*
+__________________________________________________________________________________________
+| _______  _____  __   _ _______ _______ _______                                         |
+| |  |  | |     | | \  | |______    |    |_____|                                         |
+| |  |  | |_____| |  \_| |______    |    |     |                                         |
+|________________________________________________________________________________________|
+| Moneta ~ Usermode memory scanner & malware hunter                                      |
+|----------------------------------------------------------------------------------------|
+| https://www.forrest-orr.net/post/malicious-memory-artifacts-part-ii-bypassing-scanners |
+|----------------------------------------------------------------------------------------|
+| Author: Forrest Orr - 2020                                                             |
+|----------------------------------------------------------------------------------------|
+| Contact: forrest.orr@protonmail.com                                                    |
+|----------------------------------------------------------------------------------------|
+| Licensed under GNU GPLv3                                                               |
+|________________________________________________________________________________________|
+| ## Features                                                                            |
+|                                                                                        |
+| ~ Query the memory attributes of any accessible process(es).                           |
+| ~ Identify private, mapped and image memory.                                           |
+| ~ Correlate regions of memory to their underlying file on disks.                       |
+| ~ Identify PE headers and sections corresponding to image memory.                      |
+| ~ Identify modified regions of mapped image memory.                                    |
+| ~ Identify abnormal memory attributes indicative of malware.                           |
+| ~ Create memory dumps of user-specified memory ranges                                  |
+| ~ Calculate memory permission/type statistics                                          |
+|________________________________________________________________________________________|
+
+*/
+
+#include "StdAfx.h"
+#include "Processes.hpp"
+#include "Memory.hpp"
+#include "AddressIndex.hpp"
+
+using namespace std;
+using namespace Memory;
+using namespace Processes;
+
+AddressIndex::AddressIndex(const Process& OwnerProc) {
+	vector<Thread*> Threads = OwnerProc.GetThreads();
+	vector<void*> Heaps = OwnerProc.GetHeaps();
+
+	for (vector<Thread*>::const_iterator ThItr = Threads.begin(); ThItr != Threads.end(); ++ThItr) {
+		this->Add((*ThItr)->GetEntryPoint(), static_cast<const uint8_t*>((*ThItr)->GetEntryPoint()) + 1, 0, *ThItr);
+		this->Add((*ThItr)->GetTebAddress(), static_cast<const uint8_t*>((*ThItr)->GetTebAddress()) + 1, MEMORY_SUBREGION_FLAG_TEB, *ThItr);
+
+		if ((*ThItr)->GetStackLimit() != nullptr && (*ThItr)->GetStackLimit() < (*ThItr)->GetStackAddress()) { // The full committed stack: StackLimit is its lowest address and StackBase is the exclusive upper bound
+			this->Add((*ThItr)->GetStackLimit(), (*ThItr)->GetStackAddress(), MEMORY_SUBREGION_FLAG_STACK, *ThItr);
+		}
+	}
+
+	for (vector<void*>::const_iterator HeapItr = Heaps.begin(); HeapItr != Heaps.end(); ++HeapItr) {
+		this->Add(*HeapItr, static_cast<const uint8_t*>(*HeapItr) + 1, MEMORY_SUBREGION_FLAG_HEAP, nullptr);
+	}
+
+	for (vector<pair<void*, void*>>::const_iterator SegItr = OwnerProc.GetHeapSegments().begin(); SegItr != OwnerProc.GetHeapSegments().end(); ++SegItr) { // Subregions within any segment of a heap belong to it, not only the one holding its base
+		this->Add(SegItr->first, SegItr->second, MEMORY_SUBREGION_FLAG_HEAP, nullptr);
+	}
+
+	this->Add(OwnerProc.GetImageBase(), static_cast<const uint8_t*>(OwnerProc.GetImageBase()) + 1, MEMORY_SUBREGION_FLAG_BASE_IMAGE, nullptr);
+
+	stable_sort(this->Intervals.begin(), this->Intervals.end(), [](const Interval& Left, const Interval& Right) { return Left.Start < Right.Start; }); // Stable so that threads sharing a start address keep their thread table order
+}
+
+void AddressIndex::Add(const void* pStart, const void* pEnd, uint64_t qwFlag, Thread* Owner) {
+	if (pStart != nullptr) { // Attributes which could not be queried are not indexed
+		Interval NewInterval = { static_cast<const uint8_t*>(pStart), static_cast<const uint8_t*>(pEnd), qwFlag, Owner };
+		this->Intervals.push_back(NewInterval);
+	}
+}
+
+vector<vector<Thread*>> AddressIndex::Attribute(RegionTable& Regions) const {
+	vector<vector<Thread*>> Results(Regions.GetCount());
+	vector<const Interval*> Active; // Intervals which began before the end of the current subregion and have not yet ended before its start
+	size_t nNextInterval = 0;
+
+	for (size_t nX = 0; nX < Regions.GetCount(); nX++) {
+		const uint8_t* pSubregionStartVa = Regions.GetBase(nX);
+		const uint8_t* pSubregionEndVa = pSubregionStartVa + Regions.GetSize(nX);
+		uint64_t qwFlags = 0;
+
+		for (; nNextInterval < this->Intervals.size() && this->Intervals[nNextInterval].Start < pSubregionEndVa; nNextInterval++) {
+			Active.push_back(&this->Intervals[nNextInterval]);
+		}
+
+		Active.erase(remove_if(Active.begin(), Active.end(), [pSubregionStartVa](const Interval* Candidate) { return Candidate->End <= pSubregionStartVa; }), Active.end()); // Subregions are address ordered: an interval which ended before this one will not overlap any which follow
+
+		for (vector<const Interval*>::const_iterator Itr = Active.begin(); Itr != Active.end(); ++Itr) {
+			if ((*Itr)->Flag) {
+				qwFlags |= (*Itr)->Flag;
+			}
+			else {
+				Results[nX].push_back((*Itr)->Owner);
+			}
+		}
+
+		Regions.SetFlags(nX, qwFlags);
+	}
+
+	return Results;
+}
@@ -0,0 +1,75 @@
+/*
+__________________________________________________________________________________________
+| _______  _____  __   _ _______ _______ _______                                         |
+| |  |  | |     | | \  | |______    |    |_____|                                         |
+| |  |  | |_____| |  \_| |______    |    |     |                                         |
+|________________________________________________________________________________________|
+| Moneta ~ Usermode memory scanner & malware hunter                                      |
+|----------------------------------------------------------------------------------------|
+| https://www.forrest-orr.net/post/malicious-memory-artifacts-part-ii-bypassing-scanners |
+|----------------------------------------------------------------------------------------|
+| Author: Forrest Orr - 2020                                                             |
+|----------------------------------------------------------------------------------------|
+| Contact: forrest.orr@protonmail.com                                                    |
+|----------------------------------------------------------------------------------------|
+| Licensed under GNU GPLv3                                                               |
+|________________________________________________________________________________________|
+| ## Features                                                                            |
+|                                                                                        |
+| ~ Query the memory attributes of any accessible process(es).                           |
+| ~ Identify private, mapped and image memory.                                           |
+| ~ Correlate regions of memory to their underlying file on disks.                       |
+| ~ Identify PE headers and sections corresponding to image memory.                      |
+| ~ Identify modified regions of mapped image memory.                                    |
+| ~ Identify abnormal memory attributes indicative of malware.                           |
+| ~ Create memory dumps of user-specified memory ranges                                  |
+| ~ Calculate memory permission/type statistics                                          |
+|________________________________________________________________________________________|
+
+*/
+
+#include "StdAfx.h"
+#include "Arena.hpp"
+
+using namespace std;
+
+Arena::Arena(size_t cbBlockSize) : Cursor(nullptr), Limit(nullptr), BlockSize(cbBlockSize), ReservedSize(0), AllocationCount(0) {}
+
+Arena::~Arena() {
+	for (vector<Destructor>::reverse_iterator Itr = this->Destructors.rbegin(); Itr != this->Destructors.rend(); ++Itr) {
+		Itr->Destroy(Itr->Object);
+	}
+
+	for (vector<uint8_t*>::const_iterator Itr = this->Blocks.begin(); Itr != this->Blocks.end(); ++Itr) {
+		delete[] *Itr;
+	}
+}
+
+void* Arena::Allocate(size_t cbSize, size_t cbAlignment) {
+	lock_guard<mutex> Guard(this->Lock);
+	uint8_t* pAligned;
+
+	this->AllocationCount++;
+
+	if (cbSize + cbAlignment > this->BlockSize) { // Objects larger than a block are given a dedicated block of their own, leaving the current block in use
+		uint8_t* pNewBlock = new uint8_t[cbSize + cbAlignment];
+
+		this->Blocks.push_back(pNewBlock);
+		this->ReservedSize += cbSize + cbAlignment;
+		return reinterpret_cast<uint8_t*>((reinterpret_cast<uintptr_t>(pNewBlock) + (cbAlignment - 1)) & ~static_cast<uintptr_t>(cbAlignment - 1));
+	}
+
+	pAligned = reinterpret_cast<uint8_t*>((reinterpret_cast<uintptr_t>(this->Cursor) + (cbAlignment - 1)) & ~static_cast<uintptr_t>(cbAlignment - 1));
+
+	if (this->Cursor == nullptr || pAligned + cbSize > this->Limit) {
+		uint8_t* pNewBlock = new uint8_t[this->BlockSize];
+
+		this->Blocks.push_back(pNewBlock);
+		this->ReservedSize += this->BlockSize;
+		this->Limit = pNewBlock + this->BlockSize;
+		pAligned = reinterpret_cast<uint8_t*>((reinterpret_cast<uintptr_t>(pNewBlock) + (cbAlignment - 1)) & ~static_cast<uintptr_t>(cbAlignment - 1));
+	}
+
+	this->Cursor = pAligned + cbSize;
+	return pAligned;
+}
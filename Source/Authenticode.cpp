@@ -0,0 +1,236 @@
+/*
+__________________________________________________________________________________________
+| _______  _____  __   _ _______ _______ _______                                         |
+| |  |  | |     | | \  | |______    |    |_____|                                         |
+| |  |  | |_____| |  \_| |______    |    |     |                                         |
+|________________________________________________________________________________________|
+| Moneta ~ Usermode memory scanner & malware hunter                                      |
+|----------------------------------------------------------------------------------------|
+| https://www.forrest-orr.net/post/malicious-memory-artifacts-part-ii-bypassing-scanners |
+|----------------------------------------------------------------------------------------|
+| Author: Forrest Orr - 2020                                                             |
+|----------------------------------------------------------------------------------------|
+| Contact: forrest.orr@protonmail.com                                                    |
+|----------------------------------------------------------------------------------------|
+| Licensed under GNU GPLv3                                                               |
+|________________________________________________________________________________________|
+| ## Features                                                                            |
+|                                                                                        |
+| ~ Query the memory attributes of any accessible process(es).                           |
+| ~ Identify private, mapped and image memory.                                           |
+| ~ Correlate regions of memory to their underlying file on disks.                       |
+| ~ Identify PE headers and sections corresponding to image memory.                      |
+| ~ Identify modified regions of mapped image memory.                                    |
+| ~ Identify abnormal memory attributes indicative of malware.                           |
+| ~ Create memory dumps of user-specified memory ranges                                  |
+| ~ Calculate memory permission/type statistics                                          |
+|________________________________________________________________________________________|
+
+*/
+
+#include "Portable.h"
+#include "Der.hpp"
+#include "Digest.hpp"
+#include "Authenticode.hpp"
+
+using namespace std;
+
+// The Authenticode digest of a PE covers the whole file except for the optional header checksum, the security data directory entry and the certificate
+// table that directory points to. The certificate table holds WIN_CERTIFICATE entries, the first of which is a PKCS #7 SignedData whose content is an
+// SPC_INDIRECT_DATA structure carrying the digest that was signed.
+
+static const uint8_t OidSignedData[] = { 0x2A, 0x86, 0x48, 0x86, 0xF7, 0x0D, 0x01, 0x07, 0x02 }; // 1.2.840.113549.1.7.2
+static const uint8_t OidIndirectData[] = { 0x2B, 0x06, 0x01, 0x04, 0x01, 0x82, 0x37, 0x02, 0x01, 0x04 }; // 1.3.6.1.4.1.311.2.1.4
+static const uint8_t OidSha1[] = { 0x2B, 0x0E, 0x03, 0x02, 0x1A }; // 1.3.14.3.2.26
+static const uint8_t OidSha256[] = { 0x60, 0x86, 0x48, 0x01, 0x65, 0x03, 0x04, 0x02, 0x01 }; // 2.16.840.1.101.3.4.2.1
+
+static const uint16_t CertTypePkcsSignedData = 0x0002; // WIN_CERT_TYPE_PKCS_SIGNED_DATA
+static const size_t CertHeaderSize = 8; // WIN_CERTIFICATE dwLength, wRevision and wCertificateType
+
+template<typename Field_t> static Field_t ReadField(const uint8_t* pImage, size_t nOffset) { // PE fields are little endian and may be unaligned within the file
+	Field_t Value;
+	memcpy(&Value, pImage + nOffset, sizeof(Value));
+	return Value;
+}
+
+bool Authenticode::GetLayout(const uint8_t* pImage, size_t cbImage, ImageLayout& Layout) {
+	size_t nNtHdrsOffset, nOptHdrOffset, nDataDirsOffset;
+	uint32_t dwDataDirCount;
+
+	if (cbImage < 0x40 || ReadField<uint16_t>(pImage, 0) != 0x5A4D) { // MZ
+		return false;
+	}
+
+	nNtHdrsOffset = ReadField<uint32_t>(pImage, 0x3C);
+	nOptHdrOffset = nNtHdrsOffset + 4 + 20; // Signature and IMAGE_FILE_HEADER
+
+	if (nNtHdrsOffset > cbImage || cbImage - nNtHdrsOffset < 24 + 2 || ReadField<uint32_t>(pImage, nNtHdrsOffset) != 0x00004550) { // PE\0\0
+		return false;
+	}
+
+	switch (ReadField<uint16_t>(pImage, nOptHdrOffset)) {
+		case 0x10B: nDataDirsOffset = nOptHdrOffset + 96; break; // IMAGE_NT_OPTIONAL_HDR32_MAGIC
+		case 0x20B: nDataDirsOffset = nOptHdrOffset + 112; break; // IMAGE_NT_OPTIONAL_HDR64_MAGIC
+		default: return false;
+	}
+
+	if (nDataDirsOffset > cbImage) {
+		return false;
+	}
+
+	Layout.ChecksumOffset = nOptHdrOffset + 64; // CheckSum is at the same offset in both optional header formats
+	Layout.SecurityDirOffset = 0;
+	Layout.CertTableOffset = 0;
+	Layout.CertTableSize = 0;
+	dwDataDirCount = ReadField<uint32_t>(pImage, nDataDirsOffset - 4);
+
+	if (dwDataDirCount > 4 && nDataDirsOffset + 5 * 8 <= cbImage) { // IMAGE_DIRECTORY_ENTRY_SECURITY
+		uint32_t dwCertOffset, dwCertSize;
+
+		Layout.SecurityDirOffset = nDataDirsOffset + 4 * 8;
+		dwCertOffset = ReadField<uint32_t>(pImage, Layout.SecurityDirOffset); // Unlike other directories this is a file offset rather than an RVA
+		dwCertSize = ReadField<uint32_t>(pImage, Layout.SecurityDirOffset + 4);
+
+		if (dwCertOffset && dwCertSize && dwCertOffset >= Layout.SecurityDirOffset + 8 && dwCertOffset <= cbImage && dwCertSize <= cbImage - dwCertOffset) {
+			Layout.CertTableOffset = dwCertOffset;
+			Layout.CertTableSize = dwCertSize;
+		}
+	}
+
+	return true;
+}
+
+bool Authenticode::HashImage(const uint8_t* pImage, size_t cbImage, HashAlgorithm_t Algorithm, vector<uint8_t>& Digest) {
+	ImageLayout Layout;
+	unique_ptr<HashDigest> Hash;
+
+	switch (Algorithm) {
+		case HashAlgorithm_t::Sha1: Hash = make_unique<Sha1Digest>(); break;
+		case HashAlgorithm_t::Sha256: Hash = make_unique<Sha256Digest>(); break;
+		default: return false;
+	}
+
+	if (!GetLayout(pImage, cbImage, Layout)) {
+		return false;
+	}
+
+	// Sections are contiguous in the file of any image produced by a linker, so hashing the remainder of the file linearly (excluding the certificate
+	// table) gives the same digest as hashing the headers followed by each section in order of its raw data offset.
+
+	Hash->Update(pImage, Layout.ChecksumOffset);
+
+	if (Layout.SecurityDirOffset) {
+		Hash->Update(pImage + Layout.ChecksumOffset + 4, Layout.SecurityDirOffset - (Layout.ChecksumOffset + 4));
+		Hash->Update(pImage + Layout.SecurityDirOffset + 8, (Layout.CertTableSize ? Layout.CertTableOffset : cbImage) - (Layout.SecurityDirOffset + 8));
+
+		if (Layout.CertTableSize) {
+			Hash->Update(pImage + Layout.CertTableOffset + Layout.CertTableSize, cbImage - (Layout.CertTableOffset + Layout.CertTableSize));
+		}
+	}
+	else {
+		Hash->Update(pImage + Layout.ChecksumOffset + 4, cbImage - (Layout.ChecksumOffset + 4));
+	}
+
+	Digest.resize(Hash->GetSize());
+	Hash->Final(Digest.data());
+	return true;
+}
+
+bool Authenticode::ParseSignature(const uint8_t* pImage, size_t cbImage, AuthenticodeSignature& Signature) {
+	ImageLayout Layout;
+	const uint8_t* pCursor;
+	uint32_t dwCertLength;
+	Der::Element ContentInfo;
+	vector<Der::Element> ContentInfoFields, Explicit, SignedData, Encapsulated, IndirectData, DigestInfo, AlgorithmId, SignerInfos, SignerInfo, IssuerAndSerial;
+
+	if (!GetLayout(pImage, cbImage, Layout) || Layout.CertTableSize < CertHeaderSize) {
+		return false;
+	}
+
+	dwCertLength = ReadField<uint32_t>(pImage, Layout.CertTableOffset);
+
+	if (dwCertLength <= CertHeaderSize || dwCertLength > Layout.CertTableSize || ReadField<uint16_t>(pImage, Layout.CertTableOffset + 6) != CertTypePkcsSignedData) {
+		return false;
+	}
+
+	// ContentInfo SEQUENCE { contentType, [0] SignedData SEQUENCE { version, digestAlgorithms, encapContentInfo, [0] certificates, [1] crls, signerInfos } }
+
+	pCursor = pImage + Layout.CertTableOffset + CertHeaderSize;
+
+	if (!Der::Next(&pCursor, pImage + Layout.CertTableOffset + dwCertLength, ContentInfo) || ContentInfo.Tag != Der::Sequence || !Der::Children(ContentInfo, ContentInfoFields) || ContentInfoFields.size() != 2 || !Der::IsOid(ContentInfoFields[0], OidSignedData)) {
+		return false;
+	}
+
+	if (!Der::Children(ContentInfoFields[1], Explicit) || Explicit.size() != 1 || !Der::Children(Explicit[0], SignedData) || SignedData.size() < 4) {
+		return false;
+	}
+
+	// SpcIndirectDataContent SEQUENCE { data SpcAttributeTypeAndOptionalValue, messageDigest DigestInfo SEQUENCE { digestAlgorithm, digest OCTET STRING } }
+
+	if (!Der::Children(SignedData[2], Encapsulated) || Encapsulated.size() != 2 || !Der::IsOid(Encapsulated[0], OidIndirectData) || !Der::Children(Encapsulated[1], Explicit) || Explicit.size() != 1) {
+		return false;
+	}
+
+	if (!Der::Children(Explicit[0], IndirectData) || IndirectData.size() != 2 || !Der::Children(IndirectData[1], DigestInfo) || DigestInfo.size() != 2 || DigestInfo[1].Tag != Der::OctetString) {
+		return false;
+	}
+
+	if (!Der::Children(DigestInfo[0], AlgorithmId) || AlgorithmId.empty()) {
+		return false;
+	}
+
+	if (Der::IsOid(AlgorithmId[0], OidSha1)) {
+		Signature.Algorithm = HashAlgorithm_t::Sha1;
+	}
+	else if (Der::IsOid(AlgorithmId[0], OidSha256)) {
+		Signature.Algorithm = HashAlgorithm_t::Sha256;
+	}
+	else {
+		Signature.Algorithm = HashAlgorithm_t::Unknown;
+	}
+
+	Signature.SignedDigest.assign(DigestInfo[1].Data, DigestInfo[1].Data + DigestInfo[1].Size);
+
+	// SignerInfo SEQUENCE { version, issuerAndSerialNumber SEQUENCE { issuer, serialNumber }, ... }. The signer certificate is the one within the
+	// certificates set with the same issuer and serial number: Certificate SEQUENCE { TBSCertificate SEQUENCE { [0] version, serialNumber, signature, issuer, validity, subject, ... } }
+
+	if (SignedData.back().Tag == Der::Set && Der::Children(SignedData.back(), SignerInfos) && !SignerInfos.empty() && Der::Children(SignerInfos[0], SignerInfo) && SignerInfo.size() >= 2) {
+		if (SignerInfo[1].Tag == Der::Sequence && Der::Children(SignerInfo[1], IssuerAndSerial) && IssuerAndSerial.size() == 2) {
+			vector<Der::Element> Certificates, Certificate, TbsCertificate;
+
+			Signature.Issuer = Der::NameDisplay(IssuerAndSerial[0]);
+
+			if (SignedData[3].Tag == Der::Context0 && Der::Children(SignedData[3], Certificates)) {
+				for (vector<Der::Element>::const_iterator CertItr = Certificates.begin(); CertItr != Certificates.end(); ++CertItr) {
+					if (Der::Children(*CertItr, Certificate) && !Certificate.empty() && Der::Children(Certificate[0], TbsCertificate) && !TbsCertificate.empty()) {
+						size_t nSerial = (TbsCertificate[0].Tag == Der::Context0) ? 1 : 0; // The version is optional and defaults to v1
+
+						if (TbsCertificate.size() > nSerial + 4 && Der::Equal(TbsCertificate[nSerial], IssuerAndSerial[1]) && Der::Equal(TbsCertificate[nSerial + 2], IssuerAndSerial[0])) {
+							Signature.Signer = Der::NameDisplay(TbsCertificate[nSerial + 4]);
+							break;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+AuthenticodeStatus_t Authenticode::CheckImage(const uint8_t* pImage, size_t cbImage, AuthenticodeSignature& Signature) {
+	ImageLayout Layout;
+	vector<uint8_t> Digest;
+
+	if (!GetLayout(pImage, cbImage, Layout)) {
+		return AuthenticodeStatus_t::NotImage;
+	}
+	else if (!Layout.CertTableSize) {
+		return AuthenticodeStatus_t::Unsigned;
+	}
+	else if (!ParseSignature(pImage, cbImage, Signature) || !HashImage(pImage, cbImage, Signature.Algorithm, Digest)) {
+		return AuthenticodeStatus_t::Unsupported;
+	}
+
+	return (Digest == Signature.SignedDigest) ? AuthenticodeStatus_t::Intact : AuthenticodeStatus_t::Modified;
+}
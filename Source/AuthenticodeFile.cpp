@@ -0,0 +1,77 @@
+/*
+__________________________________________________________________________________________
+| _______  _____  __   _ _______ _______ _______                                         |
+| |  |  | |     | | \  | |______    |    |_____|                                         |
+| |  |  | |_____| |  \_| |______    |    |     |                                         |
+|________________________________________________________________________________________|
+| Moneta ~ Usermode memory scanner & malware hunter                                      |
+|----------------------------------------------------------------------------------------|
+| https://www.forrest-orr.net/post/malicious-memory-artifacts-part-ii-bypassing-scanners |
+|----------------------------------------------------------------------------------------|
+| Author: Forrest Orr - 2020                                                             |
+|----------------------------------------------------------------------------------------|
+| Contact: forrest.orr@protonmail.com                                                    |
+|----------------------------------------------------------------------------------------|
+| Licensed under GNU GPLv3                                                               |
+|________________________________________________________________________________________|
+| ## Features                                                                            |
+|                                                                                        |
+| ~ Query the memory attributes of any accessible process(es).                           |
+| ~ Identify private, mapped and image memory.                                           |
+| ~ Correlate regions of memory to their underlying file on disks.                       |
+| ~ Identify PE headers and sections corresponding to image memory.                      |
+| ~ Identify modified regions of mapped image memory.                                    |
+| ~ Identify abnormal memory attributes indicative of malware.                           |
+| ~ Create memory dumps of user-specified memory ranges                                  |
+| ~ Calculate memory permission/type statistics                                          |
+|________________________________________________________________________________________|
+
+*/
+
+#include "StdAfx.h"
+#include "Authenticode.hpp"
+
+using namespace std;
+
+// File access for the Authenticode engine. The hashing and parsing themselves are portable and live in Authenticode.cpp: only the mapping of an image file
+// into memory is Win32 specific.
+
+bool Authenticode::MapFile(const wchar_t* FilePath, const function<void(const uint8_t*, size_t)>& Callback) { // The view is hashed directly so the file is streamed through the page cache rather than copied into a buffer
+	HANDLE hFile, hMapping;
+	LARGE_INTEGER FileSize = { 0 };
+	bool bResult = false;
+
+	if ((hFile = CreateFileW(FilePath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr)) != INVALID_HANDLE_VALUE) {
+		if (GetFileSizeEx(hFile, &FileSize) && FileSize.QuadPart > 0 && static_cast<uint64_t>(FileSize.QuadPart) <= SIZE_MAX) {
+			if ((hMapping = CreateFileMappingW(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr)) != nullptr) {
+				const uint8_t* pView;
+
+				if ((pView = static_cast<const uint8_t*>(MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0))) != nullptr) {
+					Callback(pView, static_cast<size_t>(FileSize.QuadPart));
+					bResult = true;
+					UnmapViewOfFile(pView);
+				}
+
+				CloseHandle(hMapping);
+			}
+		}
+
+		CloseHandle(hFile);
+	}
+
+	return bResult;
+}
+
+bool Authenticode::HashFile(const wchar_t* FilePath, HashAlgorithm_t Algorithm, vector<uint8_t>& Digest) {
+	bool bHashed = false;
+
+	MapFile(FilePath, [&](const uint8_t* pImage, size_t cbImage) { bHashed = HashImage(pImage, cbImage, Algorithm, Digest); });
+	return bHashed;
+}
+
+AuthenticodeStatus_t Authenticode::CheckFile(const wchar_t* FilePath, AuthenticodeSignature& Signature) {
+	AuthenticodeStatus_t Status = AuthenticodeStatus_t::NotImage;
+
+	MapFile(FilePath, [&](const uint8_t* pImage, size_t cbImage) { Status = CheckImage(pImage, cbImage, Signature); });
+	return Status;
+}
@@ -0,0 +1,169 @@
+/*
+__________________________________________________________________________________________
+| _______  _____  __   _ _______ _______ _______                                         |
+| |  |  | |     | | \  | |______    |    |_____|                                         |
+| |  |  | |_____| |  \_| |______    |    |     |                                         |
+|________________________________________________________________________________________|
+| Moneta ~ Usermode memory scanner & malware hunter                                      |
+|----------------------------------------------------------------------------------------|
+| https://www.forrest-orr.net/post/malicious-memory-artifacts-part-ii-bypassing-scanners |
+|----------------------------------------------------------------------------------------|
+| Author: Forrest Orr - 2020                                                             |
+|----------------------------------------------------------------------------------------|
+| Contact: forrest.orr@protonmail.com                                                    |
+|----------------------------------------------------------------------------------------|
+| Licensed under GNU GPLv3                                                               |
+|________________________________________________________________________________________|
+| ## Features                                                                            |
+|                                                                                        |
+| ~ Query the memory attributes of any accessible process(es).                           |
+| ~ Identify private, mapped and image memory.                                           |
+| ~ Correlate regions of memory to their underlying file on disks.                       |
+| ~ Identify PE headers and sections corresponding to image memory.                      |
+| ~ Identify modified regions of mapped image memory.                                    |
+| ~ Identify abnormal memory attributes indicative of malware.                           |
+| ~ Create memory dumps of user-specified memory ranges                                  |
+| ~ Calculate memory permission/type statistics                                          |
+|________________________________________________________________________________________|
+
+*/
+
+#include "Portable.h"
+#include "Der.hpp"
+#include "CatalogIndex.hpp"
+
+using namespace std;
+
+// A catalog is a PKCS #7 SignedData message whose content is a certificate trust list (CTL). Each trusted subject of the list is one member of the catalog,
+// and carries the Authenticode digest of the member file within its SPC_INDIRECT_DATA attribute. Only the parts of the DER encoding leading to these digests
+// and to the issuer of the signer are decoded.
+
+static const uint8_t OidSignedData[] = { 0x2A, 0x86, 0x48, 0x86, 0xF7, 0x0D, 0x01, 0x07, 0x02 }; // 1.2.840.113549.1.7.2
+static const uint8_t OidCtl[] = { 0x2B, 0x06, 0x01, 0x04, 0x01, 0x82, 0x37, 0x0A, 0x01 }; // 1.3.6.1.4.1.311.10.1
+static const uint8_t OidIndirectData[] = { 0x2B, 0x06, 0x01, 0x04, 0x01, 0x82, 0x37, 0x02, 0x01, 0x04 }; // 1.3.6.1.4.1.311.2.1.4
+
+static bool SubjectDigest(const Der::Element& Subject, CatalogIndex::Member& NewMember) { // The digest of a trusted subject is taken from its SPC_INDIRECT_DATA attribute: SEQUENCE { data, DigestInfo SEQUENCE { algorithm, digest OCTET STRING } }
+	vector<Der::Element> SubjectFields, Attributes, Attribute, Values, IndirectData, DigestInfo;
+
+	if (!Der::Children(Subject, SubjectFields) || SubjectFields.size() < 2 || SubjectFields[1].Tag != Der::Set || !Der::Children(SubjectFields[1], Attributes)) {
+		return false;
+	}
+
+	for (vector<Der::Element>::const_iterator AttribItr = Attributes.begin(); AttribItr != Attributes.end(); ++AttribItr) {
+		if (AttribItr->Tag == Der::Sequence && Der::Children(*AttribItr, Attribute) && Attribute.size() == 2 && Der::IsOid(Attribute[0], OidIndirectData)) {
+			if (Der::Children(Attribute[1], Values) && !Values.empty() && Der::Children(Values[0], IndirectData) && IndirectData.size() >= 2) {
+				if (Der::Children(IndirectData[1], DigestInfo) && DigestInfo.size() == 2 && DigestInfo[1].Tag == Der::OctetString && DigestInfo[1].Size <= sizeof(NewMember.Digest)) {
+					memcpy(NewMember.Digest, DigestInfo[1].Data, DigestInfo[1].Size);
+					NewMember.DigestSize = static_cast<uint8_t>(DigestInfo[1].Size);
+					return true;
+				}
+			}
+		}
+	}
+
+	return false;
+}
+
+bool CatalogIndex::Member::operator<(const Member& Other) const {
+	if (this->DigestSize != Other.DigestSize) {
+		return this->DigestSize < Other.DigestSize;
+	}
+
+	return memcmp(this->Digest, Other.Digest, this->DigestSize) < 0;
+}
+
+bool CatalogIndex::AddCatalog(const wstring& Path, const uint8_t* pData, size_t cbData) {
+	const uint8_t* pCursor = pData;
+	Der::Element ContentInfo;
+	vector<Der::Element> ContentInfoFields, SignedData, Encapsulated, Explicit, Ctl, Subjects, SignerInfos, SignerInfo, IssuerAndSerial;
+	Catalog NewCatalog = { Path };
+	size_t nSequenceCount = 0, nFirstMember = this->Members.size();
+
+	// ContentInfo SEQUENCE { contentType, [0] SignedData SEQUENCE { version, digestAlgorithms, encapContentInfo, [0] certificates, [1] crls, signerInfos } }
+
+	if (!Der::Next(&pCursor, pData + cbData, ContentInfo) || ContentInfo.Tag != Der::Sequence || !Der::Children(ContentInfo, ContentInfoFields) || ContentInfoFields.size() != 2 || !Der::IsOid(ContentInfoFields[0], OidSignedData)) {
+		return false;
+	}
+
+	if (!Der::Children(ContentInfoFields[1], Explicit) || Explicit.size() != 1 || !Der::Children(Explicit[0], SignedData) || SignedData.size() < 4) {
+		return false;
+	}
+
+	if (!Der::Children(SignedData[2], Encapsulated) || Encapsulated.size() != 2 || !Der::IsOid(Encapsulated[0], OidCtl) || !Der::Children(Encapsulated[1], Explicit) || Explicit.size() != 1) {
+		return false;
+	}
+
+	if (Explicit[0].Tag == Der::OctetString) { // The CTL may be wrapped in an octet string by a CMS encoder
+		const uint8_t* pCtl = Explicit[0].Data;
+
+		if (!Der::Next(&pCtl, Explicit[0].Data + Explicit[0].Size, Explicit[0])) {
+			return false;
+		}
+	}
+
+	// CertificateTrustList SEQUENCE { subjectUsage, listIdentifier, sequenceNumber, ctlThisUpdate, ctlNextUpdate, subjectAlgorithm, trustedSubjects, [0] ctlExtensions }.
+	// Of these only the usage, algorithm and subjects are sequences, and the subjects are the third.
+
+	if (!Der::Children(Explicit[0], Ctl)) {
+		return false;
+	}
+
+	for (vector<Der::Element>::const_iterator CtlItr = Ctl.begin(); CtlItr != Ctl.end(); ++CtlItr) {
+		if (CtlItr->Tag == Der::Sequence && ++nSequenceCount == 3) {
+			if (!Der::Children(*CtlItr, Subjects)) {
+				return false;
+			}
+
+			for (vector<Der::Element>::const_iterator SubjectItr = Subjects.begin(); SubjectItr != Subjects.end(); ++SubjectItr) {
+				Member NewMember = { { 0 }, 0, static_cast<uint32_t>(this->Catalogs.size()) };
+
+				if (SubjectDigest(*SubjectItr, NewMember)) {
+					this->Members.push_back(NewMember);
+				}
+			}
+		}
+	}
+
+	// The issuer is that of the first signer: SignerInfo SEQUENCE { version, issuerAndSerialNumber SEQUENCE { issuer, serialNumber }, ... }
+
+	if (SignedData.back().Tag == Der::Set && Der::Children(SignedData.back(), SignerInfos) && !SignerInfos.empty() && Der::Children(SignerInfos[0], SignerInfo) && SignerInfo.size() >= 2) {
+		if (SignerInfo[1].Tag == Der::Sequence && Der::Children(SignerInfo[1], IssuerAndSerial) && !IssuerAndSerial.empty()) {
+			NewCatalog.Issuer = Der::NameDisplay(IssuerAndSerial[0]);
+		}
+	}
+
+	if (this->Members.size() == nFirstMember) {
+		return false;
+	}
+
+	this->Catalogs.push_back(NewCatalog);
+	return true;
+}
+
+void CatalogIndex::Finalize() {
+	sort(this->Members.begin(), this->Members.end());
+}
+
+bool CatalogIndex::HasDigestSize(size_t cbDigest) const { // Members are sorted by digest size before digest
+	Member Target = { { 0 }, static_cast<uint8_t>(cbDigest), 0 };
+	vector<Member>::const_iterator MemberItr = lower_bound(this->Members.begin(), this->Members.end(), Target);
+
+	return (MemberItr != this->Members.end() && MemberItr->DigestSize == cbDigest);
+}
+
+const CatalogIndex::Catalog* CatalogIndex::Find(const uint8_t* pDigest, size_t cbDigest) const {
+	Member Target = { { 0 }, static_cast<uint8_t>(cbDigest), 0 };
+
+	if (cbDigest > sizeof(Target.Digest)) {
+		return nullptr;
+	}
+
+	memcpy(Target.Digest, pDigest, cbDigest);
+	vector<Member>::const_iterator MemberItr = lower_bound(this->Members.begin(), this->Members.end(), Target);
+
+	if (MemberItr != this->Members.end() && !(Target < *MemberItr)) {
+		return &this->Catalogs[MemberItr->CatalogIndex];
+	}
+
+	return nullptr;
+}
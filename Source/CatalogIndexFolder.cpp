@@ -0,0 +1,88 @@
+/*
+__________________________________________________________________________________________
+| _______  _____  __   _ _______ _______ _______                                         |
+| |  |  | |     | | \  | |______    |    |_____|                                         |
+| |  |  | |_____| |  \_| |______    |    |     |                                         |
+|________________________________________________________________________________________|
+| Moneta ~ Usermode memory scanner & malware hunter                                      |
+|----------------------------------------------------------------------------------------|
+| https://www.forrest-orr.net/post/malicious-memory-artifacts-part-ii-bypassing-scanners |
+|----------------------------------------------------------------------------------------|
+| Author: Forrest Orr - 2020                                                             |
+|----------------------------------------------------------------------------------------|
+| Contact: forrest.orr@protonmail.com                                                    |
+|----------------------------------------------------------------------------------------|
+| Licensed under GNU GPLv3                                                               |
+|________________________________________________________________________________________|
+| ## Features                                                                            |
+|                                                                                        |
+| ~ Query the memory attributes of any accessible process(es).                           |
+| ~ Identify private, mapped and image memory.                                           |
+| ~ Correlate regions of memory to their underlying file on disks.                       |
+| ~ Identify PE headers and sections corresponding to image memory.                      |
+| ~ Identify modified regions of mapped image memory.                                    |
+| ~ Identify abnormal memory attributes indicative of malware.                           |
+| ~ Create memory dumps of user-specified memory ranges                                  |
+| ~ Calculate memory permission/type statistics                                          |
+|________________________________________________________________________________________|
+
+*/
+
+#include "StdAfx.h"
+#include "CatalogIndex.hpp"
+
+using namespace std;
+
+// Catalog store access for the catalog index. Parsing and lookup are portable and live in CatalogIndex.cpp: only the walk of the store folders is Win32 specific.
+
+size_t CatalogIndex::AddFolder(const wstring& Folder) {
+	WIN32_FIND_DATAW FindData = { 0 };
+	HANDLE hFind;
+	size_t nCatalogCount = 0;
+
+	if ((hFind = FindFirstFileW((Folder + L"\\*").c_str(), &FindData)) != INVALID_HANDLE_VALUE) {
+		do {
+			wstring Path = Folder + L"\\" + FindData.cFileName;
+
+			if (FindData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+				if (wcscmp(FindData.cFileName, L".") != 0 && wcscmp(FindData.cFileName, L"..") != 0 && !(FindData.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT)) {
+					nCatalogCount += this->AddFolder(Path);
+				}
+			}
+			else if (Path.size() > 4 && _wcsicmp(Path.c_str() + Path.size() - 4, L".cat") == 0 && FindData.nFileSizeHigh == 0 && FindData.nFileSizeLow != 0) {
+				HANDLE hFile;
+
+				if ((hFile = CreateFileW(Path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr)) != INVALID_HANDLE_VALUE) {
+					unique_ptr<uint8_t[]> CatalogBuf = make_unique<uint8_t[]>(FindData.nFileSizeLow);
+					uint32_t dwBytesRead = 0;
+
+					if (ReadFile(hFile, CatalogBuf.get(), FindData.nFileSizeLow, reinterpret_cast<PDWORD>(&dwBytesRead), nullptr) && this->AddCatalog(Path, CatalogBuf.get(), dwBytesRead)) {
+						nCatalogCount++;
+					}
+
+					CloseHandle(hFile);
+				}
+			}
+		} while (FindNextFileW(hFind, &FindData));
+
+		FindClose(hFind);
+	}
+
+	return nCatalogCount;
+}
+
+const CatalogIndex& CatalogIndex::GetSystemIndex() {
+	static CatalogIndex SystemIndex;
+	static once_flag Built;
+
+	call_once(Built, []() {
+		wchar_t SystemFolder[MAX_PATH + 1] = { 0 };
+
+		if (GetSystemDirectoryW(SystemFolder, MAX_PATH)) {
+			SystemIndex.AddFolder(wstring(SystemFolder) + L"\\CatRoot"); // Each catalog database GUID has its own subfolder
+			SystemIndex.Finalize();
+		}
+	});
+
+	return SystemIndex;
+}
@@ -39,7 +39,15 @@ ________________________________________________________________________________
 #include "Privileges.h"
 #include "Resources.h"
 #include "Statistics.hpp"
+#include "LoaderList.hpp"
 #include "Ioc.hpp"
+#include "TaskPool.hpp"
+#include "PointerScan.hpp"
+#include "RegionReader.hpp"
+#include "RemotePageCache.hpp"
+#include "Signing.h"
+#include "PeImageCache.hpp"
+#include "SigningStore.hpp"
 
 using namespace std;
 using namespace Memory;
@@ -52,13 +60,36 @@ enum class SelectedProcess_t {
 	SelfPid
 };
 
+size_t QueryPeakWorkingSet() {
+	PROCESS_MEMORY_COUNTERS MemCounters = { 0 };
+
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &MemCounters, sizeof(MemCounters))) {
+		return MemCounters.PeakWorkingSetSize;
+	}
+
+	return 0;
+}
+
+void LogScanCounters() { // Debug counters of the caches and pools shared by every process of the scan
+	Interface::Log(Interface::VerbosityLevel::Debug, "... %I64u thread opens saved by sharing process thread tables\r\n", Subregion::GetThreadOpensSaved());
+	Interface::Log(Interface::VerbosityLevel::Debug, "... %I64u working set queries made for %I64u pages\r\n", Subregion::GetPageProvider()->GetQueryCount(), Subregion::GetPageProvider()->GetPageCount());
+	Interface::Log(Interface::VerbosityLevel::Debug, "... %I64u read buffers allocated\r\n", ReadBufferPool::GetAllocationCount());
+	Interface::Log(Interface::VerbosityLevel::Debug, "... %I64u zero pages skipped and %I64u pages unreadable during region reads\r\n", RegionReader::GetZeroPagesSkipped(), RegionReader::GetUnreadablePageCount());
+	Interface::Log(Interface::VerbosityLevel::Debug, "... %I64u remote page cache hits, %I64u misses and %I64u system calls saved\r\n", RemotePageCache::GetHitCount(), RemotePageCache::GetMissCount(), RemotePageCache::GetSyscallsSaved());
+	Interface::Log(Interface::VerbosityLevel::Debug, "... %I64u signing cache hits and %I64u misses\r\n", SigningCache::GetHitCount(), SigningCache::GetMissCount());
+	Interface::Log(Interface::VerbosityLevel::Debug, "... %I64u PE image cache hits and %I64u misses\r\n", PeImageCache::GetHitCount(), PeImageCache::GetMissCount());
+	Interface::Log(Interface::VerbosityLevel::Debug, "... %I64u signing verdicts read from and %I64u written to the cache file\r\n", SigningStore::GetHitCount(), SigningStore::GetStoreCount());
+	Interface::Log(Interface::VerbosityLevel::Debug, "... peak working set of %I64u KB\r\n", static_cast<uint64_t>(QueryPeakWorkingSet() / 1024));
+}
+
 int32_t wmain(int32_t nArgc, const wchar_t* pArgv[]) {
 	vector<wstring> Args(&pArgv[0], &pArgv[0 + nArgc]);
 	Interface::Initialize(Args);
 	SelectedProcess_t ProcType = SelectedProcess_t::InvalidPid;
 	ScannerContext::MemorySelection_t Mst = ScannerContext::MemorySelection_t::Invalid;
-	uint32_t dwSelectedPid = 0, dwRegionSize = 0;
+	uint32_t dwSelectedPid = 0, dwRegionSize = 0, dwThreadCount = 1, dwReferenceDepth = 1;
 	uint8_t* pAddress = nullptr;
+	wstring CacheFilePath;
 	bool bSuppressBanner = false;
 	uint64_t qwOptFlags = 0, qwFilterFlags = 0;
 
@@ -98,6 +129,17 @@ int32_t wmain(int32_t nArgc, const wchar_t* pArgv[]) {
 		else if (Arg == L"--region-size") {
 			dwRegionSize = _wtoi((*(i + 1)).c_str());
 		}
+		else if (Arg == L"--reference-depth") {
+			int32_t nReferenceDepth = _wtoi((*(i + 1)).c_str());
+			dwReferenceDepth = (nReferenceDepth > 0 ? nReferenceDepth : 1);
+		}
+		else if (Arg == L"--cache-file") {
+			CacheFilePath = *(i + 1);
+		}
+		else if (Arg == L"--threads") {
+			int32_t nThreadCount = _wtoi((*(i + 1)).c_str());
+			dwThreadCount = (nThreadCount > 0 ? nThreadCount : max<uint32_t>(thread::hardware_concurrency(), 1)); // A count of 0 selects one worker per logical processor
+		}
 		else if (Arg == L"--option") {
 			for (vector<wstring>::const_iterator OptZtr = i; OptZtr != Args.end(); ++OptZtr) {
 				wstring OptArg = *OptZtr;
@@ -109,6 +151,9 @@ int32_t wmain(int32_t nArgc, const wchar_t* pArgv[]) {
 				else if (OptArg == L"statistics") {
 					qwOptFlags |= PROCESS_ENUM_FLAG_STATISTICS;
 				}
+				else if (OptArg == L"reference-index") {
+					qwOptFlags |= PROCESS_ENUM_FLAG_REFERENCE_INDEX;
+				}
 				else if (OptArg == L"suppress-banner") {
 					bSuppressBanner = true;
 				}
@@ -224,18 +269,37 @@ int32_t wmain(int32_t nArgc, const wchar_t* pArgv[]) {
 			MemDump::Initialize();
 		}
 
+		if (!CacheFilePath.empty()) {
+			if (SigningStore::Open(CacheFilePath.c_str())) {
+				Interface::Log(Interface::VerbosityLevel::Debug, "... opened signing cache file %ws\r\n", CacheFilePath.c_str());
+			}
+			else {
+				Interface::Log(Interface::VerbosityLevel::Surface, "... failed to open signing cache file %ws (error %d). Signatures will be verified without it.\r\n", CacheFilePath.c_str(), GetLastError());
+			}
+		}
+
 		// Analyze processes and generate memory maps/suspicions
 
-		ScannerContext ScannerCtx(qwOptFlags, Mst, pAddress, dwRegionSize, qwFilterFlags);
+		ScannerContext ScannerCtx(qwOptFlags, Mst, pAddress, dwRegionSize, qwFilterFlags, dwReferenceDepth);
 		uint64_t qwStartTick = GetTickCount64();
 
+		SystemSnapshot Snapshot;
+
+		TaskPool::Initialize(dwThreadCount - 1); // The thread which requests parallel work always takes part in it
+		Interface::Log(Interface::VerbosityLevel::Debug, "... using %ws pointer scan kernel\r\n", PointerScan::IsaSymbol(PointerScan::GetIsa()));
+
+		if (!Snapshot.Capture()) { // Processes are still scanned without a snapshot, although their names and threads will be unknown
+			Interface::Log(Interface::VerbosityLevel::Surface, "... failed to create system process and thread snapshot\r\n");
+		}
+
 		if (ProcType == SelectedProcess_t::SelfPid || ProcType == SelectedProcess_t::SpecificPid) {
 			try {
-				Process TargetProc(dwSelectedPid);
+				Process TargetProc(dwSelectedPid, Snapshot);
 				vector<Ioc*> SelectedIocs;
 				vector<Subregion*> SelectedSbrs;
 
 				TargetProc.Enumerate(ScannerCtx, &SelectedIocs, &SelectedSbrs);
+				LogScanCounters();
 
 				if ((qwOptFlags & PROCESS_ENUM_FLAG_STATISTICS)) {
 					PermissionRecord PermissionRecords(SelectedSbrs);
@@ -250,67 +314,33 @@ int32_t wmain(int32_t nArgc, const wchar_t* pArgv[]) {
 			}
 		}
 		else {
-			PROCESSENTRY32W ProcEntry = { 0 };
-			HANDLE hSnapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
-
-			unique_ptr<PermissionRecord> PermissionRecords = nullptr;
-			unique_ptr<IocRecord> IocRecords = nullptr;
-
-			if (hSnapshot != nullptr) {
-				ProcEntry.dwSize = sizeof(PROCESSENTRY32W);
-
-				if (Process32FirstW(hSnapshot, &ProcEntry)) {
-					do {
-						if (ProcEntry.th32ProcessID != GetCurrentProcessId()) {
-							try {
-								Process TargetProc(ProcEntry.th32ProcessID);
-								vector<Ioc*> SelectedIocs;
-								vector<Subregion*> SelectedSbrs;
-
-								TargetProc.Enumerate(ScannerCtx, &SelectedIocs, &SelectedSbrs);
-
-								if ((qwOptFlags & PROCESS_ENUM_FLAG_STATISTICS)) {
-									if (PermissionRecords == nullptr) {
-										PermissionRecords = make_unique<PermissionRecord>(SelectedSbrs);
-									}
-									else {
-										PermissionRecords->UpdateMap(SelectedSbrs);
-									}
-
-									if (IocRecords == nullptr) {
-										IocRecords = make_unique<IocRecord>(&SelectedIocs);
-									}
-									else {
-										IocRecords->UpdateMap(&SelectedIocs);
-									}
-								}
-							}
-							catch (int32_t nError) {
-								Interface::Log(Interface::VerbosityLevel::Debug, "... failed to map address space of %d:%ws (error %d)\r\n", ProcEntry.th32ProcessID, ProcEntry.szExeFile, nError);
-								continue;
-							}
-						}
-					} while (Process32NextW(hSnapshot, &ProcEntry));
-				}
+			vector<uint32_t> Pids = Snapshot.GetPids();
+			vector<uint32_t> Targets;
+			ProcessScanner Scanner(ScannerCtx, Snapshot);
 
-				CloseHandle(hSnapshot);
-			}
-			else
-			{
-				Interface::Log(Interface::VerbosityLevel::Surface, "... failed to create process list snapshot (error %d)\r\n", GetLastError());
+			for (vector<uint32_t>::const_iterator Itr = Pids.begin(); Itr != Pids.end(); ++Itr) {
+				if (*Itr != GetCurrentProcessId()) {
+					Targets.push_back(*Itr);
+				}
 			}
 
+			Scanner.Scan(Targets);
+			LogScanCounters();
+
 			Interface::SetVerbosity(Interface::VerbosityLevel::Surface); // Override the verbosity level now that the scan is over to ensure statistics and scan time are displayed (if applicable)
 
-			if (PermissionRecords != nullptr) {
-				PermissionRecords->ShowRecords();
+			if (Scanner.GetPermissionRecords() != nullptr) {
+				Scanner.GetPermissionRecords()->ShowRecords();
 			}
 
-			if (IocRecords != nullptr) {
-				IocRecords->ShowRecords();
+			if (Scanner.GetIocRecords() != nullptr) {
+				Scanner.GetIocRecords()->ShowRecords();
 			}
 		}
 
+		TaskPool::Shutdown();
+		SigningStore::Close();
+		PeImageCache::Clear();
 		float fElapsedTime = GetTickCount64() - qwStartTick;
 		Interface::Log(Interface::VerbosityLevel::Surface, "\r\n... scan completed (%f second duration)\r\n", fElapsedTime / 1000.0);
 		return 1;
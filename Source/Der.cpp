@@ -0,0 +1,145 @@
+/*
+__________________________________________________________________________________________
+| _______  _____  __   _ _______ _______ _______                                         |
+| |  |  | |     | | \  | |______    |    |_____|                                         |
+| |  |  | |_____| |  \_| |______    |    |     |                                         |
+|________________________________________________________________________________________|
+| Moneta ~ Usermode memory scanner & malware hunter                                      |
+|----------------------------------------------------------------------------------------|
+| https://www.forrest-orr.net/post/malicious-memory-artifacts-part-ii-bypassing-scanners |
+|----------------------------------------------------------------------------------------|
+| Author: Forrest Orr - 2020                                                             |
+|----------------------------------------------------------------------------------------|
+| Contact: forrest.orr@protonmail.com                                                    |
+|----------------------------------------------------------------------------------------|
+| Licensed under GNU GPLv3                                                               |
+|________________________________________________________________________________________|
+| ## Features                                                                            |
+|                                                                                        |
+| ~ Query the memory attributes of any accessible process(es).                           |
+| ~ Identify private, mapped and image memory.                                           |
+| ~ Correlate regions of memory to their underlying file on disks.                       |
+| ~ Identify PE headers and sections corresponding to image memory.                      |
+| ~ Identify modified regions of mapped image memory.                                    |
+| ~ Identify abnormal memory attributes indicative of malware.                           |
+| ~ Create memory dumps of user-specified memory ranges                                  |
+| ~ Calculate memory permission/type statistics                                          |
+|________________________________________________________________________________________|
+
+*/
+
+#include "Portable.h"
+#include "Der.hpp"
+
+using namespace std;
+
+static const uint8_t OidCommonName[] = { 0x55, 0x04, 0x03 }; // 2.5.4.3
+static const uint8_t OidOrganizationalUnit[] = { 0x55, 0x04, 0x0B }; // 2.5.4.11
+static const uint8_t OidOrganization[] = { 0x55, 0x04, 0x0A }; // 2.5.4.10
+
+bool Der::Next(const uint8_t** ppData, const uint8_t* pEnd, Element& Target) { // Only definite lengths of up to 4 bytes are accepted
+	const uint8_t* pData = *ppData;
+	size_t cbSize;
+
+	if (pEnd - pData < 2 || (pData[0] & 0x1F) == 0x1F) {
+		return false;
+	}
+
+	Target.Tag = *pData++;
+
+	if (*pData & 0x80) {
+		uint32_t dwLengthBytes = *pData++ & 0x7F;
+
+		if (dwLengthBytes == 0 || dwLengthBytes > 4 || static_cast<size_t>(pEnd - pData) < dwLengthBytes) {
+			return false;
+		}
+
+		for (cbSize = 0; dwLengthBytes; dwLengthBytes--) {
+			cbSize = (cbSize << 8) | *pData++;
+		}
+	}
+	else {
+		cbSize = *pData++;
+	}
+
+	if (static_cast<size_t>(pEnd - pData) < cbSize) {
+		return false;
+	}
+
+	Target.Data = pData;
+	Target.Size = cbSize;
+	*ppData = pData + cbSize;
+	return true;
+}
+
+bool Der::Children(const Element& Parent, vector<Element>& Elements) {
+	const uint8_t* pData = Parent.Data;
+	Element Child;
+
+	Elements.clear();
+
+	while (pData < Parent.Data + Parent.Size) {
+		if (!Next(&pData, Parent.Data + Parent.Size, Child)) {
+			return false;
+		}
+
+		Elements.push_back(Child);
+	}
+
+	return true;
+}
+
+bool Der::Equal(const Element& First, const Element& Second) {
+	return First.Tag == Second.Tag && First.Size == Second.Size && memcmp(First.Data, Second.Data, First.Size) == 0;
+}
+
+wstring Der::String(const Element& Target) {
+	wstring Value;
+
+	if (Target.Tag == 0x1E) { // BMPString is big endian UTF-16
+		for (size_t nX = 0; nX + 1 < Target.Size; nX += 2) {
+			Value.push_back(static_cast<wchar_t>((Target.Data[nX] << 8) | Target.Data[nX + 1]));
+		}
+	}
+	else if (Target.Tag == 0x0C) { // UTF8String
+		try {
+			wstring_convert<codecvt_utf8_utf16<wchar_t>> UnicodeConverter;
+			Value = UnicodeConverter.from_bytes(reinterpret_cast<const char*>(Target.Data), reinterpret_cast<const char*>(Target.Data + Target.Size));
+		}
+		catch (const range_error&) {
+			Value.clear();
+		}
+	}
+	else { // PrintableString, IA5String and T61String are treated as single byte characters
+		Value.assign(Target.Data, Target.Data + Target.Size);
+	}
+
+	return Value;
+}
+
+wstring Der::NameDisplay(const Element& Name) { // The common name, falling back to the organizational unit and then the organization as CertGetNameString does for a simple display name
+	vector<Element> Rdns, Attributes, TypeAndValue;
+	wstring Values[3];
+
+	if (Children(Name, Rdns)) {
+		for (vector<Element>::const_iterator RdnItr = Rdns.begin(); RdnItr != Rdns.end(); ++RdnItr) {
+			if (RdnItr->Tag == Set && Children(*RdnItr, Attributes)) {
+				for (vector<Element>::const_iterator AttribItr = Attributes.begin(); AttribItr != Attributes.end(); ++AttribItr) {
+					if (AttribItr->Tag == Sequence && Children(*AttribItr, TypeAndValue) && TypeAndValue.size() == 2) {
+						if (IsOid(TypeAndValue[0], OidCommonName) && Values[0].empty()) {
+							Values[0] = String(TypeAndValue[1]);
+						}
+						else if (IsOid(TypeAndValue[0], OidOrganizationalUnit) && Values[1].empty()) {
+							Values[1] = String(TypeAndValue[1]);
+						}
+						else if (IsOid(TypeAndValue[0], OidOrganization) && Values[2].empty()) {
+							Values[2] = String(TypeAndValue[1]);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	return !Values[0].empty() ? Values[0] : (!Values[1].empty() ? Values[1] : Values[2]);
+}
@@ -0,0 +1,303 @@
+/*
+__________________________________________________________________________________________
+| _______  _____  __   _ _______ _______ _______                                         |
+| |  |  | |     | | \  | |______    |    |_____|                                         |
+| |  |  | |_____| |  \_| |______    |    |     |                                         |
+|________________________________________________________________________________________|
+| Moneta ~ Usermode memory scanner & malware hunter                                      |
+|----------------------------------------------------------------------------------------|
+| https://www.forrest-orr.net/post/malicious-memory-artifacts-part-ii-bypassing-scanners |
+|----------------------------------------------------------------------------------------|
+| Author: Forrest Orr - 2020                                                             |
+|----------------------------------------------------------------------------------------|
+| Contact: forrest.orr@protonmail.com                                                    |
+|----------------------------------------------------------------------------------------|
+| Licensed under GNU GPLv3                                                               |
+|________________________________________________________________________________________|
+| ## Features                                                                            |
+|                                                                                        |
+| ~ Query the memory attributes of any accessible process(es).                           |
+| ~ Identify private, mapped and image memory.                                           |
+| ~ Correlate regions of memory to their underlying file on disks.                       |
+| ~ Identify PE headers and sections corresponding to image memory.                      |
+| ~ Identify modified regions of mapped image memory.                                    |
+| ~ Identify abnormal memory attributes indicative of malware.                           |
+| ~ Create memory dumps of user-specified memory ranges                                  |
+| ~ Calculate memory permission/type statistics                                          |
+|________________________________________________________________________________________|
+
+*/
+
+#include "Portable.h"
+#include "Digest.hpp"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define DIGEST_SHA_NI
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define SHA_NI_TARGET
+#else
+#include <cpuid.h>
+#define SHA_NI_TARGET __attribute__((target("sha,sse4.1,ssse3"))) // GCC and Clang only emit the SHA intrinsics within functions targeting them
+#endif
+#endif
+
+using namespace std;
+
+static const uint32_t Sha256RoundConstants[64] = {
+	0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+	0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3, 0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+	0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+	0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7, 0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+	0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13, 0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+	0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3, 0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+	0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5, 0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+	0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208, 0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2
+};
+
+static inline uint32_t RotateRight(uint32_t dwValue, uint32_t dwCount) {
+	return (dwValue >> dwCount) | (dwValue << (32 - dwCount));
+}
+
+static inline uint32_t LoadBigEndian(const uint8_t* pData) {
+	return (static_cast<uint32_t>(pData[0]) << 24) | (static_cast<uint32_t>(pData[1]) << 16) | (static_cast<uint32_t>(pData[2]) << 8) | pData[3];
+}
+
+static inline void StoreBigEndian(uint8_t* pData, uint32_t dwValue) {
+	pData[0] = static_cast<uint8_t>(dwValue >> 24);
+	pData[1] = static_cast<uint8_t>(dwValue >> 16);
+	pData[2] = static_cast<uint8_t>(dwValue >> 8);
+	pData[3] = static_cast<uint8_t>(dwValue);
+}
+
+void HashDigest::Update(const uint8_t* pData, size_t cbData) {
+	this->qwTotalSize += cbData;
+
+	if (this->cbBuffered) { // Complete the partial block left by the previous update before compressing directly from the caller's data
+		size_t cbCopy = min(cbData, BlockSize - this->cbBuffered);
+
+		memcpy(this->Buffer + this->cbBuffered, pData, cbCopy);
+		this->cbBuffered += cbCopy;
+		pData += cbCopy;
+		cbData -= cbCopy;
+
+		if (this->cbBuffered < BlockSize) {
+			return;
+		}
+
+		this->Compress(this->Buffer, 1);
+		this->cbBuffered = 0;
+	}
+
+	if (cbData >= BlockSize) {
+		this->Compress(pData, cbData / BlockSize);
+		pData += (cbData / BlockSize) * BlockSize;
+		cbData %= BlockSize;
+	}
+
+	memcpy(this->Buffer, pData, cbData);
+	this->cbBuffered = cbData;
+}
+
+void HashDigest::Final(uint8_t* pDigest) { // SHA-1 and SHA-2 share the same padding: a single set bit, zeros and the big endian bit length in the last 8 bytes of the block
+	uint64_t qwBitSize = this->qwTotalSize * 8;
+	uint8_t Padding[BlockSize * 2] = { 0x80 };
+	size_t cbPadding = (this->cbBuffered < BlockSize - 8 ? BlockSize : BlockSize * 2) - this->cbBuffered;
+
+	for (size_t nX = 0; nX < 8; nX++) {
+		Padding[cbPadding - 1 - nX] = static_cast<uint8_t>(qwBitSize >> (nX * 8));
+	}
+
+	this->Update(Padding, cbPadding);
+	this->Output(pDigest);
+}
+
+Sha1Digest::Sha1Digest() {
+	this->State[0] = 0x67452301;
+	this->State[1] = 0xEFCDAB89;
+	this->State[2] = 0x98BADCFE;
+	this->State[3] = 0x10325476;
+	this->State[4] = 0xC3D2E1F0;
+}
+
+void Sha1Digest::Compress(const uint8_t* pBlocks, size_t nBlockCount) {
+	for (; nBlockCount; nBlockCount--, pBlocks += BlockSize) {
+		uint32_t Schedule[80];
+		uint32_t dwA = this->State[0], dwB = this->State[1], dwC = this->State[2], dwD = this->State[3], dwE = this->State[4];
+
+		for (uint32_t dwX = 0; dwX < 16; dwX++) {
+			Schedule[dwX] = LoadBigEndian(pBlocks + dwX * 4);
+		}
+
+		for (uint32_t dwX = 16; dwX < 80; dwX++) {
+			Schedule[dwX] = RotateRight(Schedule[dwX - 3] ^ Schedule[dwX - 8] ^ Schedule[dwX - 14] ^ Schedule[dwX - 16], 31);
+		}
+
+		for (uint32_t dwX = 0; dwX < 80; dwX++) {
+			uint32_t dwF, dwK;
+
+			if (dwX < 20) {
+				dwF = (dwB & dwC) | (~dwB & dwD);
+				dwK = 0x5A827999;
+			}
+			else if (dwX < 40) {
+				dwF = dwB ^ dwC ^ dwD;
+				dwK = 0x6ED9EBA1;
+			}
+			else if (dwX < 60) {
+				dwF = (dwB & dwC) | (dwB & dwD) | (dwC & dwD);
+				dwK = 0x8F1BBCDC;
+			}
+			else {
+				dwF = dwB ^ dwC ^ dwD;
+				dwK = 0xCA62C1D6;
+			}
+
+			uint32_t dwTemp = RotateRight(dwA, 27) + dwF + dwE + dwK + Schedule[dwX];
+			dwE = dwD;
+			dwD = dwC;
+			dwC = RotateRight(dwB, 2);
+			dwB = dwA;
+			dwA = dwTemp;
+		}
+
+		this->State[0] += dwA;
+		this->State[1] += dwB;
+		this->State[2] += dwC;
+		this->State[3] += dwD;
+		this->State[4] += dwE;
+	}
+}
+
+void Sha1Digest::Output(uint8_t* pDigest) const {
+	for (uint32_t dwX = 0; dwX < 5; dwX++) {
+		StoreBigEndian(pDigest + dwX * 4, this->State[dwX]);
+	}
+}
+
+Sha256Digest::Sha256Digest() {
+	static const uint32_t InitialState[8] = { 0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A, 0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19 };
+	memcpy(this->State, InitialState, sizeof(this->State));
+}
+
+#ifdef DIGEST_SHA_NI
+static inline void CpuId(int32_t CpuInfo[4], int32_t nLeaf, int32_t nSubLeaf) {
+#if defined(_MSC_VER)
+	__cpuidex(CpuInfo, nLeaf, nSubLeaf);
+#else
+	__cpuid_count(nLeaf, nSubLeaf, CpuInfo[0], CpuInfo[1], CpuInfo[2], CpuInfo[3]);
+#endif
+}
+#endif
+
+bool Sha256Digest::IsAccelerated() {
+#ifdef DIGEST_SHA_NI
+	static const bool bShaExtensions = []() {
+		int32_t CpuInfo[4] = { 0 };
+
+		CpuId(CpuInfo, 0, 0);
+
+		if (CpuInfo[0] < 7) {
+			return false;
+		}
+
+		CpuId(CpuInfo, 1, 0);
+
+		if (!(CpuInfo[2] & (1 << 19))) { // The SHA-NI kernel also relies on SSE4.1 blends
+			return false;
+		}
+
+		CpuId(CpuInfo, 7, 0);
+		return (CpuInfo[1] & (1 << 29)) ? true : false;
+	}();
+
+	return bShaExtensions;
+#else
+	return false;
+#endif
+}
+
+void Sha256Digest::Compress(const uint8_t* pBlocks, size_t nBlockCount) {
+#ifdef DIGEST_SHA_NI
+	if (IsAccelerated()) {
+		this->CompressShaNi(pBlocks, nBlockCount);
+		return;
+	}
+#endif
+
+	for (; nBlockCount; nBlockCount--, pBlocks += BlockSize) {
+		uint32_t Schedule[64];
+		uint32_t Working[8];
+
+		for (uint32_t dwX = 0; dwX < 16; dwX++) {
+			Schedule[dwX] = LoadBigEndian(pBlocks + dwX * 4);
+		}
+
+		for (uint32_t dwX = 16; dwX < 64; dwX++) {
+			uint32_t dwSigma0 = RotateRight(Schedule[dwX - 15], 7) ^ RotateRight(Schedule[dwX - 15], 18) ^ (Schedule[dwX - 15] >> 3);
+			uint32_t dwSigma1 = RotateRight(Schedule[dwX - 2], 17) ^ RotateRight(Schedule[dwX - 2], 19) ^ (Schedule[dwX - 2] >> 10);
+			Schedule[dwX] = Schedule[dwX - 16] + dwSigma0 + Schedule[dwX - 7] + dwSigma1;
+		}
+
+		memcpy(Working, this->State, sizeof(Working));
+
+		for (uint32_t dwX = 0; dwX < 64; dwX++) {
+			uint32_t dwSum1 = RotateRight(Working[4], 6) ^ RotateRight(Working[4], 11) ^ RotateRight(Working[4], 25);
+			uint32_t dwChoice = (Working[4] & Working[5]) ^ (~Working[4] & Working[6]);
+			uint32_t dwTemp1 = Working[7] + dwSum1 + dwChoice + Sha256RoundConstants[dwX] + Schedule[dwX];
+			uint32_t dwSum0 = RotateRight(Working[0], 2) ^ RotateRight(Working[0], 13) ^ RotateRight(Working[0], 22);
+			uint32_t dwMajority = (Working[0] & Working[1]) ^ (Working[0] & Working[2]) ^ (Working[1] & Working[2]);
+
+			memmove(Working + 1, Working, sizeof(uint32_t) * 7);
+			Working[4] += dwTemp1;
+			Working[0] = dwTemp1 + dwSum0 + dwMajority;
+		}
+
+		for (uint32_t dwX = 0; dwX < 8; dwX++) {
+			this->State[dwX] += Working[dwX];
+		}
+	}
+}
+
+#ifdef DIGEST_SHA_NI
+SHA_NI_TARGET void Sha256Digest::CompressShaNi(const uint8_t* pBlocks, size_t nBlockCount) { // Each sha256rnds2 performs two rounds on the state split into ABEF and CDGH halves, and sha256msg1/msg2 extend the message schedule four words at a time
+	const __m128i ByteSwapMask = _mm_set_epi64x(0x0C0D0E0F08090A0BULL, 0x0405060700010203ULL);
+	__m128i Temp = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&this->State[0])), 0xB1); // CDAB
+	__m128i State1 = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&this->State[4])), 0x1B); // EFGH
+	__m128i State0 = _mm_alignr_epi8(Temp, State1, 8); // ABEF
+	State1 = _mm_blend_epi16(State1, Temp, 0xF0); // CDGH
+
+	for (; nBlockCount; nBlockCount--, pBlocks += BlockSize) {
+		__m128i Schedule[16];
+		__m128i SavedState0 = State0, SavedState1 = State1;
+
+		for (uint32_t dwX = 0; dwX < 16; dwX++) {
+			if (dwX < 4) {
+				Schedule[dwX] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pBlocks + dwX * 16)), ByteSwapMask);
+			}
+			else {
+				Schedule[dwX] = _mm_sha256msg2_epu32(_mm_add_epi32(_mm_sha256msg1_epu32(Schedule[dwX - 4], Schedule[dwX - 3]), _mm_alignr_epi8(Schedule[dwX - 1], Schedule[dwX - 2], 4)), Schedule[dwX - 1]);
+			}
+
+			__m128i Message = _mm_add_epi32(Schedule[dwX], _mm_loadu_si128(reinterpret_cast<const __m128i*>(&Sha256RoundConstants[dwX * 4])));
+			State1 = _mm_sha256rnds2_epu32(State1, State0, Message);
+			State0 = _mm_sha256rnds2_epu32(State0, State1, _mm_shuffle_epi32(Message, 0x0E));
+		}
+
+		State0 = _mm_add_epi32(State0, SavedState0);
+		State1 = _mm_add_epi32(State1, SavedState1);
+	}
+
+	Temp = _mm_shuffle_epi32(State0, 0x1B); // FEBA
+	State1 = _mm_shuffle_epi32(State1, 0xB1); // DCHG
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(&this->State[0]), _mm_blend_epi16(Temp, State1, 0xF0)); // DCBA
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(&this->State[4]), _mm_alignr_epi8(State1, Temp, 8)); // ABEF
+}
+#endif
+
+void Sha256Digest::Output(uint8_t* pDigest) const {
+	for (uint32_t dwX = 0; dwX < 8; dwX++) {
+		StoreBigEndian(pDigest + dwX * 4, this->State[dwX]);
+	}
+}
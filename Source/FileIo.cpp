@@ -30,6 +30,7 @@ ________________________________________________________________________________
 
 #include "stdafx.h"
 #include "FileIo.hpp"
+#include "PathCanonicalizer.hpp"
 
 using namespace std;
 
@@ -94,43 +95,14 @@ bool FileBase::TranslateDevicePath(const wchar_t* DevicePath, wchar_t* Translate
 	assert(DevicePath != nullptr);
 	assert(TranslatedPath != nullptr);
 
-	wchar_t DriveLetters[MAX_PATH + 1] = { 0 };
-	bool bTranslated = false;
-
-	if (GetLogicalDriveStringsW(MAX_PATH + 1, DriveLetters)) {
-		wchar_t DosPath[MAX_PATH + 1];
-		wchar_t DrivePrefix[3] = L" :";
-		wchar_t* p = DriveLetters;
-
-		do {
-			*DrivePrefix = *p;
-
-			if (QueryDosDeviceW(DrivePrefix, DosPath, MAX_PATH + 1)) {
-				if (_wcsnicmp(DevicePath, DosPath, wcslen(DosPath)) == 0) {
-					wcscpy_s(TranslatedPath, MAX_PATH + 1, DrivePrefix);
-					//wcscat_s(TranslatedPath, MAX_PATH + 1, L"\\");
-					wcscat_s(TranslatedPath, MAX_PATH + 1, DevicePath + wcslen(DosPath));
-					bTranslated = true;
-				}
-			}
-
-			p++;
-		} while (!bTranslated && *p);
-	}
-
-	return bTranslated;
+	return PathCanonicalizer::GetSystem().TranslateDevicePath(DevicePath, TranslatedPath, MAX_PATH + 1);
 }
 
 bool FileBase::ArchWow64PathExpand(const wchar_t* TargetFilePath, wchar_t* OutputPath, size_t ccOutputPathLength) {
 	assert(TargetFilePath != nullptr);
 	assert(OutputPath != nullptr);
 
-	bool bExpandedPath = false;
-	uint64_t qwPathLength, qwMaxEnvVarSize = 32767;
-	unique_ptr<wchar_t[]> ProgFilePath64;
-	unique_ptr<wchar_t[]> ProgFilePathWow64;
-	wchar_t SystemDirectory[MAX_PATH + 1] = { 0 }, SysWow64Directory[MAX_PATH + 1] = { 0 }, ExpandedTargetPath[MAX_PATH + 1] = { 0 };
-	SYSTEM_INFO SystemInfo = { 0 };
+	wchar_t ExpandedTargetPath[MAX_PATH + 1] = { 0 };
 
 	// %programfiles%\example1\example.exe -> C:\Program Files (x86)\example1\example.exe
 	// C:\Program Files (x86)\example2\example.exe -> C:\Program Files (x86)\example2\example.exe
@@ -138,47 +110,15 @@ bool FileBase::ArchWow64PathExpand(const wchar_t* TargetFilePath, wchar_t* Outpu
 	// C:\Windows\system32\notepad.exe -> C:\Windows\syswow64\notepad.exe
 	// C:\ProgramData\something.exe -> C:\ProgramData\something.exe
 
-	if (ExpandEnvironmentStringsW(TargetFilePath, ExpandedTargetPath, MAX_PATH + 1)) {
-		bExpandedPath = true;
-		wcscpy_s(OutputPath, ccOutputPathLength, ExpandedTargetPath);
-
-		GetNativeSystemInfo(&SystemInfo); // Native version of this call works on both Wow64 and x64 as opposed to just x64 for GetSystemInfo. Works on XP+
-
-		if (SystemInfo.wProcessorArchitecture == PROCESSOR_ARCHITECTURE_AMD64) {
-			// Resolve the 32 and 64-bit versions of the most problematic paths (Program Files, System32)
-
-			if ((qwPathLength = GetSystemWow64DirectoryW(SysWow64Directory, MAX_PATH + 1))) {
-				if ((qwPathLength = GetSystemDirectoryW(SystemDirectory, MAX_PATH + 1))) {
-					ProgFilePath64 = make_unique<wchar_t[]>(qwMaxEnvVarSize / sizeof(wchar_t)); // 32,767 is the maximum number of bytes an environment var can be, including the null terminator.
-
-					if ((qwPathLength = GetEnvironmentVariableW(L"ProgramW6432", ProgFilePath64.get(), qwMaxEnvVarSize))) {
-						ProgFilePathWow64 = make_unique<wchar_t[]>(qwMaxEnvVarSize / sizeof(wchar_t)); // 32,767 is the maximum number of bytes an environment var can be, including the null terminator.
-
-						if ((qwPathLength = GetEnvironmentVariableW(L"ProgramFiles(x86)", ProgFilePathWow64.get(), qwMaxEnvVarSize))) {
-							//
-							// Is the target path within one of the two ambiguous architecture directories?
-							//
-
-							if (_wcsnicmp(ProgFilePathWow64.get(), ExpandedTargetPath, wcslen(ProgFilePathWow64.get())) == 0) {
-								// The target path is already within the Wow64 program files path. Do nothing.
-							}
-							else if (_wcsnicmp(SysWow64Directory, ExpandedTargetPath, wcslen(SysWow64Directory)) == 0) {
-								// The target path is already within the Wow64 system path. Do nothing.
-							}
-							else if (_wcsnicmp(SystemDirectory, ExpandedTargetPath, wcslen(SystemDirectory)) == 0) {
-								wcscpy_s(OutputPath, ccOutputPathLength, SysWow64Directory);
-								wcscat_s(OutputPath, ccOutputPathLength, ExpandedTargetPath + wcslen(SystemDirectory));
-							}
-							else if (_wcsnicmp(ProgFilePath64.get(), ExpandedTargetPath, wcslen(ProgFilePath64.get())) == 0) {
-								wcscpy_s(OutputPath, ccOutputPathLength, ProgFilePathWow64.get());
-								wcscat_s(OutputPath, ccOutputPathLength, ExpandedTargetPath + wcslen(ProgFilePath64.get()));
-							}
-						}
-					}
-				}
-			}
+	if (wcschr(TargetFilePath, L'%') != nullptr) { // Loader paths are almost never environment relative, so the environment is only read when needed
+		uint32_t dwExpandedLength = ExpandEnvironmentStringsW(TargetFilePath, ExpandedTargetPath, MAX_PATH + 1);
+
+		if (!dwExpandedLength || dwExpandedLength > MAX_PATH + 1) {
+			return false;
 		}
+
+		TargetFilePath = ExpandedTargetPath;
 	}
 
-	return bExpandedPath;
-}
\ No newline at end of file
+	return PathCanonicalizer::GetSystem().Wow64Redirect(TargetFilePath, OutputPath, ccOutputPathLength);
+}
@@ -37,6 +37,8 @@ wstring Interface::LogFilePath;
 Interface::VerbosityLevel Interface::VerbosityLvl;
 HANDLE Interface::Handle;
 bool Interface::IsStdout;
+thread_local Interface::OutputCapture* Interface::ActiveCapture = nullptr;
+mutex Interface::WriteLock;
 
 void Interface::Initialize(wstring LogFilePath, VerbosityLevel VLvl) {
 	if (LogFilePath.empty()) {
@@ -84,11 +86,38 @@ void Interface::Initialize(vector<wstring> &Args) {
 	Initialize(LogFilePath, VLvl);
 }
 
+bool Interface::Write(const char* Text, bool bColored, ConsoleColor Color) {
+	uint32_t dwBytesWritten = 0;
+	CONSOLE_SCREEN_BUFFER_INFO ConsoleInfo;
+	WORD wOldAttrib;
+	bool bWriteSuccess = false;
+
+	if (Interface::ActiveCapture != nullptr) {
+		Interface::ActiveCapture->Append(Text, bColored, Color);
+		return true;
+	}
+
+	lock_guard<mutex> Guard(Interface::WriteLock); // Console attributes are global: a colored write must not be interleaved with output from another thread
+
+	if (bColored && Interface::IsStdout) {
+		GetConsoleScreenBufferInfo(Interface::Handle, &ConsoleInfo);
+		wOldAttrib = ConsoleInfo.wAttributes;
+		SetConsoleTextAttribute(Interface::Handle, (WORD)Color);
+	}
+
+	bWriteSuccess = WriteFile(Interface::Handle, Text, strlen(Text), reinterpret_cast<PDWORD>(&dwBytesWritten), NULL);
+
+	if (bColored && Interface::IsStdout) {
+		SetConsoleTextAttribute(Interface::Handle, wOldAttrib);
+	}
+
+	return bWriteSuccess;
+}
+
 bool Interface::Log(VerbosityLevel MsgVlvl, const char *LogFormat, ...) {
 	if (MsgVlvl <= Interface::VerbosityLvl) {
 		char LogBuffer[4000] = { 0 };
 		char *pVarList;
-		uint32_t dwBytesWritten = 0;
 
 		va_start(pVarList, LogFormat);
 
@@ -97,7 +126,7 @@ bool Interface::Log(VerbosityLevel MsgVlvl, const char *LogFormat, ...) {
 		}
 
 		va_end(pVarList);
-		return WriteFile(Interface::Handle, LogBuffer, strlen(LogBuffer), reinterpret_cast<PDWORD>(&dwBytesWritten), NULL);
+		return Interface::Write(LogBuffer, false, ConsoleColor::Turquoise);
 	}
 
 	return false;
@@ -106,18 +135,9 @@ bool Interface::Log(VerbosityLevel MsgVlvl, const char *LogFormat, ...) {
 bool Interface::Log(VerbosityLevel MsgVlvl, ConsoleColor Color, const char* LogFormat, ...) {
 	char LogBuffer[4000] = { 0 };
 	char* pVarList;
-	uint32_t dwBytesWritten = 0;
-	CONSOLE_SCREEN_BUFFER_INFO ConsoleInfo;
-	WORD wOldAttrib;
 	bool bWriteSuccess = false;
 
 	if (MsgVlvl <= Interface::VerbosityLvl) {
-		if (Interface::IsStdout) {
-			GetConsoleScreenBufferInfo(Interface::Handle, &ConsoleInfo);
-			wOldAttrib = ConsoleInfo.wAttributes;
-			SetConsoleTextAttribute(Interface::Handle, (WORD)Color);
-		}
-
 		va_start(pVarList, LogFormat);
 
 		if (_vsnprintf_s(LogBuffer, sizeof(LogBuffer), _TRUNCATE, LogFormat, pVarList) == -1) {
@@ -125,16 +145,41 @@ bool Interface::Log(VerbosityLevel MsgVlvl, ConsoleColor Color, const char* LogF
 		}
 
 		va_end(pVarList);
-		bWriteSuccess = WriteFile(Interface::Handle, LogBuffer, strlen(LogBuffer), reinterpret_cast<PDWORD>(&dwBytesWritten), NULL);
-
-		if (Interface::IsStdout) {
-			SetConsoleTextAttribute(Interface::Handle, wOldAttrib);
-		}
+		bWriteSuccess = Interface::Write(LogBuffer, true, Color);
 	}
 
 	return bWriteSuccess;
 }
 
+Interface::OutputCapture* Interface::SetCapture(OutputCapture* Capture) {
+	OutputCapture* PreviousCapture = Interface::ActiveCapture;
+	Interface::ActiveCapture = Capture;
+	return PreviousCapture;
+}
+
+void Interface::OutputCapture::Append(const char* Text, bool bColored, ConsoleColor Color) {
+	lock_guard<mutex> Guard(this->Lock);
+
+	if (!bColored && !this->Segments.empty() && !this->Segments.back().Colored) {
+		this->Segments.back().Text += Text; // Consecutive uncolored output can be coalesced into a single write
+	}
+	else {
+		this->Segments.push_back(Segment{ Text, bColored, Color });
+	}
+}
+
+void Interface::OutputCapture::Flush() {
+	lock_guard<mutex> Guard(this->Lock);
+	OutputCapture* PreviousCapture = Interface::SetCapture(nullptr); // The flush must reach the real log handle even if the calling thread is itself capturing
+
+	for (vector<Segment>::const_iterator Itr = this->Segments.begin(); Itr != this->Segments.end(); ++Itr) {
+		Interface::Write(Itr->Text.c_str(), Itr->Colored, Itr->Color);
+	}
+
+	Interface::SetCapture(PreviousCapture);
+	this->Segments.clear();
+}
+
 void Interface::EnumColors() {
 	for (uint32_t dwX = 0; dwX < 100; dwX++) Interface::Log(Interface::VerbosityLevel::Surface, (ConsoleColor)dwX, "%d ", dwX);
     Interface::Log(Interface::VerbosityLevel::Surface, "\r\n");
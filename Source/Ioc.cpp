@@ -32,16 +32,19 @@ ________________________________________________________________________________
 #include "FileIo.hpp"
 #include "PeFile.hpp"
 #include "Processes.hpp"
+#include "Arena.hpp"
 #include "Memory.hpp"
 #include "Interface.hpp"
 #include "MemDump.hpp"
+#include "LoaderList.hpp"
 #include "Ioc.hpp"
 
 using namespace std;
 using namespace Memory;
 using namespace Processes;
 
-Ioc::Ioc(Process* ParentProc, Entity* ParentObj, Subregion* Block, Ioc::Type Type) : ParentProcess(ParentProc), ParentObject(ParentObj), Sbr(Block), IocType(Type) {}
+Ioc::Ioc(Process* ParentProc, Entity* ParentObj, Subregion* Block, Ioc::Type Type) : ParentProcess(ParentProc), ParentObject(ParentObj), Sbr(Block), IocType(Type), LoaderModule(nullptr) {}
+Ioc::Ioc(Process* ParentProc, const LoaderList::Module* Module, Ioc::Type Type) : ParentProcess(ParentProc), ParentObject(nullptr), Sbr(nullptr), IocType(Type), LoaderModule(Module) {}
 
 bool Ioc::InspectEntity(Process &ParentProc, Entity &ParentObj, map <uint8_t*, map<uint8_t*, list<Ioc *>>> *IocMap) {
 	assert(IocMap != nullptr);
@@ -61,11 +64,11 @@ bool Ioc::InspectEntity(Process &ParentProc, Entity &ParentObj, map <uint8_t*, m
 
 			if (!PeEntity->IsNonExecutableImage()) {
 				if (!PeEntity->GetFileBase()->IsPhantom() && !PeEntity->IsSigned()) {
-					RegionIocList.push_back(new Ioc(&ParentProc, &ParentObj, nullptr, UNSIGNED_MODULE));
+					RegionIocList.push_back(ParentProc.GetArena()->New<Ioc>(&ParentProc, &ParentObj, nullptr, UNSIGNED_MODULE));
 				}
 
 				if (!PeEntity->GetPebModule().Exists()) {
-					RegionIocList.push_back(new Ioc(&ParentProc, &ParentObj, nullptr, MISSING_PEB_ENTRY));
+					RegionIocList.push_back(ParentProc.GetArena()->New<Ioc>(&ParentProc, &ParentObj, nullptr, MISSING_PEB_ENTRY));
 				}
 				else {
 					if (_wcsicmp(PeEntity->GetPebModule().GetPath().c_str(), PeEntity->GetFileBase()->GetPath().c_str()) != 0) { // Since the PEB module is queried by base address with GetModuleInfo/GetModuleFileNameExW rather than by name with GetModuleHandleEx, there may be a PEB link with a base address matching this image region but with a misleading name/path
@@ -74,45 +77,45 @@ bool Ioc::InspectEntity(Process &ParentProc, Entity &ParentObj, map <uint8_t*, m
 
 							if (FileBase::ArchWow64PathExpand(PeEntity->GetPebModule().GetPath().c_str(), ReFormattedPath, MAX_PATH + 1)) {
 								if (_wcsicmp(ReFormattedPath, PeEntity->GetFileBase()->GetPath().c_str()) != 0) {
-									RegionIocList.push_back(new Ioc(&ParentProc, &ParentObj, nullptr, MISMATCHING_PEB_MODULE));
+									RegionIocList.push_back(ParentProc.GetArena()->New<Ioc>(&ParentProc, &ParentObj, nullptr, MISMATCHING_PEB_MODULE));
 								}
 							}
 						}
 						else {
-							RegionIocList.push_back(new Ioc(&ParentProc, &ParentObj, nullptr, MISMATCHING_PEB_MODULE));
+							RegionIocList.push_back(ParentProc.GetArena()->New<Ioc>(&ParentProc, &ParentObj, nullptr, MISMATCHING_PEB_MODULE));
 						}
 					}
 				}
 
 				if (PeEntity->GetPeFile() != nullptr) {
-					vector<PeVm::Section*> Sections = PeEntity->GetSections();
-					for (vector<PeVm::Section*>::const_iterator SectItr = Sections.begin(); SectItr != Sections.end(); ++SectItr) {
-						vector<Subregion*> Subregions = (*SectItr)->GetSubregions();
+					const vector<PeVm::Section>& Sections = PeEntity->GetSections();
+					for (vector<PeVm::Section>::const_iterator SectItr = Sections.begin(); SectItr != Sections.end(); ++SectItr) {
+						vector<Subregion*> Subregions = SectItr->GetSubregions();
 
 						for (vector<Subregion*>::iterator SbrItr = Subregions.begin(); SbrItr != Subregions.end(); ++SbrItr) {
 							list<Ioc *> SbIocList;
-							list<Ioc *>& TargetIocList = (*SbrItr)->GetBasic()->BaseAddress == ParentObj.GetStartVa() ? RegionIocList : SbIocList;
+							list<Ioc *>& TargetIocList = (*SbrItr)->GetBase() == ParentObj.GetStartVa() ? RegionIocList : SbIocList;
 
-							if (strcmp(reinterpret_cast<const char*>((*SectItr)->GetHeader()->Name), "Header") == 0 && (*SbrItr)->GetPrivateSize()) {
-								TargetIocList.push_back(new Ioc(&ParentProc, &ParentObj, *SbrItr, MODIFIED_HEADER));
+							if (strcmp(reinterpret_cast<const char*>(SectItr->GetHeader()->Name), "Header") == 0 && (*SbrItr)->GetPrivateSize()) {
+								TargetIocList.push_back(ParentProc.GetArena()->New<Ioc>(&ParentProc, &ParentObj, *SbrItr, MODIFIED_HEADER));
 							}
 
-							if (Subregion::PageExecutable((*SbrItr)->GetBasic()->Protect) && !((*SectItr)->GetHeader()->Characteristics & IMAGE_SCN_MEM_EXECUTE)) {
-								TargetIocList.push_back(new Ioc(&ParentProc, &ParentObj, *SbrItr, DISK_PERMISSION_MISMATCH));
+							if (Subregion::PageExecutable((*SbrItr)->GetProtect()) && !(SectItr->GetHeader()->Characteristics & IMAGE_SCN_MEM_EXECUTE)) {
+								TargetIocList.push_back(ParentProc.GetArena()->New<Ioc>(&ParentProc, &ParentObj, *SbrItr, DISK_PERMISSION_MISMATCH));
 							}
 
-							if (Subregion::PageExecutable((*SbrItr)->GetBasic()->Protect) && (*SbrItr)->GetPrivateSize()) {
-								TargetIocList.push_back(new Ioc(&ParentProc, &ParentObj, *SbrItr, MODIFIED_CODE));
+							if (Subregion::PageExecutable((*SbrItr)->GetProtect()) && (*SbrItr)->GetPrivateSize()) {
+								TargetIocList.push_back(ParentProc.GetArena()->New<Ioc>(&ParentProc, &ParentObj, *SbrItr, MODIFIED_CODE));
 							}
 
 							if (SbIocList.size()) { // Do not insert the list to the map if it overlaps with the region.
-								RefSubregionMap.insert(make_pair(static_cast<uint8_t *>((*SbrItr)->GetBasic()->BaseAddress), SbIocList));
+								RefSubregionMap.insert(make_pair(static_cast<uint8_t *>((*SbrItr)->GetBase()), SbIocList));
 							}
 						}
 					}
 				}
 				else {
-					RegionIocList.push_back(new Ioc(&ParentProc, &ParentObj, nullptr, PHANTOM_IMAGE));
+					RegionIocList.push_back(ParentProc.GetArena()->New<Ioc>(&ParentProc, &ParentObj, nullptr, PHANTOM_IMAGE));
 				}
 			}
 
@@ -120,26 +123,28 @@ bool Ioc::InspectEntity(Process &ParentProc, Entity &ParentObj, map <uint8_t*, m
 		}
 		case Entity::Type::MAPPED_FILE: {
 			vector<Subregion*> Subregions = ParentObj.GetSubregions(); // This must be done explicitly, otherwise each time GetSubregions is called a temporary copy of the list is created and the begin/end iterators will become useless in identifying the end of the list, causing an exception as it loops out of bounds.
+			vector<uint8_t> ExecutableMask(Subregions.size());
+
+			Subregions.front()->GetTable()->ExecutableMask(Subregions.front()->GetIndex(), Subregions.size(), ExecutableMask.data()); // The subregions of an entity are consecutive rows of the region table
+
 			for (vector<Subregion*>::iterator SbrItr = Subregions.begin(); SbrItr != Subregions.end(); ++SbrItr) {
 				list<Ioc *> SbIocList;
-				vector<Processes::Thread*> Threads = ParentProc.GetThreads();
+				vector<Processes::Thread*> Threads = (*SbrItr)->GetThreads(); // Threads with a start address in this subregion, attributed when the process was mapped
 
 				for (vector<Processes::Thread*>::const_iterator ThItr = Threads.begin(); ThItr != Threads.end(); ++ThItr) {
-					if ((*ThItr)->GetEntryPoint() >= (*SbrItr)->GetBasic()->BaseAddress && (*ThItr)->GetEntryPoint() < (static_cast<uint8_t *>((*SbrItr)->GetBasic()->BaseAddress) + (*SbrItr)->GetBasic()->RegionSize)) {
-						SbIocList.push_back(new Ioc(&ParentProc, &ParentObj, *SbrItr, NON_IMAGE_THREAD));
-					}
+					SbIocList.push_back(ParentProc.GetArena()->New<Ioc>(&ParentProc, &ParentObj, *SbrItr, NON_IMAGE_THREAD));
 				}
 				
-				if (Subregion::PageExecutable((*SbrItr)->GetBasic()->Protect)) {
-					SbIocList.push_back(new Ioc(&ParentProc, &ParentObj, *SbrItr, XMAP));
+				if (ExecutableMask[SbrItr - Subregions.begin()]) {
+					SbIocList.push_back(ParentProc.GetArena()->New<Ioc>(&ParentProc, &ParentObj, *SbrItr, XMAP));
 				}
 
 				if (((*SbrItr)->GetFlags() & MEMORY_SUBREGION_FLAG_BASE_IMAGE)) {
-					SbIocList.push_back(new Ioc(&ParentProc, &ParentObj, *SbrItr, NON_IMAGE_IMAGEBASE));
+					SbIocList.push_back(ParentProc.GetArena()->New<Ioc>(&ParentProc, &ParentObj, *SbrItr, NON_IMAGE_IMAGEBASE));
 				}
 
 				if (SbIocList.size()) {
-					RefSubregionMap.insert(make_pair(static_cast<uint8_t *>((*SbrItr)->GetBasic()->BaseAddress), SbIocList));
+					RefSubregionMap.insert(make_pair(static_cast<uint8_t *>((*SbrItr)->GetBase()), SbIocList));
 				}
 			}
 
@@ -148,27 +153,29 @@ bool Ioc::InspectEntity(Process &ParentProc, Entity &ParentObj, map <uint8_t*, m
 		case Entity::Type::UNKNOWN: {
 			vector<Subregion*> Subregions = ParentObj.GetSubregions(); // This must be done explicitly, otherwise each time GetSubregions is called a temporary copy of the list is created and the begin/end iterators will become useless in identifying the end of the list, causing an exception as it loops out of bounds.
 
-			if (Subregions.front()->GetBasic()->Type == MEM_PRIVATE) {
+			if (Subregions.front()->GetMemoryType() == MEM_PRIVATE) {
+				vector<uint8_t> ExecutableMask(Subregions.size());
+
+				Subregions.front()->GetTable()->ExecutableMask(Subregions.front()->GetIndex(), Subregions.size(), ExecutableMask.data());
+
 				for (vector<Subregion*>::iterator SbrItr = Subregions.begin(); SbrItr != Subregions.end(); ++SbrItr) {
 					list<Ioc *> SbIocList;
-					if (Subregion::PageExecutable((*SbrItr)->GetBasic()->Protect)) {
-						SbIocList.push_back(new Ioc(&ParentProc, &ParentObj, *SbrItr, XPRV));
+					if (ExecutableMask[SbrItr - Subregions.begin()]) {
+						SbIocList.push_back(ParentProc.GetArena()->New<Ioc>(&ParentProc, &ParentObj, *SbrItr, XPRV));
 					}
 
 					if (((*SbrItr)->GetFlags() & MEMORY_SUBREGION_FLAG_BASE_IMAGE)) {
-						SbIocList.push_back(new Ioc(&ParentProc, &ParentObj, *SbrItr, NON_IMAGE_IMAGEBASE));
+						SbIocList.push_back(ParentProc.GetArena()->New<Ioc>(&ParentProc, &ParentObj, *SbrItr, NON_IMAGE_IMAGEBASE));
 					}
 
-					vector<Processes::Thread*> Threads = ParentProc.GetThreads();
+					vector<Processes::Thread*> Threads = (*SbrItr)->GetThreads();
 
 					for (vector<Processes::Thread*>::const_iterator ThItr = Threads.begin(); ThItr != Threads.end(); ++ThItr) {
-						if ((*ThItr)->GetEntryPoint() >= (*SbrItr)->GetBasic()->BaseAddress && (*ThItr)->GetEntryPoint() < (static_cast<uint8_t*>((*SbrItr)->GetBasic()->BaseAddress) + (*SbrItr)->GetBasic()->RegionSize)) {
-							SbIocList.push_back(new Ioc(&ParentProc, &ParentObj, *SbrItr, NON_IMAGE_THREAD));
-						}
+						SbIocList.push_back(ParentProc.GetArena()->New<Ioc>(&ParentProc, &ParentObj, *SbrItr, NON_IMAGE_THREAD));
 					}
 
 					if (SbIocList.size()) {
-						RefSubregionMap.insert(make_pair(static_cast<uint8_t *>((*SbrItr)->GetBasic()->BaseAddress), SbIocList));
+						RefSubregionMap.insert(make_pair(static_cast<uint8_t *>((*SbrItr)->GetBase()), SbIocList));
 					}
 				}
 			}
@@ -188,6 +195,53 @@ bool Ioc::InspectEntity(Process &ParentProc, Entity &ParentObj, map <uint8_t*, m
 	return true;
 }
 
+int32_t Ioc::InspectLoaderList(Process& ParentProc, map <uint8_t*, map<uint8_t*, list<Ioc*>>>* IocMap) {
+	assert(IocMap != nullptr);
+
+	const LoaderList* Loader = ParentProc.GetLoaderList();
+	const map<uint8_t*, Entity*>& Entities = ParentProc.GetEntities();
+	unordered_set<uintptr_t> ImageBases;
+	int32_t nOrphanCount = 0;
+
+	if (Loader == nullptr) {
+		return 0;
+	}
+
+	// Join the loader entries to the image entities of the process by base address. An entry with no image at its base (for example a module which was stomped
+	// or manually unmapped) is attributed to the entity which holds its base instead, if there is one. An entry with no allocation at its base at all (the module
+	// was unmapped or hollowed out while it remained linked into the PEB) is raised against the process itself, keyed by the base of the entry.
+
+	for (map<uint8_t*, Entity*>::const_iterator EntItr = Entities.begin(); EntItr != Entities.end(); ++EntItr) {
+		if (EntItr->second->GetType() == Entity::Type::PE_FILE) {
+			ImageBases.insert(reinterpret_cast<uintptr_t>(EntItr->first));
+		}
+	}
+
+	for (unordered_map<uint64_t, LoaderList::Module>::const_iterator ModItr = Loader->GetModules().begin(); ModItr != Loader->GetModules().end(); ++ModItr) {
+		if (ImageBases.count(static_cast<uintptr_t>(ModItr->first))) {
+			continue;
+		}
+
+		uint8_t* pModBase = reinterpret_cast<uint8_t*>(static_cast<uintptr_t>(ModItr->first));
+		map<uint8_t*, Entity*>::const_iterator EntItr = Entities.upper_bound(pModBase);
+
+		nOrphanCount++;
+
+		if (EntItr != Entities.begin() && pModBase < static_cast<const uint8_t*>((--EntItr)->second->GetEndVa())) {
+			uint8_t* pEntityBase = static_cast<uint8_t*>(const_cast<void*>(EntItr->second->GetStartVa()));
+
+			Interface::Log(Interface::VerbosityLevel::Debug, "... loader entry for %ws has a base of 0x%p within non-image memory at 0x%p\r\n", ModItr->second.Name.c_str(), pModBase, pEntityBase);
+			(*IocMap)[pEntityBase][pEntityBase].push_back(ParentProc.GetArena()->New<Ioc>(&ParentProc, EntItr->second, nullptr, ORPHANED_PEB_ENTRY));
+		}
+		else {
+			Interface::Log(Interface::VerbosityLevel::Debug, "... loader entry for %ws has a base of 0x%p outside of any allocation\r\n", ModItr->second.Name.c_str(), pModBase);
+			(*IocMap)[pModBase][pModBase].push_back(ParentProc.GetArena()->New<Ioc>(&ParentProc, &ModItr->second, ORPHANED_PEB_ENTRY));
+		}
+	}
+
+	return nOrphanCount;
+}
+
 wstring Ioc::GetDescription(Ioc::Type Type) {
 	switch (Type) {
 	case MODIFIED_CODE: return L"Modified code";
@@ -201,6 +255,7 @@ wstring Ioc::GetDescription(Ioc::Type Type) {
 	case XPRV: return L"Abnormal private executable memory";
 	case NON_IMAGE_THREAD: return L"Thread within non-image memory region";
 	case NON_IMAGE_IMAGEBASE: return L"Non-image primary image base";
+	case ORPHANED_PEB_ENTRY: return L"Orphaned PEB module";
 	default: return L"?";
 	}
 }
@@ -232,6 +287,38 @@ IocMap::IocMap() {
 
 int32_t IocMap::Filter(uint64_t qwFilterFlags) {
 	bool bReWalkMap = false;
+	map<const Entity*, bool> ClrAffiliations;
+
+	if ((qwFilterFlags & FILTER_FLAG_CLR_PRVX)) {
+		// Resolve the CLR affiliation of every private +x region up front: the regions of each process are searched for together in one pass over its address
+		// space, rather than once per IOC (and again on each re-walk of the map).
+
+		map<const Process*, vector<const Entity*>> PrvxEntities;
+
+		for (map <uint8_t*, map<uint8_t*, list<Ioc*>>>::const_iterator RegionMapItr = this->Map->begin(); RegionMapItr != this->Map->end(); ++RegionMapItr) {
+			for (map<uint8_t*, list<Ioc*>>::const_iterator SubregionMapItr = RegionMapItr->second.begin(); SubregionMapItr != RegionMapItr->second.end(); ++SubregionMapItr) {
+				for (list<Ioc*>::const_iterator IocListItr = SubregionMapItr->second.begin(); IocListItr != SubregionMapItr->second.end(); ++IocListItr) {
+					if ((*IocListItr)->GetType() == Ioc::Type::XPRV && ClrAffiliations.insert(make_pair((*IocListItr)->GetParentObject(), false)).second) {
+						PrvxEntities[(*IocListItr)->GetProcess()].push_back((*IocListItr)->GetParentObject());
+					}
+				}
+			}
+		}
+
+		for (map<const Process*, vector<const Entity*>>::const_iterator ProcItr = PrvxEntities.begin(); ProcItr != PrvxEntities.end(); ++ProcItr) {
+			vector<pair<const uint8_t*, uint32_t>> Targets;
+
+			for (vector<const Entity*>::const_iterator EntItr = ProcItr->second.begin(); EntItr != ProcItr->second.end(); ++EntItr) {
+				Targets.push_back(make_pair(static_cast<const uint8_t*>((*EntItr)->GetStartVa()), (*EntItr)->GetEntitySize()));
+			}
+
+			vector<bool> Affiliations = ProcItr->first->CheckDotNetAffiliation(Targets);
+
+			for (size_t nX = 0; nX < Affiliations.size(); nX++) {
+				ClrAffiliations[ProcItr->second[nX]] = Affiliations[nX];
+			}
+		}
+	}
 
 	do {
 		if (bReWalkMap) {
@@ -264,12 +351,12 @@ int32_t IocMap::Filter(uint64_t qwFilterFlags) {
 						}
 
 						if ((qwFilterFlags & FILTER_FLAG_CLR_PRVX)) {
-							if ((*IocListItr)->GetProcess()->CheckDotNetAffiliation(static_cast<uint8_t*>(const_cast<void*>((*IocListItr)->GetParentObject()->GetStartVa())), (*IocListItr)->GetParentObject()->GetEntitySize())) {
+							if (ClrAffiliations[(*IocListItr)->GetParentObject()]) {
 								bReWalkMap = true;
 								this->EraseIoc(&RefIocList, IocListItr, &RefSubregionMap, SubregionMapItr, RegionMapItr);
 							}
 							else {
-								Interface::Log(Interface::VerbosityLevel::Debug, "... no .NET affiliation found for suspicion of private +x at 0x%p\r\n", (*IocListItr)->GetSubregion()->GetBasic()->BaseAddress);
+								Interface::Log(Interface::VerbosityLevel::Debug, "... no .NET affiliation found for suspicion of private +x at 0x%p\r\n", (*IocListItr)->GetSubregion()->GetBase());
 							}
 						}
 
@@ -308,8 +395,8 @@ int32_t IocMap::Filter(uint64_t qwFilterFlags) {
 
 							if (PeEntity->IsSigned()) {
 								if (wcslen(PeEntity->GetFileBase()->GetPath().c_str()) > wcslen(Wow64CpuDll) && _wcsicmp(PeEntity->GetFileBase()->GetPath().c_str() + wcslen(PeEntity->GetFileBase()->GetPath().c_str()) - wcslen(Wow64CpuDll), Wow64CpuDll) == 0) {
-									PeVm::Section* W64SvcSection = PeEntity->GetSection("W64SVC");
-									if ((*IocListItr)->GetSubregion()->GetBasic()->BaseAddress == W64SvcSection->GetStartVa()) { // There's an edge case where the section preceeding W64SVC is also +x, resulting in the subregion for this IOC starting prior to this section address
+									const PeVm::Section* W64SvcSection = PeEntity->GetSection("W64SVC");
+									if ((*IocListItr)->GetSubregion()->GetBase() == W64SvcSection->GetStartVa()) { // There's an edge case where the section preceeding W64SVC is also +x, resulting in the subregion for this IOC starting prior to this section address
 										Interface::Log(Interface::VerbosityLevel::Debug, "... found disk permission mismatch suspicion on signed %ws overlapping with W64SVC section at 0x%p\r\n", PeEntity->GetFileBase()->GetPath().c_str(), W64SvcSection->GetStartVa());
 										bReWalkMap = true;
 										this->EraseIoc(&RefIocList, IocListItr, &RefSubregionMap, SubregionMapItr, RegionMapItr);
@@ -327,8 +414,8 @@ int32_t IocMap::Filter(uint64_t qwFilterFlags) {
 
 							if ((*IocListItr)->GetProcess()->IsWow64() && PeEntity->IsSigned()) {
 								if (wcslen(PeEntity->GetFileBase()->GetPath().c_str()) > wcslen(User32Dll) && _wcsicmp(PeEntity->GetFileBase()->GetPath().c_str() + wcslen(PeEntity->GetFileBase()->GetPath().c_str()) - wcslen(User32Dll), User32Dll) == 0) {
-									PeVm::Section* W64SvcSection = PeEntity->GetSection(".text");
-									if ((*IocListItr)->GetSubregion()->GetBasic()->BaseAddress == W64SvcSection->GetStartVa()) {
+									const PeVm::Section* W64SvcSection = PeEntity->GetSection(".text");
+									if ((*IocListItr)->GetSubregion()->GetBase() == W64SvcSection->GetStartVa()) {
 										Interface::Log(Interface::VerbosityLevel::Debug, "... found modified code IOC overlapping with signed %ws .text section at 0x%p\r\n", PeEntity->GetFileBase()->GetPath().c_str(), W64SvcSection->GetStartVa());
 										bReWalkMap = true;
 										this->EraseIoc(&RefIocList, IocListItr, &RefSubregionMap, SubregionMapItr, RegionMapItr);
@@ -355,7 +442,10 @@ void IocMap::Enumerate() {
 			Interface::Log(Interface::VerbosityLevel::Surface, "  0x%p [%d list elements]\r\n", SubregionMapItr->first, SubregionMapItr->second.size());
 			for (list<Ioc*>::const_iterator ListItr = SubregionMapItr->second.begin(); ListItr != SubregionMapItr->second.end(); ++ListItr) {
 				if (!(*ListItr)->IsFullEntityIoc()) {
-					Interface::Log(Interface::VerbosityLevel::Surface, "    0x%p : %d : %ws\r\n", (*ListItr)->GetSubregion()->GetBasic()->BaseAddress, (*ListItr)->GetType(), (*ListItr)->GetDescription((*ListItr)->GetType()).c_str());
+					Interface::Log(Interface::VerbosityLevel::Surface, "    0x%p : %d : %ws\r\n", (*ListItr)->GetSubregion()->GetBase(), (*ListItr)->GetType(), (*ListItr)->GetDescription((*ListItr)->GetType()).c_str());
+				}
+				else if ((*ListItr)->IsProcessIoc()) {
+					Interface::Log(Interface::VerbosityLevel::Surface, "    0x%p : %d : %ws : %ws\r\n", reinterpret_cast<void*>(static_cast<uintptr_t>((*ListItr)->GetLoaderModule()->Base)), (*ListItr)->GetType(), (*ListItr)->GetDescription((*ListItr)->GetType()).c_str(), (*ListItr)->GetLoaderModule()->Name.c_str());
 				}
 				else {
 					Interface::Log(Interface::VerbosityLevel::Surface, "    0x%p : %d : %ws : Full entity\r\n", (*ListItr)->GetParentObject()->GetStartVa(), (*ListItr)->GetType(), (*ListItr)->GetDescription((*ListItr)->GetType()).c_str());
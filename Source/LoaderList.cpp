@@ -0,0 +1,123 @@
+/*
+__________________________________________________________________________________________
+| _______  _____  __   _ _______ _______ _______                                         |
+| |  |  | |     | | \  | |______    |    |_____|                                         |
+| |  |  | |_____| |  \_| |______    |    |     |                                         |
+|________________________________________________________________________________________|
+| Moneta ~ Usermode memory scanner & malware hunter                                      |
+|----------------------------------------------------------------------------------------|
+| https://www.forrest-orr.net/post/malicious-memory-artifacts-part-ii-bypassing-scanners |
+|----------------------------------------------------------------------------------------|
+| Author: Forrest Orr - 2020                                                             |
+|----------------------------------------------------------------------------------------|
+| Contact: forrest.orr@protonmail.com                                                    |
+|----------------------------------------------------------------------------------------|
+| Licensed under GNU GPLv3                                                               |
+|________________________________________________________________________________________|
+| ## Features                                                                            |
+|                                                                                        |
+| ~ Query the memory attributes of any accessible process(es).                           |
+| ~ Identify private, mapped and image memory.                                           |
+| ~ Correlate regions of memory to their underlying file on disks.                       |
+| ~ Identify PE headers and sections corresponding to image memory.                      |
+| ~ Identify modified regions of mapped image memory.                                    |
+| ~ Identify abnormal memory attributes indicative of malware.                           |
+| ~ Create memory dumps of user-specified memory ranges                                  |
+| ~ Calculate memory permission/type statistics                                          |
+|________________________________________________________________________________________|
+
+*/
+
+#include "StdAfx.h"
+#include "PEB.h"
+#include "LoaderList.hpp"
+
+using namespace std;
+using namespace Processes;
+
+static uint16_t NameLength(const UNICODE_STRING32& Name) {
+	return Name.Length;
+}
+
+static uint16_t NameLength(const UNICODE_STRING64& Name) {
+	return Name.u.Length;
+}
+
+wstring LoaderList::ReadName(const Reader_t& Read, uint64_t qwBuffer, uint16_t wLength) {
+	wstring Name;
+
+	if (qwBuffer != 0 && wLength != 0 && wLength <= MaxNameSize) {
+		Name.resize(wLength / sizeof(wchar_t));
+
+		if (!Read(qwBuffer, &Name[0], Name.size() * sizeof(wchar_t))) {
+			Name.clear();
+		}
+	}
+
+	return Name;
+}
+
+template<typename Entry_t, typename Pointer_t> size_t LoaderList::WalkList(const Reader_t& Read, uint64_t qwHead, size_t nLinksOffset, bool bLoadOrder) {
+	Pointer_t Link = 0;
+	size_t nEntryCount = 0;
+
+	if (!Read(qwHead, &Link, sizeof(Link))) { // Flink of the list head
+		return 0;
+	}
+
+	// Each link points at the links of the same list within the next entry, which is at a fixed offset from the start of the entry for each of the lists.
+
+	for (; Link != 0 && Link != qwHead && nEntryCount < MaxEntries; nEntryCount++) {
+		Entry_t Entry = { 0 };
+		uint64_t qwEntry = static_cast<uint64_t>(Link) - nLinksOffset;
+
+		if (!Read(qwEntry, &Entry, sizeof(Entry))) {
+			break;
+		}
+
+		unordered_map<uint64_t, Module>::iterator ModItr = this->Modules.find(Entry.DllBase);
+
+		if (ModItr == this->Modules.end()) {
+			Module NewMod = { Entry.DllBase, Entry.EntryPoint, Entry.SizeOfImage, ReadName(Read, Entry.BaseDllName.Buffer, NameLength(Entry.BaseDllName)), ReadName(Read, Entry.FullDllName.Buffer, NameLength(Entry.FullDllName)), false, false };
+			ModItr = this->Modules.insert(make_pair(static_cast<uint64_t>(Entry.DllBase), NewMod)).first;
+		}
+
+		if (bLoadOrder) {
+			ModItr->second.InLoadOrder = true;
+		}
+		else {
+			ModItr->second.InMemoryOrder = true;
+		}
+
+		if (!Read(static_cast<uint64_t>(Link), &Link, sizeof(Link))) {
+			break;
+		}
+	}
+
+	return nEntryCount;
+}
+
+template<typename Peb_t, typename LdrData_t, typename Entry_t, typename Pointer_t> bool LoaderList::Walk(const Reader_t& Read, uint64_t qwPeb) {
+	Pointer_t Ldr = 0;
+
+	if (!Read(qwPeb + offsetof(Peb_t, Ldr), &Ldr, sizeof(Ldr)) || Ldr == 0) {
+		return false;
+	}
+
+	this->WalkList<Entry_t, Pointer_t>(Read, Ldr + offsetof(LdrData_t, InLoadOrderModuleList), offsetof(Entry_t, InLoadOrderLinks), true);
+	this->WalkList<Entry_t, Pointer_t>(Read, Ldr + offsetof(LdrData_t, InMemoryOrderModuleList), offsetof(Entry_t, InMemoryOrderLinks), false);
+	return true;
+}
+
+bool LoaderList::Walk32(const Reader_t& Read, uint64_t qwPeb) {
+	return this->Walk<PEB32, PEB_LDR_DATA32, LDR_DATA_TABLE_ENTRY32, uint32_t>(Read, qwPeb);
+}
+
+bool LoaderList::Walk64(const Reader_t& Read, uint64_t qwPeb) {
+	return this->Walk<PEB64, PEB_LDR_DATA64, LDR_DATA_TABLE_ENTRY64, uint64_t>(Read, qwPeb);
+}
+
+const LoaderList::Module* LoaderList::Find(const void* pBase) const {
+	unordered_map<uint64_t, Module>::const_iterator ModItr = this->Modules.find(reinterpret_cast<uintptr_t>(pBase));
+	return ModItr != this->Modules.end() ? &ModItr->second : nullptr;
+}
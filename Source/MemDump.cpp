@@ -34,6 +34,8 @@ ________________________________________________________________________________
 #include "PeFile.hpp"
 #include "Processes.hpp"
 #include "Memory.hpp"
+#include "Interface.hpp"
+#include "RegionReader.hpp"
 
 using namespace std;
 using namespace Memory;
@@ -46,11 +48,12 @@ bool MemDump::Create(wstring Folder, const MEMORY_BASIC_INFORMATION *Mbi,  wchar
 	assert(Mbi != nullptr);
 	assert(DumpFilePath != nullptr);
 
-	SIZE_T cbBytesRead = 0;
-	unique_ptr<uint8_t[]> Buf = make_unique<uint8_t[]>(Mbi->RegionSize);
+	RegionReader Reader(this->Handle, Mbi->BaseAddress, Mbi->RegionSize, 0, REGION_READER_FLAG_FILL_UNREADABLE); // The region is streamed to disk one chunk at a time rather than read into a buffer of its full size. Unreadable pages are written as zeros so that offsets within the dump match the region
 	wstring TargetDmpFolder;
+	HANDLE hFile;
+	bool bWritten = false;
 
-	if (ReadProcessMemory(this->Handle, Mbi->BaseAddress, Buf.get(), Mbi->RegionSize, static_cast<SIZE_T*>(&cbBytesRead))) {
+	if (Reader.Next()) {
 		if (!Folder.empty()) {
 			TargetDmpFolder = MemDump::Folder + L"\\" + Folder;
 
@@ -63,32 +66,40 @@ bool MemDump::Create(wstring Folder, const MEMORY_BASIC_INFORMATION *Mbi,  wchar
 		}
 
 		swprintf_s(DumpFilePath, ccDumpFilePathLen, L"%ws\\%d_%p_%ws_%ws.dat", TargetDmpFolder.c_str(), this->Pid, Mbi->BaseAddress, Subregion::AttribDesc(Mbi), Subregion::TypeSymbol(Mbi->Type));
-		FileBase DumpFile(DumpFilePath, Buf.get(), cbBytesRead);
-		return DumpFile.ToDisk();
-	}
 
-	return false;
-}
+		if ((hFile = CreateFileW(DumpFilePath, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr)) != INVALID_HANDLE_VALUE) {
+			do {
+				uint32_t dwBytesWritten;
 
-bool MemDump::Create(const MEMORY_BASIC_INFORMATION* Mbi, wchar_t* DumpFilePath, size_t ccDumpFilePathLen) const {
-	return Create(L"", Mbi, DumpFilePath, ccDumpFilePathLen);
-}
+				if (!WriteFile(hFile, Reader.GetData(), static_cast<uint32_t>(Reader.GetSize()), reinterpret_cast<PDWORD>(&dwBytesWritten), nullptr) || dwBytesWritten != Reader.GetSize()) {
+					bWritten = false;
+					break;
+				}
+
+				bWritten = true;
+			} while (Reader.Next());
 
-bool MemDump::Create(const MEMORY_BASIC_INFORMATION* Mbi, uint8_t** ppDmpBuf, uint32_t* pdwDmpSize) const {
-	assert(ppDmpBuf != nullptr);
-	assert(pdwDmpSize != nullptr);
+			CloseHandle(hFile);
 
-	SIZE_T cbBytesRead = 0;
-	unique_ptr<uint8_t[]> Buf = make_unique<uint8_t[]>(Mbi->RegionSize);
+			if (bWritten && Reader.GetUnreadableRanges().size() == 1 && Reader.GetUnreadableRanges().front().second == Mbi->RegionSize) { // Nothing in the region could be read
+				bWritten = false;
+			}
 
-	if (ReadProcessMemory(this->Handle, Mbi->BaseAddress, Buf.get(), Mbi->RegionSize, static_cast<SIZE_T*>(&cbBytesRead))) {
-		*pdwDmpSize = cbBytesRead;
-		*ppDmpBuf = Buf.get();
-		Buf.release();
-		return true;
+			if (!bWritten) { // A write which failed part way through would otherwise leave a truncated dump which looks complete
+				DeleteFileW(DumpFilePath);
+			}
+		}
+
+		for (vector<pair<size_t, size_t>>::const_iterator RangeItr = Reader.GetUnreadableRanges().begin(); RangeItr != Reader.GetUnreadableRanges().end(); ++RangeItr) {
+			Interface::Log(Interface::VerbosityLevel::Debug, "... zero filled 0x%Ix unreadable bytes at 0x%p in dump\r\n", RangeItr->second, static_cast<uint8_t*>(Mbi->BaseAddress) + RangeItr->first);
+		}
 	}
 
-	return false;
+	return bWritten;
+}
+
+bool MemDump::Create(const MEMORY_BASIC_INFORMATION* Mbi, wchar_t* DumpFilePath, size_t ccDumpFilePathLen) const {
+	return Create(L"", Mbi, DumpFilePath, ccDumpFilePathLen);
 }
 
 bool MemDump::Initialize() {
@@ -0,0 +1,90 @@
+/*
+__________________________________________________________________________________________
+| _______  _____  __   _ _______ _______ _______                                         |
+| |  |  | |     | | \  | |______    |    |_____|                                         |
+| |  |  | |_____| |  \_| |______    |    |     |                                         |
+|________________________________________________________________________________________|
+| Moneta ~ Usermode memory scanner & malware hunter                                      |
+|----------------------------------------------------------------------------------------|
+| https://www.forrest-orr.net/post/malicious-memory-artifacts-part-ii-bypassing-scanners |
+|----------------------------------------------------------------------------------------|
+| Author: Forrest Orr - 2020                                                             |
+|----------------------------------------------------------------------------------------|
+| Contact: forrest.orr@protonmail.com                                                    |
+|----------------------------------------------------------------------------------------|
+| Licensed under GNU GPLv3                                                               |
+|________________________________________________________________________________________|
+| ## Features                                                                            |
+|                                                                                        |
+| ~ Query the memory attributes of any accessible process(es).                           |
+| ~ Identify private, mapped and image memory.                                           |
+| ~ Correlate regions of memory to their underlying file on disks.                       |
+| ~ Identify PE headers and sections corresponding to image memory.                      |
+| ~ Identify modified regions of mapped image memory.                                    |
+| ~ Identify abnormal memory attributes indicative of malware.                           |
+| ~ Create memory dumps of user-specified memory ranges                                  |
+| ~ Calculate memory permission/type statistics                                          |
+|________________________________________________________________________________________|
+
+*/
+
+#include "StdAfx.h"
+#include "Memory.hpp"
+
+using namespace std;
+using namespace Memory;
+
+void PageBitmap::Resize(size_t nPageCount) {
+	this->PageCount = nPageCount;
+	this->Words.assign((nPageCount + 63) / 64, 0);
+}
+
+size_t PageBitmap::Count() const {
+	size_t nCount = 0;
+
+	for (vector<uint64_t>::const_iterator Itr = this->Words.begin(); Itr != this->Words.end(); ++Itr) {
+		nCount += bitset<64>(*Itr).count();
+	}
+
+	return nCount;
+}
+
+vector<pair<size_t, size_t>> PageBitmap::GetRuns() const {
+	vector<pair<size_t, size_t>> Runs;
+	size_t nRunStart = 0, nRunLength = 0;
+
+	for (size_t nWord = 0; nWord < this->Words.size(); nWord++) {
+		if (!this->Words[nWord] && !nRunLength) { // Words without any set pages are skipped whole unless they end an open run
+			continue;
+		}
+
+		for (size_t nPage = nWord * 64; nPage < min(this->PageCount, (nWord + 1) * 64); nPage++) {
+			if (this->Test(nPage)) {
+				if (!nRunLength) {
+					nRunStart = nPage;
+				}
+
+				nRunLength++;
+			}
+			else if (nRunLength) {
+				Runs.push_back(make_pair(nRunStart, nRunLength));
+				nRunLength = 0;
+			}
+		}
+	}
+
+	if (nRunLength) {
+		Runs.push_back(make_pair(nRunStart, nRunLength));
+	}
+
+	return Runs;
+}
+
+bool WorkingSetProvider::Query(HANDLE hProcess, PSAPI_WORKING_SET_EX_INFORMATION* pPages, size_t nPageCount) {
+	assert(pPages != nullptr);
+
+	this->QueryCount++;
+	this->PageCount += nPageCount;
+
+	return K32QueryWorkingSetEx(hProcess, pPages, static_cast<DWORD>(nPageCount * sizeof(PSAPI_WORKING_SET_EX_INFORMATION))) ? true : false;
+}
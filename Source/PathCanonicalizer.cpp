@@ -0,0 +1,148 @@
+/*
+__________________________________________________________________________________________
+| _______  _____  __   _ _______ _______ _______                                         |
+| |  |  | |     | | \  | |______    |    |_____|                                         |
+| |  |  | |_____| |  \_| |______    |    |     |                                         |
+|________________________________________________________________________________________|
+| Moneta ~ Usermode memory scanner & malware hunter                                      |
+|----------------------------------------------------------------------------------------|
+| https://www.forrest-orr.net/post/malicious-memory-artifacts-part-ii-bypassing-scanners |
+|----------------------------------------------------------------------------------------|
+| Author: Forrest Orr - 2020                                                             |
+|----------------------------------------------------------------------------------------|
+| Contact: forrest.orr@protonmail.com                                                    |
+|----------------------------------------------------------------------------------------|
+| Licensed under GNU GPLv3                                                               |
+|________________________________________________________________________________________|
+| ## Features                                                                            |
+|                                                                                        |
+| ~ Query the memory attributes of any accessible process(es).                           |
+| ~ Identify private, mapped and image memory.                                           |
+| ~ Correlate regions of memory to their underlying file on disks.                       |
+| ~ Identify PE headers and sections corresponding to image memory.                      |
+| ~ Identify modified regions of mapped image memory.                                    |
+| ~ Identify abnormal memory attributes indicative of malware.                           |
+| ~ Create memory dumps of user-specified memory ranges                                  |
+| ~ Calculate memory permission/type statistics                                          |
+|________________________________________________________________________________________|
+
+*/
+
+#include "Portable.h"
+#include "PathCanonicalizer.hpp"
+
+using namespace std;
+
+static inline wchar_t FoldCase(wchar_t Char) {
+	return static_cast<wchar_t>(towupper(Char));
+}
+
+PrefixTrie::PrefixTrie() {
+	Node Root = { 0, 0, 0, -1 };
+	this->Nodes.push_back(Root);
+}
+
+void PrefixTrie::Insert(const wstring& Prefix, const wstring& Replacement) {
+	size_t cchPrefix = Prefix.size();
+	uint32_t dwNode = 0;
+
+	while (cchPrefix && Prefix[cchPrefix - 1] == L'\\') { // Matching is done on whole components, so a trailing separator is redundant
+		cchPrefix--;
+	}
+
+	if (!cchPrefix) {
+		return;
+	}
+
+	for (size_t nX = 0; nX < cchPrefix; nX++) {
+		wchar_t Char = FoldCase(Prefix[nX]);
+		uint32_t dwChild;
+
+		for (dwChild = this->Nodes[dwNode].FirstChild; dwChild && this->Nodes[dwChild].Char != Char; dwChild = this->Nodes[dwChild].NextSibling);
+
+		if (!dwChild) {
+			Node NewNode = { Char, 0, this->Nodes[dwNode].FirstChild, -1 };
+
+			dwChild = static_cast<uint32_t>(this->Nodes.size());
+			this->Nodes.push_back(NewNode);
+			this->Nodes[dwNode].FirstChild = dwChild;
+		}
+
+		dwNode = dwChild;
+	}
+
+	if (this->Nodes[dwNode].Replacement == -1) { // The first entry for a prefix is kept, as with the first matching drive letter of GetLogicalDriveStrings
+		this->Nodes[dwNode].Replacement = static_cast<int32_t>(this->Replacements.size());
+		this->Replacements.push_back(Replacement);
+	}
+}
+
+bool PrefixTrie::Rewrite(const wchar_t* Path, wchar_t* OutputPath, size_t ccOutputPath) const {
+	assert(Path != nullptr);
+	assert(OutputPath != nullptr);
+
+	uint32_t dwNode = 0;
+	int32_t nReplacement = -1;
+	size_t cchMatched = 0;
+
+	for (size_t nX = 0; Path[nX]; nX++) {
+		wchar_t Char = FoldCase(Path[nX]);
+		uint32_t dwChild;
+
+		for (dwChild = this->Nodes[dwNode].FirstChild; dwChild && this->Nodes[dwChild].Char != Char; dwChild = this->Nodes[dwChild].NextSibling);
+
+		if (!dwChild) {
+			break;
+		}
+
+		dwNode = dwChild;
+
+		if (this->Nodes[dwNode].Replacement != -1 && (Path[nX + 1] == L'\\' || Path[nX + 1] == 0)) {
+			nReplacement = this->Nodes[dwNode].Replacement;
+			cchMatched = nX + 1;
+		}
+	}
+
+	if (nReplacement != -1) {
+		const wstring& Replacement = this->Replacements[nReplacement];
+		size_t cchRemainder = wcslen(Path + cchMatched);
+
+		if (Replacement.size() + cchRemainder < ccOutputPath) {
+			wmemcpy(OutputPath, Replacement.c_str(), Replacement.size());
+			wmemcpy(OutputPath + Replacement.size(), Path + cchMatched, cchRemainder + 1);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void PathCanonicalizer::AddDevice(const wstring& DevicePrefix, const wstring& DosPrefix) {
+	this->Devices.Insert(DevicePrefix, DosPrefix);
+}
+
+void PathCanonicalizer::AddWow64Redirect(const wstring& NativePrefix, const wstring& Wow64Prefix) {
+	this->Redirects.Insert(NativePrefix, Wow64Prefix);
+}
+
+bool PathCanonicalizer::TranslateDevicePath(const wchar_t* DevicePath, wchar_t* TranslatedPath, size_t ccTranslatedPath) const {
+	return this->Devices.Rewrite(DevicePath, TranslatedPath, ccTranslatedPath);
+}
+
+bool PathCanonicalizer::Wow64Redirect(const wchar_t* TargetFilePath, wchar_t* OutputPath, size_t ccOutputPath) const {
+	assert(TargetFilePath != nullptr);
+
+	if (this->Redirects.Rewrite(TargetFilePath, OutputPath, ccOutputPath)) {
+		return true;
+	}
+	else {
+		size_t cchPath = wcslen(TargetFilePath);
+
+		if (cchPath < ccOutputPath) {
+			wmemcpy(OutputPath, TargetFilePath, cchPath + 1);
+			return true;
+		}
+	}
+
+	return false;
+}
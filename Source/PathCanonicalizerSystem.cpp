@@ -0,0 +1,76 @@
+/*
+__________________________________________________________________________________________
+| _______  _____  __   _ _______ _______ _______                                         |
+| |  |  | |     | | \  | |______    |    |_____|                                         |
+| |  |  | |_____| |  \_| |______    |    |     |                                         |
+|________________________________________________________________________________________|
+| Moneta ~ Usermode memory scanner & malware hunter                                      |
+|----------------------------------------------------------------------------------------|
+| https://www.forrest-orr.net/post/malicious-memory-artifacts-part-ii-bypassing-scanners |
+|----------------------------------------------------------------------------------------|
+| Author: Forrest Orr - 2020                                                             |
+|----------------------------------------------------------------------------------------|
+| Contact: forrest.orr@protonmail.com                                                    |
+|----------------------------------------------------------------------------------------|
+| Licensed under GNU GPLv3                                                               |
+|________________________________________________________________________________________|
+| ## Features                                                                            |
+|                                                                                        |
+| ~ Query the memory attributes of any accessible process(es).                           |
+| ~ Identify private, mapped and image memory.                                           |
+| ~ Correlate regions of memory to their underlying file on disks.                       |
+| ~ Identify PE headers and sections corresponding to image memory.                      |
+| ~ Identify modified regions of mapped image memory.                                    |
+| ~ Identify abnormal memory attributes indicative of malware.                           |
+| ~ Create memory dumps of user-specified memory ranges                                  |
+| ~ Calculate memory permission/type statistics                                          |
+|________________________________________________________________________________________|
+
+*/
+
+#include "StdAfx.h"
+#include "PathCanonicalizer.hpp"
+
+using namespace std;
+
+const PathCanonicalizer& PathCanonicalizer::GetSystem() {
+	static PathCanonicalizer SystemPaths;
+	static once_flag Built;
+
+	call_once(Built, []() {
+		wchar_t DriveLetters[MAX_PATH + 1] = { 0 };
+		wchar_t SystemDirectory[MAX_PATH + 1] = { 0 }, SysWow64Directory[MAX_PATH + 1] = { 0 }, ProgFilePath64[MAX_PATH + 1] = { 0 }, ProgFilePathWow64[MAX_PATH + 1] = { 0 };
+		uint32_t dwProgFilePath64Length, dwProgFilePathWow64Length;
+		SYSTEM_INFO SystemInfo = { 0 };
+
+		if (GetLogicalDriveStringsW(MAX_PATH + 1, DriveLetters)) {
+			for (const wchar_t* p = DriveLetters; *p; p += wcslen(p) + 1) {
+				wchar_t DosPath[MAX_PATH + 1] = { 0 };
+				wchar_t DrivePrefix[3] = L" :";
+
+				*DrivePrefix = *p;
+
+				if (QueryDosDeviceW(DrivePrefix, DosPath, MAX_PATH + 1)) { // Only the first (current) target of the device link is used
+					SystemPaths.AddDevice(DosPath, DrivePrefix);
+				}
+			}
+		}
+
+		GetNativeSystemInfo(&SystemInfo); // Native version of this call works on both Wow64 and x64 as opposed to just x64 for GetSystemInfo. Works on XP+
+
+		if (SystemInfo.wProcessorArchitecture == PROCESSOR_ARCHITECTURE_AMD64) { // Resolve the 32 and 64-bit versions of the most problematic paths (Program Files, System32)
+			if (GetSystemWow64DirectoryW(SysWow64Directory, MAX_PATH + 1) && GetSystemDirectoryW(SystemDirectory, MAX_PATH + 1)) {
+				SystemPaths.AddWow64Redirect(SystemDirectory, SysWow64Directory);
+
+				dwProgFilePath64Length = GetEnvironmentVariableW(L"ProgramW6432", ProgFilePath64, MAX_PATH + 1);
+				dwProgFilePathWow64Length = GetEnvironmentVariableW(L"ProgramFiles(x86)", ProgFilePathWow64, MAX_PATH + 1);
+
+				if (dwProgFilePath64Length && dwProgFilePath64Length <= MAX_PATH && dwProgFilePathWow64Length && dwProgFilePathWow64Length <= MAX_PATH) { // A result larger than the buffer is the size required rather than the length copied
+					SystemPaths.AddWow64Redirect(ProgFilePath64, ProgFilePathWow64);
+				}
+			}
+		}
+	});
+
+	return SystemPaths;
+}
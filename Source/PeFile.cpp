@@ -35,34 +35,45 @@ ________________________________________________________________________________
 
 using namespace std;
 
-PeFile::PeFile(const uint8_t* pPeBuf, uint32_t dwPeFileSize) : Data(new uint8_t[dwPeFileSize]), Size(dwPeFileSize) {
-	assert(pPeBuf != nullptr);
+PeFile::PeFile(unique_ptr<uint8_t[]> PeBuf, uint32_t dwPeFileSize) : SectHdrs(nullptr), Data(PeBuf.release()), Size(dwPeFileSize) {
+	assert(this->Data != nullptr);
 	assert(dwPeFileSize);
 
-	memcpy(this->Data, pPeBuf, dwPeFileSize);
 	this->DosHdr = reinterpret_cast<IMAGE_DOS_HEADER*>(this->Data);
 	this->FileHdr = reinterpret_cast<IMAGE_FILE_HEADER*>((reinterpret_cast<uint8_t *>(this->DosHdr) + this->DosHdr->e_lfanew + sizeof(LONG)));
 }
 
 PeFile::~PeFile() {
-	delete this->Data;
+	delete[] this->Data;
 }
 
 PeFile* PeFile::Load(const uint8_t* pPeBuf, uint32_t dwPeFileSize) {
 	assert(pPeBuf != nullptr);
 	assert(dwPeFileSize);
 
+	unique_ptr<uint8_t[]> PeBuf = make_unique<uint8_t[]>(dwPeFileSize);
+
+	memcpy(PeBuf.get(), pPeBuf, dwPeFileSize);
+	return PeFile::Load(move(PeBuf), dwPeFileSize);
+}
+
+PeFile* PeFile::Load(unique_ptr<uint8_t[]> PeBuf, uint32_t dwPeFileSize) {
 	PeFile* NewPe = nullptr;
 
-	if (*(uint16_t*)&pPeBuf[0] == 'ZM') {
-		PIMAGE_DOS_HEADER pDosHdr = reinterpret_cast<IMAGE_DOS_HEADER*>(const_cast<uint8_t *>(pPeBuf));
-		IMAGE_FILE_HEADER* pFileHdr = reinterpret_cast<IMAGE_FILE_HEADER*>((const_cast<uint8_t *>(pPeBuf) + pDosHdr->e_lfanew + sizeof(LONG)));
+	if (dwPeFileSize >= sizeof(IMAGE_DOS_HEADER) && *(uint16_t*)&PeBuf[0] == 'ZM') {
+		PIMAGE_DOS_HEADER pDosHdr = reinterpret_cast<IMAGE_DOS_HEADER*>(PeBuf.get());
+
+		if (dwPeFileSize < sizeof(IMAGE_DOS_HEADER) + sizeof(IMAGE_NT_HEADERS64) || pDosHdr->e_lfanew < 0 || static_cast<uint32_t>(pDosHdr->e_lfanew) > dwPeFileSize - sizeof(IMAGE_NT_HEADERS64)) { // Validation of the NT headers relies on them being within the buffer
+			return nullptr;
+		}
+
+		IMAGE_FILE_HEADER* pFileHdr = reinterpret_cast<IMAGE_FILE_HEADER*>((PeBuf.get() + pDosHdr->e_lfanew + sizeof(LONG)));
 
 		if (pFileHdr->Machine == IMAGE_FILE_MACHINE_I386) {
-			NewPe = new PeArch32(pPeBuf, dwPeFileSize);
+			NewPe = new PeArch32(move(PeBuf), dwPeFileSize);
 		}
 		else if (pFileHdr->Machine == IMAGE_FILE_MACHINE_AMD64) {
-			NewPe = new PeArch64(pPeBuf, dwPeFileSize);
+			NewPe = new PeArch64(move(PeBuf), dwPeFileSize);
 		}
 
 		if (NewPe != nullptr) {
@@ -108,12 +119,12 @@ PeFile* PeFile::Load(const wstring PeFilePath) {
 				}
 
 				if (dwHdrSize) {
-					uint8_t* HdrData = new uint8_t[dwHdrSize];
+					unique_ptr<uint8_t[]> HdrData = make_unique<uint8_t[]>(dwHdrSize);
 
 					SetFilePointer(hFile, 0, nullptr, FILE_BEGIN);
 
-					if (ReadFile(hFile, HdrData, dwHdrSize, reinterpret_cast<PDWORD>(&dwBytesRead), 0)) {
-						NewPe = PeFile::Load(HdrData, dwHdrSize);
+					if (ReadFile(hFile, HdrData.get(), dwHdrSize, reinterpret_cast<PDWORD>(&dwBytesRead), 0) && dwBytesRead == dwHdrSize) {
+						NewPe = PeFile::Load(move(HdrData), dwHdrSize); // The headers are read into the buffer the PE object keeps
 					}
 				}
 			}
@@ -125,26 +136,23 @@ PeFile* PeFile::Load(const wstring PeFilePath) {
 	return NewPe;
 }
 
-bool PeFile::IsExe() {
+bool PeFile::IsExe() const {
 	return !(this->GetFileHdr()->Characteristics & IMAGE_FILE_DLL); // IMAGE_FILE_EXECUTABLE_IMAGE appears on DLLs as well
 }
 
-bool PeFile::IsDll() {
+bool PeFile::IsDll() const {
 	return (this->GetFileHdr()->Characteristics & IMAGE_FILE_DLL);
 }
 
-template<typename NtHdrType> PeArch<NtHdrType>::PeArch(const uint8_t* pPeBuf, uint32_t dwPeFileSize) : PeFile(pPeBuf, dwPeFileSize) {}
+template<typename NtHdrType> PeArch<NtHdrType>::PeArch(unique_ptr<uint8_t[]> PeBuf, uint32_t dwPeFileSize) : PeFile(move(PeBuf), dwPeFileSize) {}
 
-template<typename NtHdrType> NtHdrType* PeArch<NtHdrType>::GetNtHdrs() {
+template<typename NtHdrType> NtHdrType* PeArch<NtHdrType>::GetNtHdrs() const { // Has no side effects, since a loaded PE may be shared between threads
 	assert(this->DosHdr != nullptr);
 	NtHdrType* pNtHdr = (NtHdrType*)(reinterpret_cast<uint8_t *>(this->DosHdr) + this->DosHdr->e_lfanew);
 
 	if (pNtHdr->Signature == 'EP') {
 		if (pNtHdr->FileHeader.Machine == GetPeFileArch()) {
 			if (pNtHdr->OptionalHeader.Magic == GetPeFileMagic()) {
-				this->SectHdrs = reinterpret_cast<IMAGE_SECTION_HEADER *>(
-					reinterpret_cast<uint8_t *>(pNtHdr) + sizeof(NtHdrType)
-					);
 				return pNtHdr;
 			}
 		}
@@ -153,11 +161,22 @@ template<typename NtHdrType> NtHdrType* PeArch<NtHdrType>::GetNtHdrs() {
 	return nullptr;
 }
 
-template<typename NtHdrType> bool PeArch<NtHdrType>::Validate() {
-	return GetNtHdrs();
+template<typename NtHdrType> bool PeArch<NtHdrType>::Validate() { // Called once by the factory, before the PE is visible to anything else
+	NtHdrType* pNtHdr = GetNtHdrs();
+
+	if (pNtHdr != nullptr) {
+		uint8_t* pSectHdrs = reinterpret_cast<uint8_t *>(pNtHdr) + sizeof(NtHdrType);
+
+		if (pSectHdrs + (pNtHdr->FileHeader.NumberOfSections * sizeof(IMAGE_SECTION_HEADER)) <= this->Data + this->Size) {
+			this->SectHdrs = reinterpret_cast<IMAGE_SECTION_HEADER *>(pSectHdrs);
+			return true;
+		}
+	}
+
+	return false;
 }
 
-template<typename NtHdrType> void* PeArch<NtHdrType>::GetImageBase() {
+template<typename NtHdrType> void* PeArch<NtHdrType>::GetImageBase() const {
 	return (void*)GetNtHdrs()->OptionalHeader.ImageBase;
 }
 
@@ -165,7 +184,7 @@ template<typename NtHdrType> void PeArch<NtHdrType>::SetImageBase(const void* pN
 	GetNtHdrs()->OptionalHeader.ImageBase = (decltype(GetNtHdrs()->OptionalHeader.ImageBase))pNewImageBase;
 }
 
-template<typename NtHdrType> bool PeArch<NtHdrType>::GetDataDir(int8_t nIndex, uint32_t* pdwRva, uint32_t* pdwSize) {
+template<typename NtHdrType> bool PeArch<NtHdrType>::GetDataDir(int8_t nIndex, uint32_t* pdwRva, uint32_t* pdwSize) const {
 	if (GetNtHdrs()->OptionalHeader.DataDirectory[nIndex].VirtualAddress) {
 		if (pdwRva != nullptr) *pdwRva = GetNtHdrs()->OptionalHeader.DataDirectory[nIndex].VirtualAddress;
 		if (pdwSize != nullptr) *pdwSize = GetNtHdrs()->OptionalHeader.DataDirectory[nIndex].Size;
@@ -196,7 +215,7 @@ template<typename NtHdrType> uint32_t PeArch<NtHdrType>::RefreshCrc32() {
 	return dwNewCRC32;
 }
 
-template<typename NtHdrType> uint32_t PeArch<NtHdrType>::GetSubsystem() {
+template<typename NtHdrType> uint32_t PeArch<NtHdrType>::GetSubsystem() const {
 	return GetNtHdrs()->OptionalHeader.Subsystem;
 }
 
@@ -204,7 +223,7 @@ template<typename NtHdrType> void PeArch<NtHdrType>::SetSubsystem(uint32_t dwSub
 	GetNtHdrs()->OptionalHeader.Subsystem = dwSubsystem;
 }
 
-template<typename NtHdrType> uint16_t PeArch<NtHdrType>::GetDllCharacteristics() {
+template<typename NtHdrType> uint16_t PeArch<NtHdrType>::GetDllCharacteristics() const {
 	return GetNtHdrs()->OptionalHeader.DllCharacteristics;
 }
 
@@ -212,17 +231,17 @@ template<typename NtHdrType> void PeArch<NtHdrType>::SetDllCharacteristics(uint1
 	GetNtHdrs()->OptionalHeader.DllCharacteristics = wDllCharacteristics;
 }
 
-template<typename NtHdrType> uint32_t PeArch<NtHdrType>::GetImageSize() {
+template<typename NtHdrType> uint32_t PeArch<NtHdrType>::GetImageSize() const {
 	return GetNtHdrs()->OptionalHeader.SizeOfImage;
 }
 
-template<typename NtHdrType> uint8_t* PeArch<NtHdrType>::GetEntryPoint() {
+template<typename NtHdrType> uint8_t* PeArch<NtHdrType>::GetEntryPoint() const {
 	return reinterpret_cast<uint8_t *>(GetNtHdrs()->OptionalHeader.AddressOfEntryPoint);
 }
 
-template<typename NtHdrType> bool PeArch<NtHdrType>::IsDotNet() {
+template<typename NtHdrType> bool PeArch<NtHdrType>::IsDotNet() const {
 	return GetDataDir(IMAGE_DIRECTORY_ENTRY_COM_DESCRIPTOR, nullptr, nullptr);
 }
 
-PeArch32::PeArch32(const uint8_t* pPeBuf, uint32_t dwPeFileSize) : PeArch<IMAGE_NT_HEADERS32>(pPeBuf, dwPeFileSize) {}
-PeArch64::PeArch64(const uint8_t* pPeBuf, uint32_t dwPeFileSize) : PeArch<IMAGE_NT_HEADERS64>(pPeBuf, dwPeFileSize) {}
+PeArch32::PeArch32(unique_ptr<uint8_t[]> PeBuf, uint32_t dwPeFileSize) : PeArch<IMAGE_NT_HEADERS32>(move(PeBuf), dwPeFileSize) {}
+PeArch64::PeArch64(unique_ptr<uint8_t[]> PeBuf, uint32_t dwPeFileSize) : PeArch<IMAGE_NT_HEADERS64>(move(PeBuf), dwPeFileSize) {}
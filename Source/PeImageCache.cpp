@@ -0,0 +1,117 @@
+/*
+__________________________________________________________________________________________
+| _______  _____  __   _ _______ _______ _______                                         |
+| |  |  | |     | | \  | |______    |    |_____|                                         |
+| |  |  | |_____| |  \_| |______    |    |     |                                         |
+|________________________________________________________________________________________|
+| Moneta ~ Usermode memory scanner & malware hunter                                      |
+|----------------------------------------------------------------------------------------|
+| https://www.forrest-orr.net/post/malicious-memory-artifacts-part-ii-bypassing-scanners |
+|----------------------------------------------------------------------------------------|
+| Author: Forrest Orr - 2020                                                             |
+|----------------------------------------------------------------------------------------|
+| Contact: forrest.orr@protonmail.com                                                    |
+|----------------------------------------------------------------------------------------|
+| Licensed under GNU GPLv3                                                               |
+|________________________________________________________________________________________|
+| ## Features                                                                            |
+|                                                                                        |
+| ~ Query the memory attributes of any accessible process(es).                           |
+| ~ Identify private, mapped and image memory.                                           |
+| ~ Correlate regions of memory to their underlying file on disks.                       |
+| ~ Identify PE headers and sections corresponding to image memory.                      |
+| ~ Identify modified regions of mapped image memory.                                    |
+| ~ Identify abnormal memory attributes indicative of malware.                           |
+| ~ Create memory dumps of user-specified memory ranges                                  |
+| ~ Calculate memory permission/type statistics                                          |
+|________________________________________________________________________________________|
+
+*/
+
+#include "StdAfx.h"
+#include "PeFile.hpp"
+#include "Signing.h"
+#include "PeImageCache.hpp"
+
+using namespace std;
+
+map<FileIdentity, shared_future<shared_ptr<const PeImage>>> PeImageCache::Images;
+mutex PeImageCache::Lock;
+atomic<uint64_t> PeImageCache::HitCount(0);
+atomic<uint64_t> PeImageCache::MissCount(0);
+
+PeImage::PeImage(unique_ptr<PeFile> Pe) : Pe(move(Pe)) {
+	for (int32_t nX = -1; nX < this->Pe->GetFileHdr()->NumberOfSections; nX++) {
+		SectionExtent Extent = { 0 }; // This will initialize other relevant fields such as VirtualAddress to 0 for the PE header edge case.
+
+		if (nX == -1) {
+			strcpy_s(reinterpret_cast<char*>(Extent.Hdr.Name), sizeof(Extent.Hdr.Name), "Header");
+			Extent.Hdr.SizeOfRawData = this->Pe->GetFileHdr()->NumberOfSections ? this->Pe->GetSectHdrs()->VirtualAddress : 0; // Consider the size of the PE headers to be all data leading up to the start of the first real section.
+		}
+		else {
+			memcpy(&Extent.Hdr, (this->Pe->GetSectHdrs() + nX), sizeof(IMAGE_SECTION_HEADER));
+		}
+
+		Extent.Size = (Extent.Hdr.SizeOfRawData < Extent.Hdr.Misc.VirtualSize ? Extent.Hdr.Misc.VirtualSize : Extent.Hdr.SizeOfRawData); // .data sections will sometimes have a non-zero raw data where the virtual size is still larger than the raw size (copy-on-write)
+		this->Sections.push_back(Extent);
+		this->RvaOrder.push_back(this->RvaOrder.size());
+	}
+
+	stable_sort(this->RvaOrder.begin(), this->RvaOrder.end(), [this](size_t nLeft, size_t nRight) { return this->Sections[nLeft].Hdr.VirtualAddress < this->Sections[nRight].Hdr.VirtualAddress; });
+}
+
+shared_ptr<const PeImage> PeImageCache::Parse(const wchar_t* FilePath) {
+	unique_ptr<PeFile> Pe(PeFile::Load(FilePath));
+
+	if (Pe != nullptr) {
+		return make_shared<const PeImage>(move(Pe));
+	}
+
+	return nullptr;
+}
+
+shared_ptr<const PeImage> PeImageCache::Load(const wchar_t* FilePath) {
+	FileIdentity Identity = { 0 };
+	promise<shared_ptr<const PeImage>> Parsing;
+
+	if (!FileIdentity::Query(FilePath, Identity)) { // Without an identity the image cannot safely be shared
+		MissCount++;
+		return Parse(FilePath);
+	}
+
+	unique_lock<mutex> Guard(PeImageCache::Lock);
+	map<FileIdentity, shared_future<shared_ptr<const PeImage>>>::const_iterator ImageItr = Images.find(Identity);
+
+	if (ImageItr != Images.end()) {
+		shared_future<shared_ptr<const PeImage>> Image = ImageItr->second;
+
+		Guard.unlock();
+		HitCount++;
+		return Image.get(); // Waits if the file is still being parsed by another thread
+	}
+
+	Images.insert(make_pair(Identity, Parsing.get_future().share()));
+	Guard.unlock();
+	MissCount++;
+
+	shared_ptr<const PeImage> Image;
+
+	try {
+		Image = Parse(FilePath);
+	}
+	catch (...) { // The threads waiting on this parse receive the same exception rather than a broken promise, and the entry is dropped so that later loads retry
+		Guard.lock();
+		Images.erase(Identity);
+		Guard.unlock();
+		Parsing.set_exception(current_exception());
+		throw;
+	}
+
+	Parsing.set_value(Image);
+	return Image;
+}
+
+void PeImageCache::Clear() { // Entities which still reference an image keep it alive
+	lock_guard<mutex> Guard(PeImageCache::Lock);
+	Images.clear();
+}
@@ -0,0 +1,333 @@
+/*
+__________________________________________________________________________________________
+| _______  _____  __   _ _______ _______ _______                                         |
+| |  |  | |     | | \  | |______    |    |_____|                                         |
+| |  |  | |_____| |  \_| |______    |    |     |                                         |
+|________________________________________________________________________________________|
+| Moneta ~ Usermode memory scanner & malware hunter                                      |
+|----------------------------------------------------------------------------------------|
+| https://www.forrest-orr.net/post/malicious-memory-artifacts-part-ii-bypassing-scanners |
+|----------------------------------------------------------------------------------------|
+| Author: Forrest Orr - 2020                                                             |
+|----------------------------------------------------------------------------------------|
+| Contact: forrest.orr@protonmail.com                                                    |
+|----------------------------------------------------------------------------------------|
+| Licensed under GNU GPLv3                                                               |
+|________________________________________________________________________________________|
+| ## Features                                                                            |
+|                                                                                        |
+| ~ Query the memory attributes of any accessible process(es).                           |
+| ~ Identify private, mapped and image memory.                                           |
+| ~ Correlate regions of memory to their underlying file on disks.                       |
+| ~ Identify PE headers and sections corresponding to image memory.                      |
+| ~ Identify modified regions of mapped image memory.                                    |
+| ~ Identify abnormal memory attributes indicative of malware.                           |
+| ~ Create memory dumps of user-specified memory ranges                                  |
+| ~ Calculate memory permission/type statistics                                          |
+|________________________________________________________________________________________|
+
+*/
+
+#include "StdAfx.h"
+#include "PointerScan.hpp"
+
+using namespace std;
+
+// Every kernel tests a value V against the range [Low, Low + Span) as the single unsigned comparison (V - Low) < Span. The vectorized kernels only identify blocks
+// of offsets which contain at least one hit: each such block is then re-scanned by the scalar kernel, which keeps the offsets in ascending order and the
+// (rare) hit path simple.
+
+template<typename Address_t> static size_t ScanScalar(const uint8_t* pBuf, size_t nFirstOffset, size_t nEndOffset, Address_t Low, Address_t Span, size_t nStride, vector<uint32_t>& Offsets, size_t nMaxHits) {
+	size_t nHitCount = 0;
+
+	for (size_t nOffset = nFirstOffset; nOffset < nEndOffset; nOffset += nStride) {
+		Address_t PotentialAddress;
+
+		memcpy(&PotentialAddress, pBuf + nOffset, sizeof(Address_t)); // The buffer may be read at any byte offset
+
+		if (static_cast<Address_t>(PotentialAddress - Low) < Span) {
+			Offsets.push_back(static_cast<uint32_t>(nOffset));
+			nHitCount++;
+
+			if (nMaxHits && nHitCount >= nMaxHits) {
+				break;
+			}
+		}
+	}
+
+	return nHitCount;
+}
+
+static inline int32_t MatchSse2(__m128i Values, __m128i High, __m128i Low, __m128i BiasedSpan, uint32_t dwPointerSize) { // Returns a byte mask of the lanes of the register which are within the range
+	__m128i Below = _mm_cmpgt_epi32(BiasedSpan, _mm_xor_si128(_mm_sub_epi32(Values, Low), _mm_set1_epi32(INT32_MIN))); // SSE2 only has signed compares: biasing both sides by the sign bit turns them into unsigned compares
+
+	if (dwPointerSize == 8) { // There is no 64-bit compare in SSE2: a quadword is in a range which does not cross a 4GB boundary when its high dword matches and its low dword is in range
+		Below = _mm_and_si128(_mm_cmpeq_epi32(Values, High), _mm_slli_epi64(Below, 32));
+	}
+
+	return _mm_movemask_epi8(Below);
+}
+
+template<typename Address_t> static size_t ScanSse2(const uint8_t* pBuf, size_t cbBuf, Address_t Low, Address_t Span, bool bAligned, vector<uint32_t>& Offsets, size_t nMaxHits) {
+	const uint32_t dwPointerSize = sizeof(Address_t);
+	const size_t nStride = bAligned ? dwPointerSize : 1;
+	const size_t nPhaseCount = bAligned ? 1 : dwPointerSize; // Unaligned scans load the block once per byte phase so that every offset within it lands in some lane
+	__m128i VecHigh = _mm_set1_epi32(static_cast<int32_t>(static_cast<uint64_t>(Low) >> 32));
+	__m128i VecLow = _mm_set1_epi32(static_cast<int32_t>(Low));
+	__m128i VecSpan = _mm_set1_epi32(static_cast<int32_t>(static_cast<uint32_t>(Span) ^ 0x80000000));
+	size_t nHitCount = 0, nOffset = 0;
+
+	if (dwPointerSize == 8 && (static_cast<uint64_t>(Span) > 0xFFFFFFFF || (static_cast<uint64_t>(Low) >> 32) != (static_cast<uint64_t>(Low + Span - 1) >> 32))) { // The span must also fit the low dword compare: a 4GB range aligned on a 4GB boundary does not cross one but truncates to a span of 0
+		return ScanScalar<Address_t>(pBuf, 0, cbBuf >= dwPointerSize ? cbBuf - dwPointerSize + 1 : 0, Low, Span, nStride, Offsets, nMaxHits);
+	}
+
+	for (; nOffset + 16 + nPhaseCount - 1 <= cbBuf; nOffset += 16) {
+		int32_t nMask = 0;
+
+		for (size_t nPhase = 0; nPhase < nPhaseCount; nPhase++) {
+			nMask |= MatchSse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pBuf + nOffset + nPhase)), VecHigh, VecLow, VecSpan, dwPointerSize);
+		}
+
+		if (nMask) {
+			nHitCount += ScanScalar<Address_t>(pBuf, nOffset, nOffset + 16, Low, Span, nStride, Offsets, nMaxHits ? nMaxHits - nHitCount : 0);
+
+			if (nMaxHits && nHitCount >= nMaxHits) {
+				return nHitCount;
+			}
+		}
+	}
+
+	if (cbBuf >= dwPointerSize && nOffset <= cbBuf - dwPointerSize) {
+		nHitCount += ScanScalar<Address_t>(pBuf, nOffset, cbBuf - dwPointerSize + 1, Low, Span, nStride, Offsets, nMaxHits ? nMaxHits - nHitCount : 0);
+	}
+
+	return nHitCount;
+}
+
+static inline int32_t MatchAvx2(__m256i Values, __m256i Low, __m256i BiasedSpan, uint32_t dwPointerSize) {
+	if (dwPointerSize == 8) {
+		__m256i Delta = _mm256_xor_si256(_mm256_sub_epi64(Values, Low), _mm256_set1_epi64x(INT64_MIN));
+		return _mm256_movemask_epi8(_mm256_cmpgt_epi64(BiasedSpan, Delta));
+	}
+	else {
+		__m256i Delta = _mm256_xor_si256(_mm256_sub_epi32(Values, Low), _mm256_set1_epi32(INT32_MIN));
+		return _mm256_movemask_epi8(_mm256_cmpgt_epi32(BiasedSpan, Delta));
+	}
+}
+
+template<typename Address_t> static size_t ScanAvx2(const uint8_t* pBuf, size_t cbBuf, Address_t Low, Address_t Span, bool bAligned, vector<uint32_t>& Offsets, size_t nMaxHits) {
+	const uint32_t dwPointerSize = sizeof(Address_t);
+	const size_t nStride = bAligned ? dwPointerSize : 1;
+	const size_t nPhaseCount = bAligned ? 1 : dwPointerSize;
+	__m256i VecLow, VecSpan;
+	size_t nHitCount = 0, nOffset = 0;
+
+	if (dwPointerSize == 8) {
+		VecLow = _mm256_set1_epi64x(static_cast<int64_t>(Low));
+		VecSpan = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<int64_t>(Span)), _mm256_set1_epi64x(INT64_MIN));
+	}
+	else {
+		VecLow = _mm256_set1_epi32(static_cast<int32_t>(Low));
+		VecSpan = _mm256_xor_si256(_mm256_set1_epi32(static_cast<int32_t>(Span)), _mm256_set1_epi32(INT32_MIN));
+	}
+
+	for (; nOffset + 32 + nPhaseCount - 1 <= cbBuf; nOffset += 32) {
+		int32_t nMask = 0;
+
+		for (size_t nPhase = 0; nPhase < nPhaseCount; nPhase++) {
+			nMask |= MatchAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(pBuf + nOffset + nPhase)), VecLow, VecSpan, dwPointerSize);
+		}
+
+		if (nMask) {
+			nHitCount += ScanScalar<Address_t>(pBuf, nOffset, nOffset + 32, Low, Span, nStride, Offsets, nMaxHits ? nMaxHits - nHitCount : 0);
+
+			if (nMaxHits && nHitCount >= nMaxHits) {
+				return nHitCount;
+			}
+		}
+	}
+
+	_mm256_zeroupper();
+
+	if (cbBuf >= dwPointerSize && nOffset <= cbBuf - dwPointerSize) {
+		nHitCount += ScanScalar<Address_t>(pBuf, nOffset, cbBuf - dwPointerSize + 1, Low, Span, nStride, Offsets, nMaxHits ? nMaxHits - nHitCount : 0);
+	}
+
+	return nHitCount;
+}
+
+template<typename Address_t> static size_t Scan(PointerScan::Isa_t Isa, const uint8_t* pBuf, size_t cbBuf, uint64_t qwLow, uint64_t qwSpan, bool bAligned, vector<uint32_t>& Offsets, size_t nMaxHits) {
+	Address_t Low = static_cast<Address_t>(qwLow), Span = static_cast<Address_t>(qwSpan);
+
+	switch (Isa) {
+		case PointerScan::Isa_t::Avx2: return ScanAvx2<Address_t>(pBuf, cbBuf, Low, Span, bAligned, Offsets, nMaxHits);
+		case PointerScan::Isa_t::Sse2: return ScanSse2<Address_t>(pBuf, cbBuf, Low, Span, bAligned, Offsets, nMaxHits);
+		default: return (cbBuf >= sizeof(Address_t) ? ScanScalar<Address_t>(pBuf, 0, cbBuf - sizeof(Address_t) + 1, Low, Span, bAligned ? sizeof(Address_t) : 1, Offsets, nMaxHits) : 0);
+	}
+}
+
+PointerScan::Isa_t PointerScan::SelectedIsa = PointerScan::DetectIsa();
+
+PointerScan::Isa_t PointerScan::DetectIsa() {
+	int32_t CpuInfo[4] = { 0 };
+
+	__cpuid(CpuInfo, 0);
+
+	if (CpuInfo[0] >= 7) {
+		int32_t ExtendedInfo[4] = { 0 };
+
+		__cpuid(CpuInfo, 1);
+		__cpuidex(ExtendedInfo, 7, 0);
+
+		if ((CpuInfo[2] & (1 << 27)) && (CpuInfo[2] & (1 << 28)) && (ExtendedInfo[1] & (1 << 5))) { // OSXSAVE, AVX and AVX2: the OS must also be saving the YMM state on context switches
+			if ((_xgetbv(0) & 6) == 6) {
+				return Isa_t::Avx2;
+			}
+		}
+	}
+	else {
+		__cpuid(CpuInfo, 1);
+	}
+
+	return ((CpuInfo[3] & (1 << 26)) ? Isa_t::Sse2 : Isa_t::Scalar);
+}
+
+PointerScan::Isa_t PointerScan::GetIsa() {
+	return SelectedIsa;
+}
+
+void PointerScan::SetIsa(Isa_t Isa) {
+	if (Isa == Isa_t::Avx2 && DetectIsa() != Isa_t::Avx2) {
+		Isa = DetectIsa(); // Never select an instruction set the CPU lacks
+	}
+
+	SelectedIsa = Isa;
+}
+
+const wchar_t* PointerScan::IsaSymbol(Isa_t Isa) {
+	switch (Isa) {
+		case Isa_t::Avx2: return L"AVX2";
+		case Isa_t::Sse2: return L"SSE2";
+		default: return L"Scalar";
+	}
+}
+
+PointerScan::PointerScan(uint32_t dwPointerSize, bool bAligned) : PointerSize(dwPointerSize), Aligned(bAligned) {
+	assert(dwPointerSize == 4 || dwPointerSize == 8);
+}
+
+size_t PointerScan::Find(const uint8_t* pBuf, size_t cbBuf, const uint8_t* pRangeStart, uint32_t dwRangeSize, vector<uint32_t>& Offsets, size_t nMaxHits) const {
+	assert(pBuf != nullptr);
+
+	uint64_t qwSpan = (dwRangeSize ? dwRangeSize : 1); // An exact match is a range of one address
+
+	if (this->PointerSize == 4) {
+		return Scan<uint32_t>(SelectedIsa, pBuf, cbBuf, reinterpret_cast<uintptr_t>(pRangeStart), qwSpan, this->Aligned, Offsets, nMaxHits);
+	}
+	else {
+		return Scan<uint64_t>(SelectedIsa, pBuf, cbBuf, reinterpret_cast<uintptr_t>(pRangeStart), qwSpan, this->Aligned, Offsets, nMaxHits);
+	}
+}
+
+template<typename Size_t> void PointerScan::SetTargets(const vector<pair<const uint8_t*, Size_t>>& Targets) {
+	this->Targets.clear();
+
+	for (size_t nX = 0; nX < Targets.size(); nX++) {
+		Target NewTarget;
+
+		NewTarget.Start = reinterpret_cast<uintptr_t>(Targets[nX].first);
+		NewTarget.End = NewTarget.Start + (Targets[nX].second ? static_cast<uint64_t>(Targets[nX].second) : 1);
+		NewTarget.Index = nX;
+		this->Targets.push_back(NewTarget);
+	}
+
+	stable_sort(this->Targets.begin(), this->Targets.end(), [](const Target& Left, const Target& Right) { return Left.Start < Right.Start; });
+
+	for (size_t nX = 0; nX < this->Targets.size(); nX++) {
+		this->Targets[nX].MaxEnd = (nX && this->Targets[nX - 1].MaxEnd > this->Targets[nX].End) ? this->Targets[nX - 1].MaxEnd : this->Targets[nX].End;
+	}
+
+	// The clusters are cut at the widest gaps left between the targets once overlapping targets are merged, which minimizes the address space they cover for
+	// their count. Gaps narrower than the minimum are never cut, since a false candidate costs less than another pass of the kernel.
+
+	vector<pair<uint64_t, size_t>> Gaps; // Width of each gap, and the position of the target following it
+
+	this->Clusters.clear();
+
+	for (size_t nX = 1; nX < this->Targets.size(); nX++) {
+		if (this->Targets[nX].Start > this->Targets[nX - 1].MaxEnd && this->Targets[nX].Start - this->Targets[nX - 1].MaxEnd >= MinClusterGap) {
+			Gaps.push_back(make_pair(this->Targets[nX].Start - this->Targets[nX - 1].MaxEnd, nX));
+		}
+	}
+
+	if (Gaps.size() >= MaxClusters) {
+		nth_element(Gaps.begin(), Gaps.begin() + (MaxClusters - 1), Gaps.end(), [](const pair<uint64_t, size_t>& Left, const pair<uint64_t, size_t>& Right) { return Left.first > Right.first; });
+		Gaps.resize(MaxClusters - 1);
+	}
+
+	sort(Gaps.begin(), Gaps.end(), [](const pair<uint64_t, size_t>& Left, const pair<uint64_t, size_t>& Right) { return Left.second < Right.second; });
+
+	for (size_t nX = 0, nFirst = 0; nFirst < this->Targets.size(); nX++) {
+		size_t nEnd = (nX < Gaps.size() ? Gaps[nX].second : this->Targets.size());
+		Cluster NewCluster = { this->Targets[nFirst].Start, this->Targets[nEnd - 1].MaxEnd - this->Targets[nFirst].Start };
+
+		this->Clusters.push_back(NewCluster);
+		nFirst = nEnd;
+	}
+}
+
+template void PointerScan::SetTargets<uint32_t>(const vector<pair<const uint8_t*, uint32_t>>& Targets);
+template void PointerScan::SetTargets<uint64_t>(const vector<pair<const uint8_t*, uint64_t>>& Targets);
+
+size_t PointerScan::FindTargets(const uint8_t* pBuf, size_t cbBuf, vector<pair<uint32_t, size_t>>& Hits) const {
+	assert(pBuf != nullptr);
+
+	if (this->Targets.empty()) {
+		return 0;
+	}
+
+	// The buffer is scanned once for the range of each cluster of targets. Each candidate is then resolved against the sorted targets: only those which start at
+	// or before the value, and whose preceding targets have not all ended before it, need to be tested.
+
+	vector<uint32_t> Candidates;
+	size_t nHitCount = 0;
+
+	for (vector<Cluster>::const_iterator ClusterItr = this->Clusters.begin(); ClusterItr != this->Clusters.end(); ++ClusterItr) {
+		if (this->PointerSize == 4) {
+			Scan<uint32_t>(SelectedIsa, pBuf, cbBuf, ClusterItr->Low, (ClusterItr->Span > UINT32_MAX ? UINT32_MAX : ClusterItr->Span), this->Aligned, Candidates, 0);
+		}
+		else {
+			Scan<uint64_t>(SelectedIsa, pBuf, cbBuf, ClusterItr->Low, ClusterItr->Span, this->Aligned, Candidates, 0);
+		}
+	}
+
+	if (this->Clusters.size() > 1) {
+		sort(Candidates.begin(), Candidates.end()); // The clusters do not overlap, so each offset is a candidate of at most one of them
+	}
+
+	for (vector<uint32_t>::const_iterator CandidateItr = Candidates.begin(); CandidateItr != Candidates.end(); ++CandidateItr) {
+		uint64_t qwValue = 0;
+
+		memcpy(&qwValue, pBuf + *CandidateItr, this->PointerSize); // Little endian: a 32-bit pointer is zero extended
+
+		vector<Target>::const_iterator TargetItr = upper_bound(this->Targets.begin(), this->Targets.end(), qwValue, [](uint64_t qwLeft, const Target& Right) { return qwLeft < Right.Start; });
+		size_t nFirstHit = Hits.size();
+
+		while (TargetItr != this->Targets.begin()) {
+			--TargetItr;
+
+			if (TargetItr->MaxEnd <= qwValue) {
+				break;
+			}
+
+			if (qwValue < TargetItr->End) {
+				Hits.push_back(make_pair(*CandidateItr, TargetItr->Index));
+			}
+		}
+
+		sort(Hits.begin() + nFirstHit, Hits.end()); // Overlapping targets matched by the same pointer are reported in target order
+		nHitCount += Hits.size() - nFirstHit;
+	}
+
+	return nHitCount;
+}
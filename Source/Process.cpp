@@ -35,11 +35,19 @@ ________________________________________________________________________________
 #include "Memory.hpp"
 #include "Interface.hpp"
 #include "MemDump.hpp"
+#include "LoaderList.hpp"
 #include "Ioc.hpp"
 #include "Scanner.hpp"
 #include "Signing.h"
 #include "PEB.h"
 #include "DotNetNative.h"
+#include "TaskPool.hpp"
+#include "AddressIndex.hpp"
+#include "Arena.hpp"
+#include "PointerScan.hpp"
+#include "ReferenceIndex.hpp"
+#include "RegionReader.hpp"
+#include "RemotePageCache.hpp"
 
 using namespace std;
 using namespace Memory;
@@ -50,38 +58,49 @@ Process::~Process() {
 		CloseHandle(this->Handle);
 	}
 
-	for (vector<Thread*>::const_iterator Itr = this->Threads.begin(); Itr != this->Threads.end(); ++Itr) {
-		delete* Itr;
+	Interface::Log(Interface::VerbosityLevel::Debug, "... releasing %I64u objects (%d KB in %d blocks) allocated for PID %d\r\n", this->Allocator->GetAllocationCount(), this->Allocator->GetReservedSize() / 1024, this->Allocator->GetBlockCount(), this->Pid);
+	this->Allocator.reset(); // Threads, entities, subregions and IOC are all destroyed and released in one shot
+	delete this->DmpCtx;
+}
+
+template<typename Segment_t> static void ReadHeapSegments(RemotePageCache* PageCache, uint64_t qwHeap, vector<pair<void*, void*>>& Segments) { // Walks the segment list of an NT heap from the segment header at the start of the heap
+	static const uint32_t HeapSegmentSignature = 0xFFEEFFEE;
+	static const size_t MaxSegments = 0x400; // A list corrupted into a cycle which does not return to the heap ends here
+	const uint64_t qwHead = qwHeap + offsetof(Segment_t, SegmentListEntry);
+	Segment_t Segment = { 0 };
+	uint64_t qwLink;
+
+	if (!PageCache->Read(reinterpret_cast<const void*>(static_cast<uintptr_t>(qwHeap)), &Segment, sizeof(Segment)) || Segment.SegmentSignature != HeapSegmentSignature) {
+		return; // A segment heap, or a heap which could not be read: only its base is indexed
 	}
 
-	for (map<uint8_t*, Entity*>::const_iterator Itr = this->Entities.begin(); Itr != this->Entities.end(); ++Itr) {
-		if (Itr->second->GetType() == Entity::Type::PE_FILE) {
-			delete dynamic_cast<PeVm::Body*>(Itr->second); // This will call the destructors for PE, mapped file and entity all to be called in inheritted order.
+	// The list also passes through its head within the heap, which is not a segment: each entry is only taken as one when its signature and heap match.
+
+	for (size_t nX = 0; nX < MaxSegments; nX++) {
+		if (Segment.SegmentSignature == HeapSegmentSignature && Segment.Heap == qwHeap && Segment.LastValidEntry > Segment.BaseAddress) {
+			Segments.push_back(make_pair(reinterpret_cast<void*>(static_cast<uintptr_t>(Segment.BaseAddress)), reinterpret_cast<void*>(static_cast<uintptr_t>(Segment.LastValidEntry))));
 		}
-		else if (Itr->second->GetType() == Entity::Type::MAPPED_FILE) {
-			delete dynamic_cast<MappedFile*>(Itr->second);
+
+		if ((qwLink = Segment.SegmentListEntry.Flink) == 0 || qwLink == qwHead) {
+			break;
 		}
-		else {
-			delete dynamic_cast<Region*>(Itr->second);;
+
+		if (!PageCache->Read(reinterpret_cast<const void*>(static_cast<uintptr_t>(qwLink - offsetof(Segment_t, SegmentListEntry))), &Segment, sizeof(Segment))) {
+			break;
 		}
 	}
-
-	delete this->DmpCtx;
 }
 
-Process::Process(uint32_t dwPid) : Pid(dwPid) {
+Process::Process(uint32_t dwPid, const SystemSnapshot& Snapshot) : Pid(dwPid), DmpCtx(nullptr), Allocator(make_unique<Arena>()), Regions(nullptr), RefIndex(nullptr), PageCache(nullptr), Loader(nullptr) {
 	this->Handle = OpenProcess(PROCESS_VM_READ | PROCESS_QUERY_INFORMATION, false, dwPid);
 
 	if (this->Handle != nullptr) {
-		wchar_t ImageName[MAX_PATH + 1] = { 0 }, DevFilePath[MAX_PATH + 1] = { 0 };
-
-		if (GetModuleBaseNameW(this->Handle, nullptr, ImageName, MAX_PATH + 1) && GetProcessImageFileNameW(this->Handle, DevFilePath, sizeof(DevFilePath))) { // This API uses the image base from the PEB - if it has been moved to a non-image region this call will fail.
-			wchar_t ImageFilePath[MAX_PATH + 1] = { 0 };
+		this->PageCache = this->Allocator->New<RemotePageCache>(this->Handle);
+		const SystemSnapshot::ProcessEntry* SnapshotEntry = Snapshot.GetProcess(dwPid); // Name, image path and thread list are borrowed from the scan-wide snapshot rather than queried per process
 
-			if (FileBase::TranslateDevicePath(DevFilePath, ImageFilePath)) {
-				this->Name = wstring(ImageName);
-				this->ImageFilePath = wstring(ImageFilePath);
-			}
+		if (SnapshotEntry != nullptr && !SnapshotEntry->Name.empty() && !SnapshotEntry->ImageFilePath.empty()) {
+			this->Name = SnapshotEntry->Name;
+			this->ImageFilePath = SnapshotEntry->ImageFilePath;
 		}
 
 		if (this->Name.empty()) {
@@ -126,7 +145,6 @@ Process::Process(uint32_t dwPid) : Pid(dwPid) {
 		static NtQueryInformationProcess_t NtQueryInformationProcess = reinterpret_cast<NtQueryInformationProcess_t>(GetProcAddress(GetModuleHandleW(L"Ntdll.dll"), "NtQueryInformationProcess"));
 		NTSTATUS NtStatus;
 		void* RemotePeb = nullptr;
-		uint32_t dwPebSize = 0;
 		PROCESS_BASIC_INFORMATION Pbi = { 0 };
 
 		if (this->IsWow64()) {
@@ -143,105 +161,146 @@ Process::Process(uint32_t dwPid) : Pid(dwPid) {
 		if (RemotePeb != nullptr) {
 			Interface::Log(Interface::VerbosityLevel::Debug, "... PEB of 0x%p\r\n", RemotePeb);
 
+			// Only the fields of the PEB which are used are read, through the page cache of the process: the PEB, the heap list and the TEBs read by each thread are
+			// typically within a few pages of one another.
+
 			if (this->IsWow64()) {
-				unique_ptr<PEB32> LocalPeb = make_unique<PEB32>();
-				dwPebSize = sizeof(PEB32);
+				uint32_t dwImageBase = 0, dwNumberOfHeaps = 0, dwProcessHeaps = 0;
 
-				if (ReadProcessMemory(this->Handle, RemotePeb, LocalPeb.get(), dwPebSize, nullptr)) {
-					uint32_t dwNumberOfHeaps = LocalPeb->NumberOfHeaps;
+				if (this->PageCache->ReadField(RemotePeb, offsetof(PEB32, ImageBaseAddress), dwImageBase) && this->PageCache->ReadField(RemotePeb, offsetof(PEB32, NumberOfHeaps), dwNumberOfHeaps) && this->PageCache->ReadField(RemotePeb, offsetof(PEB32, ProcessHeaps), dwProcessHeaps)) {
 					uint32_t dwHeapsSize = dwNumberOfHeaps * sizeof(uint32_t);
 					unique_ptr<uint32_t[]> Heaps = make_unique<uint32_t[]>(dwNumberOfHeaps);
 
-					this->ImageBase = reinterpret_cast<void*>(LocalPeb->ImageBaseAddress);
+					this->ImageBase = reinterpret_cast<void*>(dwImageBase);
 					Interface::Log(Interface::VerbosityLevel::Debug, "... successfully read remote PEB to local memory (%d heaps) - image base 0x%p\r\n", dwNumberOfHeaps, this->ImageBase);
 
-					if (ReadProcessMemory(this->Handle, reinterpret_cast<void*>(LocalPeb->ProcessHeaps), Heaps.get(), dwHeapsSize, nullptr)) {
+					if (this->PageCache->Read(reinterpret_cast<void*>(dwProcessHeaps), Heaps.get(), dwHeapsSize)) {
 						Interface::Log(Interface::VerbosityLevel::Debug, "... successfully read remote heaps to local memory.\r\n");
 
 						for (uint32_t dwX = 0; dwX < dwNumberOfHeaps; dwX++) {
 							Interface::Log(Interface::VerbosityLevel::Debug, "... 0x%08x\r\n", Heaps[dwX]);
 							this->Heaps.push_back(reinterpret_cast<void*>(Heaps[dwX]));
+							ReadHeapSegments<HEAP_SEGMENT32>(this->PageCache, Heaps[dwX], this->HeapSegments);
 						}
 					}
 				}
 			}
 			else {
-				unique_ptr<PEB64> LocalPeb = make_unique<PEB64>();
-				dwPebSize = sizeof(PEB64);
+				uint64_t qwImageBase = 0, qwProcessHeaps = 0;
+				uint32_t dwNumberOfHeaps = 0;
 
-				if (ReadProcessMemory(this->Handle, RemotePeb, LocalPeb.get(), dwPebSize, nullptr)) {
-					uint32_t dwNumberOfHeaps = LocalPeb->NumberOfHeaps;
+				if (this->PageCache->ReadField(RemotePeb, offsetof(PEB64, ImageBaseAddress), qwImageBase) && this->PageCache->ReadField(RemotePeb, offsetof(PEB64, NumberOfHeaps), dwNumberOfHeaps) && this->PageCache->ReadField(RemotePeb, offsetof(PEB64, ProcessHeaps), qwProcessHeaps)) {
 					uint32_t dwHeapsSize = dwNumberOfHeaps * sizeof(void*);
 					unique_ptr<uint64_t[]> Heaps = make_unique<uint64_t[]>(dwNumberOfHeaps);
 
-					this->ImageBase = reinterpret_cast<void*>(LocalPeb->ImageBaseAddress);
+					this->ImageBase = reinterpret_cast<void*>(qwImageBase);
 					Interface::Log(Interface::VerbosityLevel::Debug, "... successfully read remote PEB to local memory (%d heaps) - image base 0x%p\r\n", dwNumberOfHeaps, this->ImageBase);
 
-					if (ReadProcessMemory(this->Handle, reinterpret_cast<void*>(LocalPeb->ProcessHeaps), Heaps.get(), dwHeapsSize, nullptr)) {
+					if (this->PageCache->Read(reinterpret_cast<void*>(qwProcessHeaps), Heaps.get(), dwHeapsSize)) {
 						Interface::Log(Interface::VerbosityLevel::Debug, "... successfully read remote heaps to local memory.\r\n");
 
 						for (uint32_t dwX = 0; dwX < dwNumberOfHeaps; dwX++) {
 							Interface::Log(Interface::VerbosityLevel::Debug, "... 0x%p\r\n", Heaps[dwX]);
 							this->Heaps.push_back(reinterpret_cast<void*>(Heaps[dwX]));
+							ReadHeapSegments<HEAP_SEGMENT64>(this->PageCache, Heaps[dwX], this->HeapSegments);
 						}
 					}
 				}
 			}
 		}
 
-		HANDLE hThreadSnap = INVALID_HANDLE_VALUE;
-		THREADENTRY32 ThreadEntry;
+		// The loader data is walked once here, rather than by psapi queries for each image region which each walk the remote list again. A Wow64 process has a
+		// native loader list (ntdll and the Wow64 layer) alongside its 32-bit one.
 
-		if ((hThreadSnap = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0)) != INVALID_HANDLE_VALUE) {
-			ThreadEntry.dwSize = sizeof(THREADENTRY32);
+		LoaderList::Reader_t ReadRemote = [this](uint64_t qwAddress, void* pBuf, size_t cbSize) { return this->PageCache->Read(reinterpret_cast<const void*>(static_cast<uintptr_t>(qwAddress)), pBuf, cbSize); };
+		this->Loader = this->Allocator->New<LoaderList>();
 
-			if (Thread32First(hThreadSnap, &ThreadEntry)) {
-				do {
-					if (ThreadEntry.th32OwnerProcessID == this->Pid) {
-						try {
-							this->Threads.push_back(new Thread(ThreadEntry.th32ThreadID, *this));
-						}
-						catch (int32_t nError) {
-							Interface::Log(Interface::VerbosityLevel::Surface, "... failed to query thread information for TID %d in PID %d: cancelling scan of process.\r\n", ThreadEntry.th32ThreadID, this->Pid);
-							throw 2;
-						}
+		if (RemotePeb != nullptr) {
+#ifdef _WIN64
+			if (this->IsWow64()) {
+				this->Loader->Walk32(ReadRemote, reinterpret_cast<uintptr_t>(RemotePeb));
+
+				if (NT_SUCCESS(NtQueryInformationProcess(this->Handle, ProcessBasicInformation, &Pbi, sizeof(Pbi), nullptr)) && Pbi.PebBaseAddress != nullptr) {
+					this->Loader->Walk64(ReadRemote, reinterpret_cast<uintptr_t>(Pbi.PebBaseAddress));
+				}
+			}
+			else {
+				this->Loader->Walk64(ReadRemote, reinterpret_cast<uintptr_t>(RemotePeb));
+			}
+#else
+			this->Loader->Walk32(ReadRemote, reinterpret_cast<uintptr_t>(RemotePeb));
+#endif
+		}
+
+		Interface::Log(Interface::VerbosityLevel::Debug, "... %Iu modules linked into the loader data\r\n", this->Loader->GetModules().size());
+
+		if (SnapshotEntry != nullptr) {
+			for (vector<uint32_t>::const_iterator TidItr = SnapshotEntry->Tids.begin(); TidItr != SnapshotEntry->Tids.end(); ++TidItr) {
+				try {
+					this->Threads.push_back(this->Allocator->New<Thread>(*TidItr, *this));
+				}
+				catch (int32_t nError) {
+					if (nError == 1 && GetLastError() == ERROR_INVALID_PARAMETER) { // The snapshot is shared by the whole scan: threads which have exited since it was taken can no longer be opened and are skipped
+						Interface::Log(Interface::VerbosityLevel::Debug, "... TID %d in PID %d exited after the system snapshot was taken\r\n", *TidItr, this->Pid);
+						continue;
 					}
-				} while (Thread32Next(hThreadSnap, &ThreadEntry));
+
+					Interface::Log(Interface::VerbosityLevel::Surface, "... failed to query thread information for TID %d in PID %d: cancelling scan of process.\r\n", *TidItr, this->Pid);
+					throw 2;
+				}
 			}
 
-			CloseHandle(hThreadSnap);
-			Interface::Log(Interface::VerbosityLevel::Debug, "... associated a total of %d threads with the current process.\r\n", this->Threads.size());
+			Interface::Log(Interface::VerbosityLevel::Debug, "... associated a total of %Iu threads with the current process.\r\n", this->Threads.size());
 		}
 
+		// Collect the basic information of every region in the address space grouped by allocation base. This is cheap relative to entity construction, which may
+		// query the working set, open and verify the signature of mapped files and parse PE headers for each allocation, and is therefore done in parallel.
+
 		SIZE_T cbRegionSize = 0;
-		vector<Subregion*> Subregions;
-		vector<Subregion*>::iterator Region;
+		vector<pair<size_t, size_t>> Allocations; // First row in the region table and subregion count of each allocation
+
+		this->Regions = this->Allocator->New<RegionTable>();
 
 		for (uint8_t* pBaseAddr = nullptr;; pBaseAddr += cbRegionSize) {
-			unique_ptr< MEMORY_BASIC_INFORMATION> Mbi = make_unique<MEMORY_BASIC_INFORMATION>();
+			MEMORY_BASIC_INFORMATION Mbi = { 0 };
 
-			if (VirtualQueryEx(this->Handle, pBaseAddr, Mbi.get(), sizeof(MEMORY_BASIC_INFORMATION)) == sizeof(MEMORY_BASIC_INFORMATION)) {
-				cbRegionSize = Mbi->RegionSize;
+			if (VirtualQueryEx(this->Handle, pBaseAddr, &Mbi, sizeof(MEMORY_BASIC_INFORMATION)) == sizeof(MEMORY_BASIC_INFORMATION)) {
+				cbRegionSize = Mbi.RegionSize;
 
-				if (!Subregions.empty()) { // If the subregion list is empty then there is no region base for comparison
-					if (Mbi->AllocationBase != (*Region)->GetBasic()->AllocationBase) {
-						this->Entities.insert(make_pair(static_cast<uint8_t*>((*Region)->GetBasic()->AllocationBase), Entity::Create(*this, Subregions)));
-						Subregions.clear();
-					}
+				if (Allocations.empty() || static_cast<uint8_t*>(Mbi.AllocationBase) != this->Regions->GetAllocationBase(Allocations.back().first)) { // The first subregion of each allocation serves as its region base for comparison
+					Allocations.push_back(make_pair(this->Regions->GetCount(), 0));
 				}
 
-				Subregions.push_back(new Subregion(*this, Mbi.get()));
-				Mbi.release();
-				Region = Subregions.begin();
+				this->Regions->Append(Mbi);
+				Allocations.back().second++;
 			}
 			else {
-				if (!Subregions.empty()) { // Edge case: new region not yet found but finished enumerating subregions.
-					this->Entities.insert(make_pair(static_cast<uint8_t*>((*Region)->GetBasic()->AllocationBase), Entity::Create(*this, Subregions)));
-				}
-
 				break;
 			}
 		}
+
+		// Attribute thread, stack, TEB, heap and image base addresses to every subregion in one merge-join of the address index against the (address ordered) region table.
+
+		AddressIndex Index(*this);
+		vector<vector<Thread*>> SbrThreads = Index.Attribute(*this->Regions);
+		Interface::Log(Interface::VerbosityLevel::Debug, "... attributed %Iu indexed addresses across %Iu subregions\r\n", Index.GetIntervalCount(), this->Regions->GetCount());
+		vector<Entity*> NewEntities(Allocations.size(), nullptr);
+
+		TaskPool::ParallelFor(Allocations.size(), [this, &Allocations, &SbrThreads, &NewEntities](size_t nIndex) {
+			vector<Subregion*> Subregions;
+
+			for (size_t nX = Allocations[nIndex].first; nX < Allocations[nIndex].first + Allocations[nIndex].second; nX++) {
+				Subregions.push_back(this->Allocator->New<Subregion>(*this, this->Regions, nX, SbrThreads[nX]));
+			}
+
+			NewEntities[nIndex] = Entity::Create(*this, Subregions);
+		});
+
+		for (size_t nX = 0; nX < NewEntities.size(); nX++) { // Entities are inserted in address order regardless of the order in which they were constructed
+			this->Entities.insert(make_pair(this->Regions->GetAllocationBase(Allocations[nX].first), NewEntities[nX]));
+		}
+
+		Interface::Log(Interface::VerbosityLevel::Debug, "... constructed %Iu entities from %Iu allocations\r\n", this->Entities.size(), Allocations.size());
 	}
 	else {
 		Interface::Log(Interface::VerbosityLevel::Debug, "... failed to open handle to PID %d\r\n", this->Pid);
@@ -249,6 +308,14 @@ Process::Process(uint32_t dwPid) : Pid(dwPid) {
 	}
 }
 
+const ReferenceIndex* Process::GetReferenceIndex() {
+	if (this->RefIndex == nullptr) {
+		this->RefIndex = this->Allocator->New<ReferenceIndex>(*this);
+	}
+
+	return this->RefIndex;
+}
+
 PeVm::Body* Process::GetLoadedModule(wstring Name) const {
 	wstring SanitizedName = Name;
 	transform(SanitizedName.begin(), SanitizedName.end(), SanitizedName.begin(), ::toupper);
@@ -269,85 +336,124 @@ PeVm::Body* Process::GetLoadedModule(wstring Name) const {
 	return nullptr;
 }
 
-template<typename Address_t> int32_t ScanChunkForAddress(uint8_t* pBuf, uint32_t dwSize, const uint8_t* pReferencedAddress, const uint32_t dwRegionSize) {
-	assert(pBuf != nullptr);
-	assert(pReferencedAddress != nullptr);
+int32_t Process::SearchReferences(map <uint8_t*, vector<uint8_t*>> &ReferencesMap, const uint8_t* pReferencedAddress, const uint32_t dwRegionSize) const {
+	vector<map<uint8_t*, vector<uint8_t*>>> ReferenceMaps;
+	int32_t nRefTotal = this->SearchReferences(ReferenceMaps, vector<pair<const uint8_t*, uint32_t>>(1, make_pair(pReferencedAddress, dwRegionSize)));
+
+	ReferencesMap.insert(ReferenceMaps.front().begin(), ReferenceMaps.front().end());
+	return nRefTotal;
+}
 
-	for (int32_t nOffset = 0; nOffset < dwSize; nOffset++) {
-		Address_t PotentialAddress = *(Address_t*)&pBuf[nOffset];
+int32_t Process::SearchReferences(vector<map<uint8_t*, vector<uint8_t*>>>& ReferenceMaps, const vector<pair<const uint8_t*, uint32_t>>& Targets) const {
+	int32_t nRefTotal = 0;
+	vector<Entity*> SearchEntities;
 
-		if (!dwRegionSize && PotentialAddress == reinterpret_cast<Address_t>(pReferencedAddress)) {
-			return nOffset;
-		}
+	ReferenceMaps.assign(Targets.size(), map<uint8_t*, vector<uint8_t*>>());
 
-		if (PotentialAddress >= reinterpret_cast<Address_t>(pReferencedAddress) && PotentialAddress < reinterpret_cast<Address_t>(pReferencedAddress + dwRegionSize)) {
-			return nOffset;
-		}
+	for (map<uint8_t*, Entity*>::const_iterator EntItr = this->Entities.begin(); EntItr != this->Entities.end(); ++EntItr) {
+		SearchEntities.push_back(EntItr->second);
 	}
 
-	return -1;
-}
+	// Each entity is searched as a separate task, reading each of its subregions once and matching every pointer within it against all of the targets. Hits are
+	// recorded per entity as target/subregion base/offset and merged into the reference map of each target in address order afterward.
 
-int32_t Process::SearchReferences(map <uint8_t*, vector<uint8_t*>> &ReferencesMap, const uint8_t* pReferencedAddress, const uint32_t dwRegionSize) const {
-	int32_t nRefTotal = 0;
+	struct ReferenceHit {
+		size_t TargetIndex;
+		uint8_t* SubregionBase;
+		uint32_t Offset;
+	};
 
-	for (map<uint8_t*, Entity*>::const_iterator EntItr = this->Entities.begin(); EntItr != this->Entities.end(); ++EntItr) {
-		vector<Subregion*> Subregions = EntItr->second->GetSubregions();
+	vector<vector<ReferenceHit>> EntityHits(SearchEntities.size());
+	PointerScan Scanner(this->IsWow64() ? 4 : 8, false); // Pointers within a Wow64 process are 32-bit and may be stored at any offset
 
-		for (vector<Subregion*>::const_iterator SbrItr = Subregions.begin(); SbrItr != Subregions.end(); ++SbrItr) {
-			uint8_t* pDmpBuf = nullptr;
-			uint32_t dwDmpSize = 0;
+	Scanner.SetTargets(Targets);
 
-			if ((*SbrItr)->GetBasic()->Protect == PAGE_READONLY) continue;
-			if ((*SbrItr)->GetBasic()->State != MEM_COMMIT) continue;
+	TaskPool::ParallelFor(SearchEntities.size(), [this, &SearchEntities, &EntityHits, &Scanner](size_t nIndex) {
+		vector<Subregion*> Subregions = SearchEntities[nIndex]->GetSubregions();
 
-			if (DmpCtx->Create((*SbrItr)->GetBasic(), &pDmpBuf, &dwDmpSize)) {
-				int32_t nOffset;
+		for (vector<Subregion*>::const_iterator SbrItr = Subregions.begin(); SbrItr != Subregions.end(); ++SbrItr) {
+			if ((*SbrItr)->GetProtect() == PAGE_READONLY) continue;
+			if ((*SbrItr)->GetState() != MEM_COMMIT) continue;
 
-				if((nOffset = ScanChunkForAddress<uint64_t>(pDmpBuf, dwDmpSize, pReferencedAddress, dwRegionSize)) != -1) {
-					// In the event that an entry does not already exist in the reference map for this entity, create one with an empty vector. Otherwise, point the vector reference at the existing vector
+			RegionReader Reader(this->Handle, (*SbrItr)->GetBase(), (*SbrItr)->GetSize(), Scanner.GetPointerSize() - 1, REGION_READER_FLAG_SKIP_ZERO_PAGES); // Each run overlaps its neighbours by one byte less than a pointer: the offsets it repeats could not be scanned in the previous run
+			map<size_t, uint32_t> FirstHits; // Only the first reference to each target within each subregion is recorded
 
-					auto RegionMapItr = ReferencesMap.find(static_cast<unsigned char*>(const_cast<void*>(EntItr->second->GetStartVa()))); // An iterator into the main region map which points to the entry for the sub-region vector.
-					vector<uint8_t*>* SbrMap = nullptr;
+			while (Reader.Next()) {
+				vector<pair<uint32_t, size_t>> Hits;
 
-					if (RegionMapItr == ReferencesMap.end()) {
-						ReferencesMap.insert(make_pair(static_cast<unsigned char*>(const_cast<void*>(EntItr->second->GetStartVa())), vector<uint8_t*>()));
-					}
+				Scanner.FindTargets(Reader.GetData(), Reader.GetSize(), Hits);
 
-					SbrMap = &ReferencesMap.at(static_cast<unsigned char*>(const_cast<void*>(EntItr->second->GetStartVa()))); // This will always be successful
-					SbrMap->push_back(static_cast<uint8_t*>(const_cast<void*>((*SbrItr)->GetBasic()->BaseAddress)));
-					Interface::Log(Interface::VerbosityLevel::Debug, "... found referenced address 0x%p at 0x%p (offset 0x%08x within 0x%p)\r\n", pReferencedAddress, static_cast<uint8_t*>(const_cast<void*>((*SbrItr)->GetBasic()->BaseAddress)) + nOffset, nOffset, (*SbrItr)->GetBasic()->BaseAddress);
-					nRefTotal++;
+				for (vector<pair<uint32_t, size_t>>::const_iterator HitItr = Hits.begin(); HitItr != Hits.end(); ++HitItr) {
+					FirstHits.insert(make_pair(HitItr->second, static_cast<uint32_t>(Reader.GetOffset() + HitItr->first)));
 				}
+			}
 
-				delete [] pDmpBuf;
+			for (vector<pair<size_t, size_t>>::const_iterator RangeItr = Reader.GetUnreadableRanges().begin(); RangeItr != Reader.GetUnreadableRanges().end(); ++RangeItr) {
+				Interface::Log(Interface::VerbosityLevel::Debug, "... skipped 0x%Ix unreadable bytes at 0x%p during reference search\r\n", RangeItr->second, static_cast<uint8_t*>((*SbrItr)->GetBase()) + RangeItr->first);
 			}
+
+			for (map<size_t, uint32_t>::const_iterator HitItr = FirstHits.begin(); HitItr != FirstHits.end(); ++HitItr) {
+				ReferenceHit NewHit = { HitItr->first, static_cast<uint8_t*>((*SbrItr)->GetBase()), HitItr->second };
+				EntityHits[nIndex].push_back(NewHit);
+			}
+		}
+	});
+
+	for (size_t nIndex = 0; nIndex < SearchEntities.size(); nIndex++) {
+		for (vector<ReferenceHit>::const_iterator HitItr = EntityHits[nIndex].begin(); HitItr != EntityHits[nIndex].end(); ++HitItr) {
+			// In the event that an entry does not already exist in the reference map for this entity, create one with an empty vector. Otherwise, point the vector reference at the existing vector
+
+			map<uint8_t*, vector<uint8_t*>>& ReferencesMap = ReferenceMaps[HitItr->TargetIndex];
+			auto RegionMapItr = ReferencesMap.find(static_cast<unsigned char*>(const_cast<void*>(SearchEntities[nIndex]->GetStartVa()))); // An iterator into the main region map which points to the entry for the sub-region vector.
+			vector<uint8_t*>* SbrMap = nullptr;
+
+			if (RegionMapItr == ReferencesMap.end()) {
+				ReferencesMap.insert(make_pair(static_cast<unsigned char*>(const_cast<void*>(SearchEntities[nIndex]->GetStartVa())), vector<uint8_t*>()));
+			}
+
+			SbrMap = &ReferencesMap.at(static_cast<unsigned char*>(const_cast<void*>(SearchEntities[nIndex]->GetStartVa()))); // This will always be successful
+			SbrMap->push_back(HitItr->SubregionBase);
+			Interface::Log(Interface::VerbosityLevel::Debug, "... found referenced address 0x%p at 0x%p (offset 0x%08x within 0x%p)\r\n", Targets[HitItr->TargetIndex].first, HitItr->SubregionBase + HitItr->Offset, HitItr->Offset, HitItr->SubregionBase);
+			nRefTotal++;
 		}
 	}
 	
 	return nRefTotal;
 }
 
-int32_t Process::SearchDllDataReferences(const uint8_t* pReferencedAddress, const uint32_t dwRegionSize) const {
+int32_t Process::SearchDllDataReferences(vector<int32_t>& RefCounts, const vector<pair<const uint8_t*, uint32_t>>& Targets) const {
 	int32_t nRefTotal = 0;
+	PointerScan Scanner(this->IsWow64() ? 4 : 8, false);
+
+	RefCounts.assign(Targets.size(), 0);
+	Scanner.SetTargets(Targets);
 
 	for (map<uint8_t*, Entity*>::const_iterator EntItr = this->Entities.begin(); EntItr != this->Entities.end(); ++EntItr) {
 		if (EntItr->second->GetType() == Entity::Type::PE_FILE) {
 			PeVm::Body* PeEntity = dynamic_cast<PeVm::Body*>(EntItr->second);
 
 			if (PeEntity != nullptr && (_wcsicmp(PeEntity->GetPebModule().GetName().c_str(), L"clr.dll") == 0 || _wcsicmp(PeEntity->GetPebModule().GetName().c_str(), L"mscorwks.dll") == 0)) { // https://docs.microsoft.com/en-us/windows-hardware/drivers/debugger/debugging-managed-code provides chart of CLR versions of their DLL: only mscorwks.dll and clr.dll are used.
-				PeVm::Section* DataSect = PeEntity->GetSection(".data");
+				const PeVm::Section* DataSect = PeEntity->GetSection(".data");
 
 				if (DataSect != nullptr) {
-					unique_ptr<uint8_t[]> Buf = make_unique<uint8_t[]>(DataSect->GetEntitySize());
+					RegionReader Reader(this->GetHandle(), DataSect->GetStartVa(), DataSect->GetEntitySize(), Scanner.GetPointerSize() - 1, REGION_READER_FLAG_SKIP_ZERO_PAGES);
+					vector<bool> Found(Targets.size(), false);
 
-					if (ReadProcessMemory(this->GetHandle(), DataSect->GetStartVa(), Buf.get(), DataSect->GetEntitySize(), nullptr)) {
-						int32_t nOffset;
+					while (Reader.Next()) {
+						vector<pair<uint32_t, size_t>> Hits;
 
-						if ((nOffset = ScanChunkForAddress<uint64_t>(Buf.get(), DataSect->GetEntitySize(), pReferencedAddress, dwRegionSize)) != -1) {
-							Interface::Log(Interface::VerbosityLevel::Debug, "... found private executable region address 0x%p at 0x%p (offset 0x%08x) in %ws .data section\r\n",
-								pReferencedAddress, (uint8_t *)DataSect->GetStartVa() + nOffset, nOffset, PeEntity->GetPebModule().GetName().c_str());
-							nRefTotal++;
+						Scanner.FindTargets(Reader.GetData(), Reader.GetSize(), Hits);
+
+						for (vector<pair<uint32_t, size_t>>::const_iterator HitItr = Hits.begin(); HitItr != Hits.end(); ++HitItr) {
+							if (!Found[HitItr->second]) { // Each target is counted once per CLR module, at its first reference
+								uint32_t dwOffset = static_cast<uint32_t>(Reader.GetOffset() + HitItr->first);
+
+								Found[HitItr->second] = true;
+								RefCounts[HitItr->second]++;
+								Interface::Log(Interface::VerbosityLevel::Debug, "... found private executable region address 0x%p at 0x%p (offset 0x%08x) in %ws .data section\r\n",
+									Targets[HitItr->second].first, (uint8_t *)DataSect->GetStartVa() + dwOffset, dwOffset, PeEntity->GetPebModule().GetName().c_str());
+								nRefTotal++;
+							}
 						}
 					}
 				}
@@ -358,23 +464,53 @@ int32_t Process::SearchDllDataReferences(const uint8_t* pReferencedAddress, cons
 	return nRefTotal;
 }
 
-bool Process::CheckDotNetAffiliation(const uint8_t* pReferencedAddress, const uint32_t dwRegionSize) const {
-	int32_t nRefTotal = 0;
-	map <uint8_t*, vector<uint8_t*>> PrvXRefMap;
+vector<bool> Process::CheckDotNetAffiliation(const vector<pair<const uint8_t*, uint32_t>>& Targets) const {
+	vector<bool> Affiliations(Targets.size(), false);
+	vector<map<uint8_t*, vector<uint8_t*>>> PrvXRefMaps;
+	vector<int32_t> DataRefCounts;
+
+	// A target is affiliated with the CLR when it is referenced from elsewhere in the process and either it, or one of the regions which reference it, is referenced
+	// from the .data section of the CLR. Each of these steps is done for all targets at once so that the address space is read a single time.
+
+	this->SearchReferences(PrvXRefMaps, Targets);
+	this->SearchDllDataReferences(DataRefCounts, Targets);
+
+	vector<pair<const uint8_t*, uint32_t>> ReferencingRegions;
+	map<const uint8_t*, size_t> ReferencingRegionIndexes;
+
+	for (size_t nX = 0; nX < Targets.size(); nX++) {
+		if (!PrvXRefMaps[nX].empty()) {
+			if (DataRefCounts[nX]) {
+				Affiliations[nX] = true;
+			}
+			else {
+				for (map <uint8_t*, vector<uint8_t*>>::const_iterator RefItr = PrvXRefMaps[nX].begin(); RefItr != PrvXRefMaps[nX].end(); ++RefItr) {
+					if (ReferencingRegionIndexes.insert(make_pair(RefItr->first, ReferencingRegions.size())).second) {
+						ReferencingRegions.push_back(make_pair(RefItr->first, 0));
+					}
+				}
+			}
+		}
+	}
+
+	if (!ReferencingRegions.empty()) {
+		vector<int32_t> RegionRefCounts;
 
-	if (this->SearchReferences(PrvXRefMap, pReferencedAddress, dwRegionSize) > 0) {
-		if(!(nRefTotal = SearchDllDataReferences(pReferencedAddress, dwRegionSize))) {
-			for (map <uint8_t*, vector<uint8_t*>>::const_iterator RefItr = PrvXRefMap.begin(); RefItr != PrvXRefMap.end(); ++RefItr) {
-				map <uint8_t*, vector<uint8_t*>> RefMap;
+		this->SearchDllDataReferences(RegionRefCounts, ReferencingRegions);
 
-				if(SearchDllDataReferences(RefItr->first, 0)){
-					nRefTotal++;
+		for (size_t nX = 0; nX < Targets.size(); nX++) {
+			if (!Affiliations[nX]) {
+				for (map <uint8_t*, vector<uint8_t*>>::const_iterator RefItr = PrvXRefMaps[nX].begin(); RefItr != PrvXRefMaps[nX].end(); ++RefItr) {
+					if (RegionRefCounts[ReferencingRegionIndexes[RefItr->first]]) {
+						Affiliations[nX] = true;
+						break;
+					}
 				}
 			}
 		}
 	}
 
-	return nRefTotal > 0 ? true : false;
+	return Affiliations;
 }
 
 void Process::Enumerate(ScannerContext& ScannerCtx, vector<Ioc*> *SelectedIocs, vector<Subregion*> *SelectedSbrs) {
@@ -385,10 +521,26 @@ void Process::Enumerate(ScannerContext& ScannerCtx, vector<Ioc*> *SelectedIocs,
 
 	// Build suspicions list for following memory selection and apply filters to it.
 
+	// Each entity is inspected as a separate task into a private map. The maps are keyed by entity start address and therefore never collide when merged.
+
+	vector<Entity*> InspectEntities;
+
 	for (map<uint8_t*, Entity*>::const_iterator Itr = this->Entities.begin(); Itr != this->Entities.end(); ++Itr) {
-		Ioc::InspectEntity(*this, *Itr->second, Iocs.GetMap());
+		InspectEntities.push_back(Itr->second);
+	}
+
+	vector<map <uint8_t*, map<uint8_t*, list<Ioc*>>>> EntityIocs(InspectEntities.size());
+
+	TaskPool::ParallelFor(InspectEntities.size(), [this, &InspectEntities, &EntityIocs](size_t nIndex) {
+		Ioc::InspectEntity(*this, *InspectEntities[nIndex], &EntityIocs[nIndex]);
+	});
+
+	for (vector<map <uint8_t*, map<uint8_t*, list<Ioc*>>>>::iterator Itr = EntityIocs.begin(); Itr != EntityIocs.end(); ++Itr) {
+		Iocs.GetMap()->insert(Itr->begin(), Itr->end());
 	}
 
+	Ioc::InspectLoaderList(*this, Iocs.GetMap()); // Loader entries are joined to the image entities only once the entities have all been inspected
+
 	if (Iocs.GetMap()->size()) {
 		Iocs.Filter(ScannerCtx.GetFilters());
 	}
@@ -396,11 +548,37 @@ void Process::Enumerate(ScannerContext& ScannerCtx, vector<Ioc*> *SelectedIocs,
 	// Build map of references to user-specified address if applicable for scanner context
 
 	if (ScannerCtx.GetMst() == ScannerContext::MemorySelection_t::Referenced) {
-		this->SearchReferences(ReferencesMap, ScannerCtx.GetAddress(), ScannerCtx.GetRegionSize());
+		if ((ScannerCtx.GetFlags() & PROCESS_ENUM_FLAG_REFERENCE_INDEX) || ScannerCtx.GetReferenceDepth() > 1) { // Transitive queries require the reverse pointer index
+			this->GetReferenceIndex()->Search(ReferencesMap, ScannerCtx.GetAddress(), ScannerCtx.GetRegionSize(), ScannerCtx.GetReferenceDepth());
+		}
+		else {
+			this->SearchReferences(ReferencesMap, ScannerCtx.GetAddress(), ScannerCtx.GetRegionSize());
+		}
 	}
 
 	// Display information on each selected subregion and/or entity within the process address space
 
+	auto ShowProcess = [this, &bShownProc]() {
+		if (!bShownProc) {
+			Interface::Log(Interface::VerbosityLevel::Surface, "\r\n");
+			Interface::Log(Interface::VerbosityLevel::Surface, Interface::ConsoleColor::Turquoise, "%ws", this->Name.c_str());
+			Interface::Log(Interface::VerbosityLevel::Surface, " : ");
+			Interface::Log(Interface::VerbosityLevel::Surface, Interface::ConsoleColor::Turquoise, "%d", this->GetPid());
+			Interface::Log(Interface::VerbosityLevel::Surface, " : ");
+			Interface::Log(Interface::VerbosityLevel::Surface, Interface::ConsoleColor::Turquoise, "%ws", this->IsWow64() ? L"Wow64" : L"x64");
+			Interface::Log(Interface::VerbosityLevel::Surface, " : ");
+			Interface::Log(Interface::VerbosityLevel::Surface, Interface::ConsoleColor::Turquoise, "%ws", this->ImageFilePath.c_str());
+
+			if (this->GetClrVersion()) {
+				Interface::Log(Interface::VerbosityLevel::Surface, " : ");
+				Interface::Log(Interface::VerbosityLevel::Surface, Interface::ConsoleColor::Turquoise, "CLR v%d", this->GetClrVersion());
+			}
+
+			Interface::Log(Interface::VerbosityLevel::Surface, "\r\n");
+			bShownProc = true;
+		}
+	};
+
 	for (map<uint8_t*, Entity*>::const_iterator Itr = this->Entities.begin(); Itr != this->Entities.end(); ++Itr) {
 		auto IocRegionMapItr = Iocs.GetMap()->find(static_cast<unsigned char *>(const_cast<void*>(Itr->second->GetStartVa()))); // An iterator into the main region map which points to the entry for the sb map.
 		auto RefIocRegionMapItr = ReferencesMap.find(static_cast<unsigned char*>(const_cast<void*>(Itr->second->GetStartVa()))); // An iterator into the main region map which points to the entry for the sb map.
@@ -424,26 +602,9 @@ void Process::Enumerate(ScannerContext& ScannerCtx, vector<Ioc*> *SelectedIocs,
 
 			// Display process and/or entity information: the criteria has already been met for this to be done without further checks
 
-			if (!bShownProc) {
-				Interface::Log(Interface::VerbosityLevel::Surface, "\r\n");
-				Interface::Log(Interface::VerbosityLevel::Surface, Interface::ConsoleColor::Turquoise, "%ws", this->Name.c_str());
-				Interface::Log(Interface::VerbosityLevel::Surface, " : ");
-				Interface::Log(Interface::VerbosityLevel::Surface, Interface::ConsoleColor::Turquoise, "%d", this->GetPid());
-				Interface::Log(Interface::VerbosityLevel::Surface, " : ");
-				Interface::Log(Interface::VerbosityLevel::Surface, Interface::ConsoleColor::Turquoise, "%ws", this->IsWow64() ? L"Wow64" : L"x64");
-				Interface::Log(Interface::VerbosityLevel::Surface, " : ");
-				Interface::Log(Interface::VerbosityLevel::Surface, Interface::ConsoleColor::Turquoise, "%ws", this->ImageFilePath.c_str());
-
-				if (this->GetClrVersion()) {
-					Interface::Log(Interface::VerbosityLevel::Surface, " : ");
-					Interface::Log(Interface::VerbosityLevel::Surface, Interface::ConsoleColor::Turquoise, "CLR v%d", this->GetClrVersion());
-				}
-
-				Interface::Log(Interface::VerbosityLevel::Surface, "\r\n");
-				bShownProc = true;
-			}
+			ShowProcess();
 
-			if (Itr->second->GetSubregions().front()->GetBasic()->State != MEM_FREE) {
+			if (Itr->second->GetSubregions().front()->GetState() != MEM_FREE) {
 				Interface::Log(Interface::VerbosityLevel::Surface, "  0x%p:0x%08x   ", Itr->second->GetStartVa(), Itr->second->GetEntitySize());
 			}
 
@@ -491,7 +652,7 @@ void Process::Enumerate(ScannerContext& ScannerCtx, vector<Ioc*> *SelectedIocs,
 				Interface::Log(Interface::VerbosityLevel::Surface, "   | %ws", dynamic_cast<MappedFile*>(Itr->second)->GetFileBase()->GetPath().c_str());
 			}
 			else {
-				if (Itr->second->GetSubregions().front()->GetBasic()->Type == MEM_PRIVATE) {
+				if (Itr->second->GetSubregions().front()->GetMemoryType() == MEM_PRIVATE) {
 					Interface::Log(Interface::VerbosityLevel::Surface, "| ");
 					Interface::Log(Interface::VerbosityLevel::Surface, Interface::ConsoleColor::Gold, "Private");
 				}
@@ -552,31 +713,32 @@ void Process::Enumerate(ScannerContext& ScannerCtx, vector<Ioc*> *SelectedIocs,
 				// Select this subregion?
 
 				if (ScannerCtx.GetMst() == ScannerContext::MemorySelection_t::All ||
-					(ScannerCtx.GetMst() == ScannerContext::MemorySelection_t::Block && (ScannerCtx.GetAddress() == (*SbrItr)->GetBasic()->BaseAddress || (ScannerCtx.GetFlags() & PROCESS_ENUM_FLAG_FROM_BASE))) ||
+					(ScannerCtx.GetMst() == ScannerContext::MemorySelection_t::Block && (ScannerCtx.GetAddress() == (*SbrItr)->GetBase() || (ScannerCtx.GetFlags() & PROCESS_ENUM_FLAG_FROM_BASE))) ||
 					(ScannerCtx.GetMst() == ScannerContext::MemorySelection_t::Ioc && ((ScannerCtx.GetFlags() & PROCESS_ENUM_FLAG_FROM_BASE) || 
 																		  (IocSbrMap != nullptr &&
-																		   IocSbrMap->count(static_cast<uint8_t *>((*SbrItr)->GetBasic()->BaseAddress))) &&
-																		   SubEntityIocCount(IocSbrMap, static_cast<uint8_t *>((*SbrItr)->GetBasic()->BaseAddress)) > 0)) || 
+																		   IocSbrMap->count(static_cast<uint8_t *>((*SbrItr)->GetBase()))) &&
+																		   SubEntityIocCount(IocSbrMap, static_cast<uint8_t *>((*SbrItr)->GetBase())) > 0)) || 
 					(ScannerCtx.GetMst() == ScannerContext::MemorySelection_t::Referenced && (ScannerCtx.GetFlags() & PROCESS_ENUM_FLAG_FROM_BASE) ||
 																		  (RefSbrVec != nullptr &&
-																		  find(RefSbrVec->begin(), RefSbrVec->end(), static_cast<uint8_t*>((*SbrItr)->GetBasic()->BaseAddress)) != RefSbrVec->end()))) { // mselect == referenced and this subregion contains one or more reference or the "from base" option is set
+																		  find(RefSbrVec->begin(), RefSbrVec->end(), static_cast<uint8_t*>((*SbrItr)->GetBase())) != RefSbrVec->end()))) { // mselect == referenced and this subregion contains one or more reference or the "from base" option is set
+					MEMORY_BASIC_INFORMATION Mbi = (*SbrItr)->GetBasic();
 					wchar_t AlignedAttribDesc[9] = { 0 };
 
-					Interface::AlignStr(Subregion::AttribDesc((*SbrItr)->GetBasic()), AlignedAttribDesc, 8);
+					Interface::AlignStr(Subregion::AttribDesc(&Mbi), AlignedAttribDesc, 8);
 
 					if (Itr->second->GetType() == Entity::Type::PE_FILE && !dynamic_cast<PeVm::Body*>(Itr->second)->GetFileBase()->IsPhantom()) {
 						// Generate a list of all sections overlapping with this subregion and display them all. A typical example is a +r subregion at the end of the PE which encompasses all consecutive readonly sections ie. .rdata, .rsrc, .reloc
 
-						vector<PeVm::Section*> OverlapSections = dynamic_cast<PeVm::Body*>(Itr->second)->FindOverlapSect(*(*SbrItr));
+						vector<const PeVm::Section*> OverlapSections = dynamic_cast<PeVm::Body*>(Itr->second)->FindOverlapSect(SbrItr - Subregions.begin());
 
 						if (OverlapSections.empty()) {
-							Interface::Log(Interface::VerbosityLevel::Surface, "    0x%p:0x%08x | %ws | ?        | 0x%08x", (*SbrItr)->GetBasic()->BaseAddress, (*SbrItr)->GetBasic()->RegionSize, AlignedAttribDesc, (*SbrItr)->GetPrivateSize());
+							Interface::Log(Interface::VerbosityLevel::Surface, "    0x%p:0x%08Ix | %ws | ?        | 0x%08x", (*SbrItr)->GetBase(), (*SbrItr)->GetSize(), AlignedAttribDesc, (*SbrItr)->GetPrivateSize());
 							AppendSubregionAttributes(*SbrItr);
-							AppendOverlapIoc(IocSbrMap, static_cast<uint8_t *>((*SbrItr)->GetBasic()->BaseAddress), false, SelectedIocs);
+							AppendOverlapIoc(IocSbrMap, static_cast<uint8_t *>((*SbrItr)->GetBase()), false, SelectedIocs);
 							Interface::Log(Interface::VerbosityLevel::Surface, "\r\n");
 						}
 						else{
-							for (vector<PeVm::Section*>::const_iterator SectItr = OverlapSections.begin(); SectItr != OverlapSections.end(); ++SectItr) {
+							for (vector<const PeVm::Section*>::const_iterator SectItr = OverlapSections.begin(); SectItr != OverlapSections.end(); ++SectItr) {
 								wchar_t AlignedSectName[9] = { 0 };
 								char AnsiSectName[9];
 
@@ -584,37 +746,43 @@ void Process::Enumerate(ScannerContext& ScannerCtx, vector<Ioc*> *SelectedIocs,
 								wstring UnicodeSectName = UnicodeConverter.from_bytes(AnsiSectName);
 								Interface::AlignStr(static_cast<const wchar_t*>(UnicodeSectName.c_str()), AlignedSectName, 8);
 
-								Interface::Log(Interface::VerbosityLevel::Surface, "    0x%p:0x%08x | %ws | %ws | 0x%08x", (*SbrItr)->GetBasic()->BaseAddress, (*SbrItr)->GetBasic()->RegionSize, AlignedAttribDesc, AlignedSectName, (*SbrItr)->GetPrivateSize());
+								Interface::Log(Interface::VerbosityLevel::Surface, "    0x%p:0x%08Ix | %ws | %ws | 0x%08x", (*SbrItr)->GetBase(), (*SbrItr)->GetSize(), AlignedAttribDesc, AlignedSectName, (*SbrItr)->GetPrivateSize());
 								AppendSubregionAttributes(*SbrItr);
-								AppendOverlapIoc(IocSbrMap, static_cast<uint8_t *>((*SbrItr)->GetBasic()->BaseAddress), false, SelectedIocs);
+								AppendOverlapIoc(IocSbrMap, static_cast<uint8_t *>((*SbrItr)->GetBase()), false, SelectedIocs);
 								Interface::Log(Interface::VerbosityLevel::Surface, "\r\n");
 
 							}
 						}
 					}
 					else {
-						Interface::Log(Interface::VerbosityLevel::Surface, "    0x%p:0x%08x | %ws | 0x%08x", (*SbrItr)->GetBasic()->BaseAddress, (*SbrItr)->GetBasic()->RegionSize, AlignedAttribDesc, (*SbrItr)->GetPrivateSize());
+						Interface::Log(Interface::VerbosityLevel::Surface, "    0x%p:0x%08Ix | %ws | 0x%08x", (*SbrItr)->GetBase(), (*SbrItr)->GetSize(), AlignedAttribDesc, (*SbrItr)->GetPrivateSize());
 						AppendSubregionAttributes(*SbrItr);
-						AppendOverlapIoc(IocSbrMap, static_cast<uint8_t *>((*SbrItr)->GetBasic()->BaseAddress), false, SelectedIocs);
+						AppendOverlapIoc(IocSbrMap, static_cast<uint8_t *>((*SbrItr)->GetBase()), false, SelectedIocs);
 						Interface::Log(Interface::VerbosityLevel::Surface, "\r\n");
 					}
 
 					if (Interface::GetVerbosity() == Interface::VerbosityLevel::Detail) {
-						Interface::Log(Interface::VerbosityLevel::Surface, "    |__ Base address: 0x%p\r\n", (*SbrItr)->GetBasic()->BaseAddress);
-						Interface::Log(Interface::VerbosityLevel::Surface, "      | Size: %d\r\n", (*SbrItr)->GetBasic()->RegionSize);
-						Interface::Log(Interface::VerbosityLevel::Surface, "      | Permissions: %ws\r\n", Subregion::ProtectSymbol((*SbrItr)->GetBasic()->Protect));
-						Interface::Log(Interface::VerbosityLevel::Surface, "      | Type: %ws\r\n", Subregion::TypeSymbol((*SbrItr)->GetBasic()->Type));
-						Interface::Log(Interface::VerbosityLevel::Surface, "      | State: %ws\r\n", Subregion::StateSymbol((*SbrItr)->GetBasic()->State));
-						Interface::Log(Interface::VerbosityLevel::Surface, "      | Allocation base: 0x%p\r\n", (*SbrItr)->GetBasic()->AllocationBase);
-						Interface::Log(Interface::VerbosityLevel::Surface, "      | Allocation permissions: %ws\r\n", Subregion::ProtectSymbol((*SbrItr)->GetBasic()->AllocationProtect));
+						Interface::Log(Interface::VerbosityLevel::Surface, "    |__ Base address: 0x%p\r\n", (*SbrItr)->GetBase());
+						Interface::Log(Interface::VerbosityLevel::Surface, "      | Size: %Iu\r\n", (*SbrItr)->GetSize());
+						Interface::Log(Interface::VerbosityLevel::Surface, "      | Permissions: %ws\r\n", Subregion::ProtectSymbol((*SbrItr)->GetProtect()));
+						Interface::Log(Interface::VerbosityLevel::Surface, "      | Type: %ws\r\n", Subregion::TypeSymbol((*SbrItr)->GetMemoryType()));
+						Interface::Log(Interface::VerbosityLevel::Surface, "      | State: %ws\r\n", Subregion::StateSymbol((*SbrItr)->GetState()));
+						Interface::Log(Interface::VerbosityLevel::Surface, "      | Allocation base: 0x%p\r\n", (*SbrItr)->GetAllocationBase());
+						Interface::Log(Interface::VerbosityLevel::Surface, "      | Allocation permissions: %ws\r\n", Subregion::ProtectSymbol((*SbrItr)->GetAllocationProtect()));
 						Interface::Log(Interface::VerbosityLevel::Surface, "      | Private size: %d [%d pages]\r\n", (*SbrItr)->GetPrivateSize(), (*SbrItr)->GetPrivateSize() / 0x1000);
+
+						vector<pair<size_t, size_t>> ModifiedRuns = (*SbrItr)->GetPrivatePages().GetRuns(); // Only populated for image memory: the exact pages which have been privately modified
+
+						for (vector<pair<size_t, size_t>>::const_iterator RunItr = ModifiedRuns.begin(); RunItr != ModifiedRuns.end(); ++RunItr) {
+							Interface::Log(Interface::VerbosityLevel::Surface, "      | Modified pages: 0x%p:0x%08Ix [%Iu pages]\r\n", static_cast<uint8_t*>((*SbrItr)->GetBase()) + (RunItr->first * 0x1000), RunItr->second * 0x1000, RunItr->second);
+						}
 					}
 
 					this->EnumerateThreads(L"      ", (*SbrItr)->GetThreads());
 
 					if ((ScannerCtx.GetFlags() & PROCESS_ENUM_FLAG_MEMDUMP)) {
 						if (!(ScannerCtx.GetFlags() & PROCESS_ENUM_FLAG_FROM_BASE)) {
-							this->DumpBlock((*SbrItr)->GetBasic(), L"      ");
+							this->DumpBlock(&Mbi, L"      ");
 						}
 					}
 
@@ -635,6 +803,35 @@ void Process::Enumerate(ScannerContext& ScannerCtx, vector<Ioc*> *SelectedIocs,
 		}
 	}
 
+	// Display the loader entries which have no allocation at their base: these are raised against the process rather than an entity and so are not reached above
+
+	if (ScannerCtx.GetMst() == ScannerContext::MemorySelection_t::All || ScannerCtx.GetMst() == ScannerContext::MemorySelection_t::Ioc) {
+		for (map <uint8_t*, map<uint8_t*, list<Ioc*>>>::const_iterator RegionMapItr = Iocs.GetMap()->begin(); RegionMapItr != Iocs.GetMap()->end(); ++RegionMapItr) {
+			if (this->Entities.count(RegionMapItr->first) || !RegionMapItr->second.count(RegionMapItr->first)) {
+				continue;
+			}
+
+			const list<Ioc*>& IocsList = RegionMapItr->second.at(RegionMapItr->first);
+
+			for (list<Ioc*>::const_iterator IocItr = IocsList.begin(); IocItr != IocsList.end(); ++IocItr) {
+				if ((*IocItr)->IsProcessIoc()) {
+					const LoaderList::Module* Module = (*IocItr)->GetLoaderModule();
+
+					ShowProcess();
+					Interface::Log(Interface::VerbosityLevel::Surface, "  0x%p:0x%08x   | ", reinterpret_cast<void*>(static_cast<uintptr_t>(Module->Base)), Module->ImageSize);
+					Interface::Log(Interface::VerbosityLevel::Surface, Interface::ConsoleColor::Gold, "Unmapped");
+					Interface::Log(Interface::VerbosityLevel::Surface, " | %ws | ", Module->Path.c_str());
+					Interface::Log(Interface::VerbosityLevel::Surface, Interface::ConsoleColor::Red, "%ws", (*IocItr)->GetDescription((*IocItr)->GetType()).c_str());
+					Interface::Log(Interface::VerbosityLevel::Surface, "\r\n");
+
+					if (SelectedIocs != nullptr) {
+						SelectedIocs->push_back(*IocItr);
+					}
+				}
+			}
+		}
+	}
+
 	return;
 }
 
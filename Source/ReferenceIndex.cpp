@@ -0,0 +1,305 @@
+/*
+__________________________________________________________________________________________
+| _______  _____  __   _ _______ _______ _______                                         |
+| |  |  | |     | | \  | |______    |    |_____|                                         |
+| |  |  | |_____| |  \_| |______    |    |     |                                         |
+|________________________________________________________________________________________|
+| Moneta ~ Usermode memory scanner & malware hunter                                      |
+|----------------------------------------------------------------------------------------|
+| https://www.forrest-orr.net/post/malicious-memory-artifacts-part-ii-bypassing-scanners |
+|----------------------------------------------------------------------------------------|
+| Author: Forrest Orr - 2020                                                             |
+|----------------------------------------------------------------------------------------|
+| Contact: forrest.orr@protonmail.com                                                    |
+|----------------------------------------------------------------------------------------|
+| Licensed under GNU GPLv3                                                               |
+|________________________________________________________________________________________|
+| ## Features                                                                            |
+|                                                                                        |
+| ~ Query the memory attributes of any accessible process(es).                           |
+| ~ Identify private, mapped and image memory.                                           |
+| ~ Correlate regions of memory to their underlying file on disks.                       |
+| ~ Identify PE headers and sections corresponding to image memory.                      |
+| ~ Identify modified regions of mapped image memory.                                    |
+| ~ Identify abnormal memory attributes indicative of malware.                           |
+| ~ Create memory dumps of user-specified memory ranges                                  |
+| ~ Calculate memory permission/type statistics                                          |
+|________________________________________________________________________________________|
+
+*/
+
+#include "StdAfx.h"
+#include "Processes.hpp"
+#include "Memory.hpp"
+#include "Interface.hpp"
+#include "TaskPool.hpp"
+#include "PointerScan.hpp"
+#include "RegionReader.hpp"
+#include "ReferenceIndex.hpp"
+
+using namespace std;
+using namespace Memory;
+using namespace Processes;
+
+ReferenceIndex::ReferenceIndex(const Process& OwnerProc) : OwnerProc(OwnerProc), ReferenceCount(0) {
+	const RegionTable* Regions = OwnerProc.GetRegionTable();
+	const map<uint8_t*, Entity*>& Entities = OwnerProc.GetEntities();
+	vector<Entity*> SearchEntities;
+	vector<pair<const uint8_t*, uint64_t>> Targets;
+	PointerScan Scanner(OwnerProc.IsWow64() ? 4 : 8, true);
+
+	for (size_t nX = 0; nX < Regions->GetCount(); nX++) { // Adjacent committed subregions are coalesced into one target, so that the scanner clusters a few wide ranges rather than every subregion
+		if (Regions->GetState(nX) == MEM_COMMIT) {
+			if (!Targets.empty() && Targets.back().first + Targets.back().second == Regions->GetBase(nX)) {
+				Targets.back().second += Regions->GetSize(nX);
+			}
+			else {
+				Targets.push_back(make_pair(Regions->GetBase(nX), static_cast<uint64_t>(Regions->GetSize(nX))));
+			}
+		}
+	}
+
+	for (map<uint8_t*, Entity*>::const_iterator EntItr = Entities.begin(); EntItr != Entities.end(); ++EntItr) {
+		SearchEntities.push_back(EntItr->second);
+	}
+
+	// Each entity is read and scanned for pointers into committed memory as a separate task, which encodes its (target, source) pairs into sorted runs as it goes.
+	// The runs of all entities are then merged into the blocks of the index.
+
+	vector<vector<Run>> EntityRuns(SearchEntities.size());
+
+	Scanner.SetTargets(Targets);
+
+	TaskPool::ParallelFor(SearchEntities.size(), [&OwnerProc, &SearchEntities, &EntityRuns, &Scanner](size_t nIndex) {
+		vector<Subregion*> Subregions = SearchEntities[nIndex]->GetSubregions();
+		vector<pair<uint64_t, uint64_t>> References;
+
+		for (vector<Subregion*>::const_iterator SbrItr = Subregions.begin(); SbrItr != Subregions.end(); ++SbrItr) {
+			if ((*SbrItr)->GetProtect() == PAGE_READONLY) continue; // The same memory is searched as by Process::SearchReferences
+			if ((*SbrItr)->GetState() != MEM_COMMIT) continue;
+
+			RegionReader Reader(OwnerProc.GetHandle(), (*SbrItr)->GetBase(), (*SbrItr)->GetSize(), 0, REGION_READER_FLAG_SKIP_ZERO_PAGES); // Runs begin on page boundaries and need no overlap for an aligned scan
+
+			while (Reader.Next()) {
+				vector<pair<uint32_t, size_t>> Hits;
+
+				Scanner.FindTargets(Reader.GetData(), Reader.GetSize(), Hits);
+
+				for (vector<pair<uint32_t, size_t>>::const_iterator HitItr = Hits.begin(); HitItr != Hits.end(); ++HitItr) {
+					uint64_t qwTarget = 0;
+
+					memcpy(&qwTarget, Reader.GetData() + HitItr->first, Scanner.GetPointerSize());
+					References.push_back(make_pair(qwTarget, reinterpret_cast<uintptr_t>((*SbrItr)->GetBase()) + Reader.GetOffset() + HitItr->first));
+
+					if (References.size() >= RunSize) {
+						EncodeRun(References, EntityRuns[nIndex]);
+					}
+				}
+			}
+		}
+
+		EncodeRun(References, EntityRuns[nIndex]);
+	});
+
+	// K-way merge of the runs: the heap holds the next reference of each run which has not been exhausted
+
+	struct RunCursor {
+		const uint8_t* Stream;
+		size_t Remaining;
+		uint64_t Target;
+		uint64_t Source;
+	};
+
+	vector<RunCursor> Cursors;
+	vector<Run*> CursorRuns;
+	priority_queue<pair<pair<uint64_t, uint64_t>, size_t>, vector<pair<pair<uint64_t, uint64_t>, size_t>>, greater<pair<pair<uint64_t, uint64_t>, size_t>>> Heads;
+	uint64_t qwPrevTarget = 0, qwPrevSource = 0;
+
+	for (vector<vector<Run>>::iterator EntityItr = EntityRuns.begin(); EntityItr != EntityRuns.end(); ++EntityItr) {
+		for (vector<Run>::iterator RunItr = EntityItr->begin(); RunItr != EntityItr->end(); ++RunItr) {
+			RunCursor NewCursor = { RunItr->Encoded.data(), RunItr->Count - 1, 0, 0 };
+
+			DecodeEntry(&NewCursor.Stream, NewCursor.Target, NewCursor.Source, true);
+			Heads.push(make_pair(make_pair(NewCursor.Target, NewCursor.Source), Cursors.size()));
+			Cursors.push_back(NewCursor);
+			CursorRuns.push_back(&*RunItr);
+		}
+	}
+
+	while (!Heads.empty()) {
+		uint64_t qwTarget = Heads.top().first.first, qwSource = Heads.top().first.second;
+		size_t nCursor = Heads.top().second;
+		RunCursor& Cursor = Cursors[nCursor];
+
+		Heads.pop();
+
+		if (!(this->ReferenceCount % BlockSize)) {
+			Block NewBlock = { qwTarget, this->Encoded.size() };
+			this->Blocks.push_back(NewBlock);
+		}
+
+		EncodeEntry(this->Encoded, qwTarget, qwSource, qwPrevTarget, qwPrevSource, !(this->ReferenceCount % BlockSize));
+		qwPrevTarget = qwTarget;
+		qwPrevSource = qwSource;
+		this->ReferenceCount++;
+
+		if (Cursor.Remaining) {
+			DecodeEntry(&Cursor.Stream, Cursor.Target, Cursor.Source, false);
+			Cursor.Remaining--;
+			Heads.push(make_pair(make_pair(Cursor.Target, Cursor.Source), nCursor));
+		}
+		else {
+			vector<uint8_t>().swap(CursorRuns[nCursor]->Encoded); // Release each run as soon as it has been merged
+		}
+	}
+
+	this->Encoded.shrink_to_fit();
+	Interface::Log(Interface::VerbosityLevel::Debug, "... indexed %Iu references across %Iu committed ranges of PID %d in %Iu bytes\r\n", this->ReferenceCount, Targets.size(), OwnerProc.GetPid(), this->Encoded.size());
+}
+
+void ReferenceIndex::EncodeRun(vector<pair<uint64_t, uint64_t>>& References, vector<Run>& Runs) {
+	Run NewRun;
+
+	if (References.empty()) {
+		return;
+	}
+
+	sort(References.begin(), References.end());
+	NewRun.Count = References.size();
+
+	for (size_t nX = 0; nX < References.size(); nX++) {
+		EncodeEntry(NewRun.Encoded, References[nX].first, References[nX].second, nX ? References[nX - 1].first : 0, nX ? References[nX - 1].second : 0, !nX);
+	}
+
+	NewRun.Encoded.shrink_to_fit();
+	Runs.push_back(move(NewRun));
+	References.clear();
+}
+
+void ReferenceIndex::EncodeEntry(vector<uint8_t>& Stream, uint64_t qwTarget, uint64_t qwSource, uint64_t qwPrevTarget, uint64_t qwPrevSource, bool bFirst) {
+	if (bFirst) {
+		EncodeValue(Stream, qwTarget);
+		EncodeValue(Stream, qwSource);
+	}
+	else {
+		uint64_t qwTargetDelta = qwTarget - qwPrevTarget;
+
+		EncodeValue(Stream, qwTargetDelta);
+		EncodeValue(Stream, qwTargetDelta ? qwSource : qwSource - qwPrevSource); // Sources are ascending for a shared target
+	}
+}
+
+void ReferenceIndex::DecodeEntry(const uint8_t** ppStream, uint64_t& qwTarget, uint64_t& qwSource, bool bFirst) {
+	if (bFirst) {
+		qwTarget = DecodeValue(ppStream);
+		qwSource = DecodeValue(ppStream);
+	}
+	else {
+		uint64_t qwTargetDelta = DecodeValue(ppStream);
+
+		qwTarget += qwTargetDelta;
+		qwSource = (qwTargetDelta ? DecodeValue(ppStream) : qwSource + DecodeValue(ppStream));
+	}
+}
+
+void ReferenceIndex::EncodeValue(vector<uint8_t>& Stream, uint64_t qwValue) {
+	while (qwValue >= 0x80) {
+		Stream.push_back(static_cast<uint8_t>(qwValue | 0x80));
+		qwValue >>= 7;
+	}
+
+	Stream.push_back(static_cast<uint8_t>(qwValue));
+}
+
+uint64_t ReferenceIndex::DecodeValue(const uint8_t** ppStream) {
+	uint64_t qwValue = 0;
+
+	for (uint32_t dwShift = 0;; dwShift += 7) {
+		uint8_t Byte = *(*ppStream)++;
+
+		qwValue |= static_cast<uint64_t>(Byte & 0x7F) << dwShift;
+
+		if (!(Byte & 0x80)) {
+			break;
+		}
+	}
+
+	return qwValue;
+}
+
+size_t ReferenceIndex::Lookup(const uint8_t* pStart, uint32_t dwSize, vector<pair<const uint8_t*, const uint8_t*>>& References) const {
+	uint64_t qwLow = reinterpret_cast<uintptr_t>(pStart), qwHigh = qwLow + (dwSize ? dwSize : 1);
+	size_t nFoundCount = 0;
+
+	if (this->Blocks.empty()) {
+		return 0;
+	}
+
+	vector<Block>::const_iterator BlockItr = lower_bound(this->Blocks.begin(), this->Blocks.end(), qwLow, [](const Block& Left, uint64_t qwRight) { return Left.FirstTarget < qwRight; });
+
+	if (BlockItr != this->Blocks.begin()) {
+		--BlockItr; // References to the start address may begin within the block preceding the first which starts at or after it
+	}
+
+	for (size_t nBlock = BlockItr - this->Blocks.begin(); nBlock < this->Blocks.size() && this->Blocks[nBlock].FirstTarget < qwHigh; nBlock++) {
+		const uint8_t* pStream = this->Encoded.data() + this->Blocks[nBlock].Offset;
+		size_t nEntryCount = min(BlockSize, this->ReferenceCount - nBlock * BlockSize);
+		uint64_t qwTarget = 0, qwSource = 0;
+
+		for (size_t nX = 0; nX < nEntryCount; nX++) {
+			DecodeEntry(&pStream, qwTarget, qwSource, !nX);
+
+			if (qwTarget >= qwHigh) {
+				return nFoundCount;
+			}
+
+			if (qwTarget >= qwLow) {
+				References.push_back(make_pair(reinterpret_cast<const uint8_t*>(qwTarget), reinterpret_cast<const uint8_t*>(qwSource)));
+				nFoundCount++;
+			}
+		}
+	}
+
+	return nFoundCount;
+}
+
+int32_t ReferenceIndex::Search(map <uint8_t*, vector<uint8_t*>>& ReferencesMap, const uint8_t* pReferencedAddress, const uint32_t dwRegionSize, uint32_t dwDepth) const {
+	const RegionTable* Regions = this->OwnerProc.GetRegionTable();
+	vector<pair<const uint8_t*, uint32_t>> Frontier(1, make_pair(pReferencedAddress, dwRegionSize));
+	vector<bool> Visited(Regions->GetCount(), false); // Subregions which have already been selected as referencing, and therefore already queried as targets
+	int32_t nRefTotal = 0;
+
+	for (uint32_t dwLevel = 0; dwLevel < dwDepth && !Frontier.empty(); dwLevel++) {
+		vector<pair<const uint8_t*, uint32_t>> NextFrontier;
+
+		for (vector<pair<const uint8_t*, uint32_t>>::const_iterator FrontItr = Frontier.begin(); FrontItr != Frontier.end(); ++FrontItr) {
+			vector<pair<const uint8_t*, const uint8_t*>> References;
+
+			this->Lookup(FrontItr->first, FrontItr->second, References);
+
+			for (vector<pair<const uint8_t*, const uint8_t*>>::const_iterator RefItr = References.begin(); RefItr != References.end(); ++RefItr) {
+				size_t nRow = Regions->Find(RefItr->second);
+
+				if (nRow == Regions->GetCount() || Visited[nRow]) {
+					continue; // Only the first reference within each subregion is recorded
+				}
+
+				uint8_t* pSubregionBase = Regions->GetBase(nRow);
+
+				Visited[nRow] = true;
+				ReferencesMap[Regions->GetAllocationBase(nRow)].push_back(pSubregionBase); // Entities are keyed by their allocation base
+				NextFrontier.push_back(make_pair(pSubregionBase, static_cast<uint32_t>(Regions->GetSize(nRow))));
+				Interface::Log(Interface::VerbosityLevel::Debug, "... found referenced address 0x%p at 0x%p (offset 0x%08x within 0x%p, depth %d)\r\n", RefItr->first, RefItr->second, static_cast<uint32_t>(RefItr->second - pSubregionBase), pSubregionBase, dwLevel + 1);
+				nRefTotal++;
+			}
+		}
+
+		Frontier.swap(NextFrontier);
+	}
+
+	for (map<uint8_t*, vector<uint8_t*>>::iterator Itr = ReferencesMap.begin(); Itr != ReferencesMap.end(); ++Itr) {
+		sort(Itr->second.begin(), Itr->second.end());
+	}
+
+	return nRefTotal;
+}
@@ -0,0 +1,231 @@
+/*
+__________________________________________________________________________________________
+| _______  _____  __   _ _______ _______ _______                                         |
+| |  |  | |     | | \  | |______    |    |_____|                                         |
+| |  |  | |_____| |  \_| |______    |    |     |                                         |
+|________________________________________________________________________________________|
+| Moneta ~ Usermode memory scanner & malware hunter                                      |
+|----------------------------------------------------------------------------------------|
+| https://www.forrest-orr.net/post/malicious-memory-artifacts-part-ii-bypassing-scanners |
+|----------------------------------------------------------------------------------------|
+| Author: Forrest Orr - 2020                                                             |
+|----------------------------------------------------------------------------------------|
+| Contact: forrest.orr@protonmail.com                                                    |
+|----------------------------------------------------------------------------------------|
+| Licensed under GNU GPLv3                                                               |
+|________________________________________________________________________________________|
+| ## Features                                                                            |
+|                                                                                        |
+| ~ Query the memory attributes of any accessible process(es).                           |
+| ~ Identify private, mapped and image memory.                                           |
+| ~ Correlate regions of memory to their underlying file on disks.                       |
+| ~ Identify PE headers and sections corresponding to image memory.                      |
+| ~ Identify modified regions of mapped image memory.                                    |
+| ~ Identify abnormal memory attributes indicative of malware.                           |
+| ~ Create memory dumps of user-specified memory ranges                                  |
+| ~ Calculate memory permission/type statistics                                          |
+|________________________________________________________________________________________|
+
+*/
+
+#include "StdAfx.h"
+#include "RegionReader.hpp"
+
+using namespace std;
+
+atomic<uint64_t> ReadBufferPool::AllocationCount(0);
+atomic<uint64_t> RegionReader::ZeroPagesSkipped(0);
+atomic<uint64_t> RegionReader::UnreadablePageCount(0);
+
+struct ThreadBufferList { // Frees the buffers pooled by a thread when it exits
+	vector<uint8_t*> Buffers;
+
+	~ThreadBufferList() {
+		for (vector<uint8_t*>::const_iterator Itr = this->Buffers.begin(); Itr != this->Buffers.end(); ++Itr) {
+			VirtualFree(*Itr, 0, MEM_RELEASE);
+		}
+	}
+};
+
+static thread_local ThreadBufferList PooledBuffers;
+
+uint8_t* ReadBufferPool::Acquire() {
+	if (!PooledBuffers.Buffers.empty()) {
+		uint8_t* pBuf = PooledBuffers.Buffers.back();
+		PooledBuffers.Buffers.pop_back();
+		return pBuf;
+	}
+
+	uint8_t* pBuf = static_cast<uint8_t*>(VirtualAlloc(nullptr, BufferSize, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE));
+
+	if (pBuf == nullptr) {
+		throw bad_alloc();
+	}
+
+	AllocationCount++;
+	return pBuf;
+}
+
+void ReadBufferPool::Release(uint8_t* pBuf) {
+	if (pBuf != nullptr) {
+		if (PooledBuffers.Buffers.size() < MaxPooledBuffers) {
+			PooledBuffers.Buffers.push_back(pBuf);
+		}
+		else {
+			VirtualFree(pBuf, 0, MEM_RELEASE);
+		}
+	}
+}
+
+RegionReader::RegionReader(HANDLE hProcess, const void* pBase, size_t cbSize, size_t cbOverlap, uint32_t dwFlags) : ProcessHandle(hProcess), Base(static_cast<const uint8_t*>(pBase)), RegionSize(cbSize), Overlap(cbOverlap), Flags(dwFlags), Buf(ReadBufferPool::Acquire()), Data(nullptr), DataSize(0), DataOffset(0), Carried(0), ChunkOffset(0), ChunkBytes(0), PreviousState(PageState_t::Unreadable), NextPage(0) {
+	assert(cbOverlap < PageSize);
+}
+
+RegionReader::~RegionReader() {
+	ReadBufferPool::Release(this->Buf);
+}
+
+bool RegionReader::IsZeroPage(const uint8_t* pPage, size_t cbSize) {
+	__m128i Accumulator = _mm_setzero_si128();
+	size_t nX = 0;
+
+	for (; nX + 16 <= cbSize; nX += 16) {
+		Accumulator = _mm_or_si128(Accumulator, _mm_loadu_si128(reinterpret_cast<const __m128i*>(pPage + nX)));
+	}
+
+	if (_mm_movemask_epi8(_mm_cmpeq_epi8(Accumulator, _mm_setzero_si128())) != 0xFFFF) {
+		return false;
+	}
+
+	for (; nX < cbSize; nX++) {
+		if (pPage[nX]) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool RegionReader::ReadChunk() {
+	size_t nChunkEnd = this->ChunkOffset + this->ChunkBytes;
+	size_t cbCarry = 0;
+
+	if (nChunkEnd >= this->RegionSize) {
+		return false;
+	}
+
+	if (!this->Pages.empty()) {
+		this->PreviousState = this->Pages.back();
+
+		if (this->PreviousState != PageState_t::Unreadable && this->Overlap) { // Move the tail of the previous chunk to the start of the buffer
+			cbCarry = min(this->Overlap, this->Carried + this->ChunkBytes);
+			memmove(this->Buf, this->Buf + this->Carried + this->ChunkBytes - cbCarry, cbCarry);
+		}
+	}
+
+	this->Carried = cbCarry;
+	this->ChunkOffset = nChunkEnd;
+	this->ChunkBytes = min(static_cast<size_t>(ReadBufferPool::ChunkSize), this->RegionSize - nChunkEnd);
+	this->Pages.assign((this->ChunkBytes + PageSize - 1) / PageSize, PageState_t::Data);
+	this->NextPage = 0;
+
+	// Read the remainder of the chunk in a single call. When this fails, read page by page up to the first page which cannot be read and then attempt the rest
+	// of the chunk in a single call again.
+
+	for (size_t nPage = 0; nPage < this->Pages.size();) {
+		size_t cbRemaining = this->ChunkBytes - nPage * PageSize;
+		SIZE_T cbBytesRead = 0;
+
+		if (ReadProcessMemory(this->ProcessHandle, this->Base + this->ChunkOffset + nPage * PageSize, this->Buf + this->GetPagePosition(nPage), cbRemaining, &cbBytesRead) && cbBytesRead == cbRemaining) {
+			break;
+		}
+
+		for (; nPage < this->Pages.size(); nPage++) {
+			size_t cbPage = this->GetPageEnd(nPage) - this->GetPagePosition(nPage);
+
+			if (!ReadProcessMemory(this->ProcessHandle, this->Base + this->ChunkOffset + nPage * PageSize, this->Buf + this->GetPagePosition(nPage), cbPage, &cbBytesRead) || cbBytesRead != cbPage) {
+				size_t nOffset = this->ChunkOffset + nPage * PageSize;
+
+				if (!this->UnreadableRanges.empty() && this->UnreadableRanges.back().first + this->UnreadableRanges.back().second == nOffset) {
+					this->UnreadableRanges.back().second += cbPage;
+				}
+				else {
+					this->UnreadableRanges.push_back(make_pair(nOffset, cbPage));
+				}
+
+				if ((this->Flags & REGION_READER_FLAG_FILL_UNREADABLE)) {
+					memset(this->Buf + this->GetPagePosition(nPage), 0, cbPage);
+				}
+				else {
+					this->Pages[nPage] = PageState_t::Unreadable;
+				}
+
+				UnreadablePageCount++;
+				nPage++;
+				break;
+			}
+		}
+	}
+
+	if ((this->Flags & REGION_READER_FLAG_SKIP_ZERO_PAGES)) {
+		for (size_t nPage = 0; nPage < this->Pages.size(); nPage++) {
+			if (this->Pages[nPage] == PageState_t::Data && IsZeroPage(this->Buf + this->GetPagePosition(nPage), this->GetPageEnd(nPage) - this->GetPagePosition(nPage))) {
+				this->Pages[nPage] = PageState_t::Zero;
+				ZeroPagesSkipped++;
+			}
+		}
+	}
+
+	return true;
+}
+
+bool RegionReader::Next() {
+	for (;;) {
+		while (this->NextPage < this->Pages.size()) {
+			size_t nPage = this->NextPage, nStart, nEnd;
+
+			if (this->Pages[nPage] == PageState_t::Data) { // A maximal run of data pages, together with the overlap size of any zero pages on either side of it
+				size_t nEndPage = nPage;
+
+				while (nEndPage < this->Pages.size() && this->Pages[nEndPage] == PageState_t::Data) {
+					nEndPage++;
+				}
+
+				if (!nPage) {
+					nStart = 0; // Includes the bytes carried from the previous chunk
+				}
+				else {
+					nStart = this->GetPagePosition(nPage) - (this->Pages[nPage - 1] == PageState_t::Zero ? this->Overlap : 0);
+				}
+
+				nEnd = this->GetPageEnd(nEndPage - 1);
+
+				if (nEndPage < this->Pages.size() && this->Pages[nEndPage] == PageState_t::Zero) {
+					nEnd += min(this->Overlap, this->GetPageEnd(nEndPage) - this->GetPagePosition(nEndPage));
+				}
+
+				this->NextPage = nEndPage;
+			}
+			else if (!nPage && this->Pages[nPage] == PageState_t::Zero && this->PreviousState == PageState_t::Data && this->Carried) { // Bridge the data at the end of the previous chunk into a leading zero page
+				nStart = 0;
+				nEnd = this->Carried + min(this->Overlap, this->GetPageEnd(0) - this->GetPagePosition(0));
+				this->NextPage = 1;
+			}
+			else {
+				this->NextPage++;
+				continue;
+			}
+
+			this->Data = this->Buf + nStart;
+			this->DataSize = nEnd - nStart;
+			this->DataOffset = this->ChunkOffset + nStart - this->Carried;
+			return true;
+		}
+
+		if (!this->ReadChunk()) {
+			this->Data = nullptr;
+			this->DataSize = 0;
+			return false;
+		}
+	}
+}
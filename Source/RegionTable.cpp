@@ -0,0 +1,114 @@
+/*
+__________________________________________________________________________________________
+| _______  _____  __   _ _______ _______ _______                                         |
+| |  |  | |     | | \  | |______    |    |_____|                                         |
+| |  |  | |_____| |  \_| |______    |    |     |                                         |
+|________________________________________________________________________________________|
+| Moneta ~ Usermode memory scanner & malware hunter                                      |
+|----------------------------------------------------------------------------------------|
+| https://www.forrest-orr.net/post/malicious-memory-artifacts-part-ii-bypassing-scanners |
+|----------------------------------------------------------------------------------------|
+| Author: Forrest Orr - 2020                                                             |
+|----------------------------------------------------------------------------------------|
+| Contact: forrest.orr@protonmail.com                                                    |
+|----------------------------------------------------------------------------------------|
+| Licensed under GNU GPLv3                                                               |
+|________________________________________________________________________________________|
+| ## Features                                                                            |
+|                                                                                        |
+| ~ Query the memory attributes of any accessible process(es).                           |
+| ~ Identify private, mapped and image memory.                                           |
+| ~ Correlate regions of memory to their underlying file on disks.                       |
+| ~ Identify PE headers and sections corresponding to image memory.                      |
+| ~ Identify modified regions of mapped image memory.                                    |
+| ~ Identify abnormal memory attributes indicative of malware.                           |
+| ~ Create memory dumps of user-specified memory ranges                                  |
+| ~ Calculate memory permission/type statistics                                          |
+|________________________________________________________________________________________|
+
+*/
+
+#include "StdAfx.h"
+#include "Memory.hpp"
+
+using namespace std;
+using namespace Memory;
+
+size_t RegionTable::Append(const MEMORY_BASIC_INFORMATION& Mbi) {
+	this->Bases.push_back(static_cast<uint8_t*>(Mbi.BaseAddress));
+	this->Sizes.push_back(Mbi.RegionSize);
+	this->AllocationBases.push_back(static_cast<uint8_t*>(Mbi.AllocationBase));
+	this->Protects.push_back(Mbi.Protect);
+	this->AllocationProtects.push_back(Mbi.AllocationProtect);
+	this->Types.push_back(Mbi.Type);
+	this->States.push_back(Mbi.State);
+	this->Flags.push_back(0);
+	this->PrivateSizes.push_back(0);
+	return this->Bases.size() - 1;
+}
+
+MEMORY_BASIC_INFORMATION RegionTable::GetBasic(size_t nIndex) const {
+	MEMORY_BASIC_INFORMATION Mbi = { 0 };
+
+	Mbi.BaseAddress = this->Bases[nIndex];
+	Mbi.RegionSize = this->Sizes[nIndex];
+	Mbi.AllocationBase = this->AllocationBases[nIndex];
+	Mbi.Protect = this->Protects[nIndex];
+	Mbi.AllocationProtect = this->AllocationProtects[nIndex];
+	Mbi.Type = this->Types[nIndex];
+	Mbi.State = this->States[nIndex];
+	return Mbi;
+}
+
+size_t RegionTable::Find(const void* pAddress) const {
+	vector<uint8_t*>::const_iterator Itr = upper_bound(this->Bases.begin(), this->Bases.end(), static_cast<const uint8_t*>(pAddress)); // Rows are appended in address order
+
+	if (Itr != this->Bases.begin()) {
+		size_t nIndex = (Itr - this->Bases.begin()) - 1;
+
+		if (static_cast<const uint8_t*>(pAddress) < this->Bases[nIndex] + this->Sizes[nIndex]) {
+			return nIndex;
+		}
+	}
+
+	return this->Bases.size();
+}
+
+// The scans below are written without branches in their loop bodies over a single column so that the compiler may vectorize them.
+
+void RegionTable::ExecutableMask(size_t nFirst, size_t nCount, uint8_t* pMask) const {
+	assert(pMask != nullptr);
+	assert(nFirst + nCount <= this->Protects.size());
+
+	const uint32_t* pProtects = this->Protects.data() + nFirst;
+
+	for (size_t nX = 0; nX < nCount; nX++) {
+		pMask[nX] = static_cast<uint8_t>((pProtects[nX] == PAGE_EXECUTE) | (pProtects[nX] == PAGE_EXECUTE_READ) | (pProtects[nX] == PAGE_EXECUTE_READWRITE));
+	}
+}
+
+bool RegionTable::AnyExecutable(size_t nFirst, size_t nCount) const {
+	assert(nFirst + nCount <= this->Protects.size());
+
+	const uint32_t* pProtects = this->Protects.data() + nFirst;
+	uint32_t dwAny = 0;
+
+	for (size_t nX = 0; nX < nCount; nX++) {
+		dwAny |= (pProtects[nX] == PAGE_EXECUTE_READ) | (pProtects[nX] == PAGE_EXECUTE_READWRITE); // Matches the historical definition of a partially executable entity, which excludes PAGE_EXECUTE
+	}
+
+	return dwAny ? true : false;
+}
+
+bool RegionTable::AnyFlag(size_t nFirst, size_t nCount, uint64_t qwFlag) const {
+	assert(nFirst + nCount <= this->Flags.size());
+
+	const uint64_t* pFlags = this->Flags.data() + nFirst;
+	uint64_t qwAny = 0;
+
+	for (size_t nX = 0; nX < nCount; nX++) {
+		qwAny |= pFlags[nX];
+	}
+
+	return (qwAny & qwFlag) ? true : false;
+}
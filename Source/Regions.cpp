@@ -36,11 +36,14 @@ ________________________________________________________________________________
 #include "Interface.hpp"
 #include "MemDump.hpp"
 #include "Signing.h"
+#include "PeImageCache.hpp"
+#include "Arena.hpp"
+#include "LoaderList.hpp"
 
 using namespace std;
 using namespace Memory;
 
-PeVm::Body::Body(Processes::Process& OwnerProc, vector<Subregion*> Subregions, const wchar_t* FilePath) : Region(OwnerProc.GetHandle(), Subregions), PeVm::Component(OwnerProc.GetHandle(), Subregions, static_cast<uint8_t *>((Subregions.front())->GetBasic()->BaseAddress)), MappedFile(OwnerProc.GetHandle(), Subregions, FilePath, false), PebMod(OwnerProc.GetHandle(), this->PeData) {
+PeVm::Body::Body(Processes::Process& OwnerProc, vector<Subregion*> Subregions, const wchar_t* FilePath) : Region(OwnerProc.GetHandle(), Subregions), PeVm::Component(OwnerProc.GetHandle(), Subregions, static_cast<uint8_t *>((Subregions.front())->GetBase())), MappedFile(OwnerProc.GetHandle(), Subregions, FilePath, false), PebMod(OwnerProc.GetLoaderList(), this->PeData) {
 	static NtQueryVirtualMemory_t NtQueryVirtualMemory = reinterpret_cast<NtQueryVirtualMemory_t>(GetProcAddress(GetModuleHandleW(L"ntdll.dll"), "NtQueryVirtualMemory"));
 	MEMORY_IMAGE_INFORMATION Mii = { 0 };
 	NTSTATUS NtStatus = NtQueryVirtualMemory(OwnerProc.GetHandle(), this->PeData, MemoryImageInformation, &Mii, sizeof(MEMORY_IMAGE_INFORMATION), nullptr);
@@ -58,44 +61,43 @@ PeVm::Body::Body(Processes::Process& OwnerProc, vector<Subregion*> Subregions, c
 	}
 
 	if (!this->GetFileBase()->IsPhantom()) {
-		this->Signed = CheckSigning(FilePath);
-
-		if ((this->FilePe = PeFile::Load(FilePath)) != nullptr) {
-			// Identify which subregions within this parent entity overlap with each section header. Create an entity child object for each section and copy associated subregions into it.
-
-			for (int32_t nX = -1; nX < this->FilePe->GetFileHdr()->NumberOfSections; nX++) {
-				IMAGE_SECTION_HEADER ArtificialPeHdr = { 0 }; // This will initialize other relevant fields such as VirtualAddress to 0 for the PE header edge case.
-
-				if (nX == -1) {
-					strcpy_s(reinterpret_cast<char*>(ArtificialPeHdr.Name), sizeof(ArtificialPeHdr.Name), "Header");
-					ArtificialPeHdr.SizeOfRawData = this->FilePe->GetSectHdrs()->VirtualAddress; // Consider the size of the PE headers to be all data leading up to the start of the first real section.
-				}
-				else {
-					memcpy(&ArtificialPeHdr, (this->FilePe->GetSectHdrs() + nX), sizeof(IMAGE_SECTION_HEADER));
+		this->Signed = SigningCache::Check(FilePath); // Modules shared by many processes are verified once per scan
+
+		if ((this->Image = PeImageCache::Load(FilePath)) != nullptr) { // The headers of a module mapped into many processes are read and parsed once per scan
+			// Identify which subregions within this parent entity overlap with each section header. Each section is a view over the range of overlapping subregions of this entity.
+			// The overlaps are calculated with a single merge of the section RVAs against the (address ordered) subregions of this entity. Sections are visited in RVA order:
+			// the first subregion which could overlap a section can then only move forward.
+
+			const vector<PeImage::SectionExtent>& SectExtents = this->Image->GetSections();
+			const vector<size_t>& RvaOrder = this->Image->GetRvaOrder();
+			vector<pair<size_t, size_t>> OverlapRanges(SectExtents.size(), make_pair(0, 0));
+			size_t nLowSbr = 0;
+
+			for (vector<size_t>::const_iterator OrderItr = RvaOrder.begin(); OrderItr != RvaOrder.end(); ++OrderItr) {
+				const PeImage::SectionExtent& Extent = SectExtents[*OrderItr];
+				uint8_t* pSectStartVa = this->PeData + Extent.Hdr.VirtualAddress;
+				uint8_t* pSectEndVa = this->PeData + Extent.Hdr.VirtualAddress + Extent.Size;
+				size_t nHighSbr;
+
+				while (nLowSbr < Subregions.size() && (static_cast<uint8_t*>(Subregions[nLowSbr]->GetBase()) + Subregions[nLowSbr]->GetSize()) <= pSectStartVa) {
+					nLowSbr++;
 				}
 
-				//uint32_t dwSectionSize = (ArtificialPeHdr.SizeOfRawData == 0 ? ArtificialPeHdr.Misc.VirtualSize : ArtificialPeHdr.SizeOfRawData);
-				uint32_t dwSectionSize = (ArtificialPeHdr.SizeOfRawData < ArtificialPeHdr.Misc.VirtualSize ? ArtificialPeHdr.Misc.VirtualSize : ArtificialPeHdr.SizeOfRawData); // .data sections will sometimes have a non-zero raw data where the virtual size is still larger than the raw size (copy-on-write)
-				uint8_t* pSectStartVa = this->PeData + ArtificialPeHdr.VirtualAddress;
-				uint8_t* pSectEndVa = this->PeData + ArtificialPeHdr.VirtualAddress + dwSectionSize;
+				for (nHighSbr = nLowSbr; nHighSbr < Subregions.size() && static_cast<uint8_t*>(Subregions[nHighSbr]->GetBase()) < pSectEndVa; nHighSbr++) {
+					Interface::Log(Interface::VerbosityLevel::Debug, "... section %s [0x%p:0x%p] corresponds to subregion [0x%p:0x%p]\r\n", Extent.Hdr.Name, pSectStartVa, pSectEndVa, Subregions[nHighSbr]->GetBase(), static_cast<uint8_t*>(Subregions[nHighSbr]->GetBase()) + Subregions[nHighSbr]->GetSize());
+				}
 
-				// Calculate the subregions overlapping between this PE entity and the current section.
+				OverlapRanges[*OrderItr] = make_pair(nLowSbr, nHighSbr - nLowSbr);
+			}
 
-				vector<Subregion*> OverlapSubregion;
+			this->SubregionSections.resize(Subregions.size());
 
-				for (vector<Subregion*>::const_iterator SbrItr = Subregions.begin(); SbrItr != Subregions.end(); ++SbrItr) {
-					uint8_t* pSubregionStartVa = static_cast<uint8_t *>((*SbrItr)->GetBasic()->BaseAddress);
-					uint8_t* pSubregionEndVa = static_cast<uint8_t *>((*SbrItr)->GetBasic()->BaseAddress) + (*SbrItr)->GetBasic()->RegionSize;
+			for (size_t nX = 0; nX < SectExtents.size(); nX++) {
+				this->Sections.push_back(Section(this, &SectExtents[nX].Hdr, SectExtents[nX].Size, OverlapRanges[nX].first, OverlapRanges[nX].second));
 
-					if ((pSubregionStartVa >= pSectStartVa && pSubregionStartVa < pSectEndVa) || (pSubregionEndVa > pSectStartVa&& pSubregionEndVa <= pSectEndVa) || (pSubregionStartVa < pSectStartVa && pSubregionEndVa > pSectEndVa)) {
-						Interface::Log(Interface::VerbosityLevel::Debug, "... section %s [0x%p:0x%p] corresponds to subregion [0x%p:0x%p]\r\n", ArtificialPeHdr.Name, pSectStartVa, pSectEndVa, pSubregionStartVa, pSubregionEndVa);
-						MEMORY_BASIC_INFORMATION* Mbi = new MEMORY_BASIC_INFORMATION; // When duplicating subregions, all heap allocated memory must be cloned so that no addresses are double referenced/double freed
-						memcpy(Mbi, (*SbrItr)->GetBasic(), sizeof(MEMORY_BASIC_INFORMATION));
-						OverlapSubregion.push_back(new Subregion(OwnerProc, Mbi));
-					}
+				for (size_t nSbrIndex = OverlapRanges[nX].first; nSbrIndex < OverlapRanges[nX].first + OverlapRanges[nX].second; nSbrIndex++) {
+					this->SubregionSections[nSbrIndex].push_back(nX);
 				}
-
-				this->Sections.push_back(new Section(OwnerProc.GetHandle(), OverlapSubregion, &ArtificialPeHdr, this->PeData));
 			}
 		}
 		else {
@@ -104,35 +106,28 @@ PeVm::Body::Body(Processes::Process& OwnerProc, vector<Subregion*> Subregions, c
 	}
 }
 
-PeVm::Body::~Body() {
-	for (vector<Section*>::const_iterator Itr = this->Sections.begin(); Itr != this->Sections.end(); ++Itr) {
-		delete* Itr;
-	}
+PeVm::Body::~Body() {}
 
-	if (this->FilePe != nullptr) {
-		delete this->FilePe;
-	}
+const PeFile* PeVm::Body::GetPeFile() const {
+	return (this->Image != nullptr ? this->Image->GetPe() : nullptr);
 }
 
-PeVm::Section* PeVm::Body::GetSection(string Name) const {
-	for (vector<Section*>::const_iterator SectItr = this->Sections.begin(); SectItr != this->Sections.end(); ++SectItr) {
-		if (_stricmp(reinterpret_cast<const char *>((*SectItr)->GetHeader()->Name), Name.c_str()) == 0) {
-			return *SectItr;
+const PeVm::Section* PeVm::Body::GetSection(string Name) const {
+	for (vector<Section>::const_iterator SectItr = this->Sections.begin(); SectItr != this->Sections.end(); ++SectItr) {
+		if (_stricmp(reinterpret_cast<const char *>(SectItr->GetHeader()->Name), Name.c_str()) == 0) {
+			return &*SectItr;
 		}
 	}
 
 	return nullptr;
 }
 
-vector<PeVm::Section*> PeVm::Body::FindOverlapSect(Subregion& Address) {
-	vector<PeVm::Section*> OverlappingSections;
+vector<const PeVm::Section*> PeVm::Body::FindOverlapSect(size_t nSubregionIndex) const {
+	vector<const PeVm::Section*> OverlappingSections;
 
-	for (vector<Section*>::const_iterator SectItr = this->Sections.begin(); SectItr != this->Sections.end(); ++SectItr) {
-		vector<Subregion*> SbrVec = (*SectItr)->GetSubregions();
-		for (vector<Subregion*>::const_iterator SbrItr = SbrVec.begin(); SbrItr != SbrVec.end(); ++SbrItr) {
-			if (Address.GetBasic()->BaseAddress == (*SbrItr)->GetBasic()->BaseAddress) {
-				OverlappingSections.push_back(*SectItr);
-			}
+	if (nSubregionIndex < this->SubregionSections.size()) { // The overlap of each subregion was calculated when the body was constructed
+		for (vector<size_t>::const_iterator Itr = this->SubregionSections[nSubregionIndex].begin(); Itr != this->SubregionSections[nSubregionIndex].end(); ++Itr) {
+			OverlappingSections.push_back(&this->Sections[*Itr]);
 		}
 	}
 
@@ -147,32 +142,35 @@ Signing_t PeVm::Body::GetSisningType() const {
 	return this->Signed;
 }
 
-PeVm::Body::PebModule::PebModule(HANDLE hProcess, const uint8_t* pModBase) {
-	if (hProcess != nullptr) {
-		if (GetModuleInformation(hProcess, reinterpret_cast<HMODULE>(const_cast<uint8_t *>(pModBase)), &this->Info, sizeof(this->Info))) {
-			wchar_t ModuleName[MAX_PATH + 1] = { 0 }, ModulePath[MAX_PATH + 1] = { 0 };
-
-			if (GetModuleBaseNameW(hProcess, reinterpret_cast<HMODULE>(const_cast<uint8_t*>(pModBase)), ModuleName, MAX_PATH + 1)) {
-				this->Name = ModuleName;
-			}
-
-			if (GetModuleFileNameExW(hProcess, reinterpret_cast<HMODULE>(const_cast<uint8_t*>(pModBase)), ModulePath, MAX_PATH + 1)) {
-				this->Path = ModulePath;
-			}
+PeVm::Body::PebModule::PebModule(const Processes::LoaderList* Loader, const uint8_t* pModBase) : Info(), Missing(true) {
+	if (Loader != nullptr) {
+		const Processes::LoaderList::Module* LoaderMod = Loader->Find(pModBase); // The loader list of the process was walked once when it was opened
 
+		if (LoaderMod != nullptr) {
+			this->Info.lpBaseOfDll = reinterpret_cast<void*>(static_cast<uintptr_t>(LoaderMod->Base));
+			this->Info.EntryPoint = reinterpret_cast<void*>(static_cast<uintptr_t>(LoaderMod->EntryPoint));
+			this->Info.SizeOfImage = LoaderMod->ImageSize;
+			this->Name = LoaderMod->Name;
+			this->Path = LoaderMod->Path;
 			this->Missing = false;
 		}
-		else {
-			this->Missing = true;
-		}
 	}
 }
 
 PeVm::Component::Component(HANDLE hProcess, std::vector<Subregion*> Subregions, uint8_t* pPeBuf) : Region(hProcess, Subregions), PeData(pPeBuf) {}
 
-PeVm::Section::Section(HANDLE hProcess, vector<Subregion*> Subregions, IMAGE_SECTION_HEADER* SectHdr, uint8_t* pPeBuf) : Region(hProcess, Subregions), PeVm::Component(hProcess, Subregions, pPeBuf) {
-	memcpy(&this->Hdr, SectHdr, sizeof(IMAGE_SECTION_HEADER));
-	this->EntitySize = this->Hdr.SizeOfRawData < this->Hdr.Misc.VirtualSize ? this->Hdr.Misc.VirtualSize : this->Hdr.SizeOfRawData; // Overwrite default size determined by subregions. Verified correct order.
+PeVm::Section::Section(const Body* Parent, const IMAGE_SECTION_HEADER* SectHdr, uint32_t dwSectionSize, size_t nFirstSubregion, size_t nSubregionCount) : Parent(Parent), Hdr(SectHdr), FirstSubregion(nFirstSubregion), SubregionCount(nSubregionCount), SectionSize(dwSectionSize) {}
+
+vector<Subregion*> PeVm::Section::GetSubregions() const {
+	return vector<Subregion*>(this->Parent->Subregions.begin() + this->FirstSubregion, this->Parent->Subregions.begin() + this->FirstSubregion + this->SubregionCount);
+}
+
+const void* PeVm::Section::GetStartVa() const {
+	if (this->SubregionCount) {
+		return this->Parent->Subregions[this->FirstSubregion]->GetBase();
+	}
+
+	return this->Parent->GetDataPe() + this->Hdr->VirtualAddress; // No subregion of the body overlaps this section (for example a partially mapped image)
 }
 
 MappedFile::MappedFile(HANDLE hProcess, vector<Subregion*> Subregions, const wchar_t* FilePath, bool bMemStore) : Region(hProcess, Subregions), MapFileBase(new FileBase(FilePath, bMemStore, false)) {}
@@ -188,18 +186,18 @@ Region::Region(HANDLE hProcess, vector<Subregion*> Subregions) {
 Entity* Entity::Create(Processes::Process& OwnerProc, std::vector<Subregion*> Subregions) {
 	Entity* NewEntity = nullptr;
 
-	if (Subregions.front()->GetBasic()->Type == MEM_MAPPED || Subregions.front()->GetBasic()->Type == MEM_IMAGE) {
+	if (Subregions.front()->GetMemoryType() == MEM_MAPPED || Subregions.front()->GetMemoryType() == MEM_IMAGE) {
 		wchar_t DevFilePath[MAX_PATH + 1] = { 0 };
 		wchar_t MapFilePath[MAX_PATH + 1] = { 0 };
 
-		if (GetMappedFileNameW(OwnerProc.GetHandle(), static_cast<HMODULE>(Subregions.front()->GetBasic()->BaseAddress), DevFilePath, MAX_PATH)) {
+		if (GetMappedFileNameW(OwnerProc.GetHandle(), static_cast<HMODULE>(Subregions.front()->GetBase()), DevFilePath, MAX_PATH)) {
 			if (!FileBase::TranslateDevicePath(DevFilePath, MapFilePath)) {
 				Interface::Log(Interface::VerbosityLevel::Debug, "! Failed to translate device path: %ws\r\n", DevFilePath);
 				wcscpy_s(MapFilePath, MAX_PATH + 1, L"?");
 			}
 		}
 		else {
-			if (Subregions.front()->GetBasic()->Type == MEM_MAPPED) {
+			if (Subregions.front()->GetMemoryType() == MEM_MAPPED) {
 				wcscpy_s(MapFilePath, MAX_PATH + 1, L"Page File");
 			}
 			else {
@@ -207,42 +205,26 @@ Entity* Entity::Create(Processes::Process& OwnerProc, std::vector<Subregion*> Su
 			}
 		}
 
-		if (Subregions.front()->GetBasic()->Type == MEM_MAPPED) {
-			NewEntity = new MappedFile(OwnerProc.GetHandle(), Subregions, MapFilePath);
+		if (Subregions.front()->GetMemoryType() == MEM_MAPPED) {
+			NewEntity = OwnerProc.GetArena()->New<MappedFile>(OwnerProc.GetHandle(), Subregions, MapFilePath);
 		}
-		else if (Subregions.front()->GetBasic()->Type == MEM_IMAGE) {
-			NewEntity = new PeVm::Body(OwnerProc, Subregions, MapFilePath);
+		else if (Subregions.front()->GetMemoryType() == MEM_IMAGE) {
+			NewEntity = OwnerProc.GetArena()->New<PeVm::Body>(OwnerProc, Subregions, MapFilePath);
 		}
 	}
 	else {
-		NewEntity = new Region(OwnerProc.GetHandle(), Subregions);
+		NewEntity = OwnerProc.GetArena()->New<Region>(OwnerProc.GetHandle(), Subregions);
 	}
 
 	return NewEntity;
 }
 
-bool Entity::IsPartiallyExecutable() const {
-	vector<Subregion*> Subregions = this->GetSubregions(); // This must be done explicitly, otherwise each time GetSubregions is called a temporary copy of the list is created and the begin/end iterators will become useless in identifying the end of the list, causing an exception as it loops out of bounds.
-
-	for (vector<Subregion*>::iterator SbrItr = Subregions.begin(); SbrItr != Subregions.end(); ++SbrItr) {
-		if ((*SbrItr)->GetBasic()->Protect == PAGE_EXECUTE_READ || (*SbrItr)->GetBasic()->Protect == PAGE_EXECUTE_READWRITE) {
-			return true;
-		}
-	}
-
-	return false;
+bool Entity::IsPartiallyExecutable() const { // The subregions of an entity are consecutive rows of the region table of its process, allowing the protection column to be scanned directly
+	return this->Subregions.front()->GetTable()->AnyExecutable(this->Subregions.front()->GetIndex(), this->Subregions.size());
 }
 
 bool Entity::ContainsFlag(uint64_t qwFlag) const {
-	vector<Subregion*> Subregions = this->GetSubregions();
-
-	for (vector<Subregion*>::iterator SbrItr = Subregions.begin(); SbrItr != Subregions.end(); ++SbrItr) {
-		if (((*SbrItr)->GetFlags() & qwFlag)) {
-			return true;
-		}
-	}
-
-	return false;
+	return this->Subregions.front()->GetTable()->AnyFlag(this->Subregions.front()->GetIndex(), this->Subregions.size(), qwFlag);
 }
 
 bool Entity::Dump(MemDump& DmpCtx) const {
@@ -250,12 +232,14 @@ bool Entity::Dump(MemDump& DmpCtx) const {
 	wchar_t DumpFolder[MAX_PATH + 1] = { 0 };
 	int32_t nDumpCount = 0;
 
-	swprintf_s(DumpFolder, MAX_PATH + 1, L"%d_%p_%ws", DmpCtx.GetPid(), this->GetStartVa(), Subregion::TypeSymbol(Subregions.front()->GetBasic()->Type));
+	swprintf_s(DumpFolder, MAX_PATH + 1, L"%d_%p_%ws", DmpCtx.GetPid(), this->GetStartVa(), Subregion::TypeSymbol(Subregions.front()->GetMemoryType()));
 
 	for (vector<Subregion*>::iterator SbrItr = Subregions.begin(); SbrItr != Subregions.end(); ++SbrItr) {
-		if ((*SbrItr)->GetBasic()->State == MEM_COMMIT) {
+		if ((*SbrItr)->GetState() == MEM_COMMIT) {
+			MEMORY_BASIC_INFORMATION Mbi = (*SbrItr)->GetBasic();
 			wchar_t DumpFilePath[MAX_PATH + 1] = { 0 };
-			if (DmpCtx.Create(DumpFolder, (*SbrItr)->GetBasic(), DumpFilePath, MAX_PATH + 1)) {
+
+			if (DmpCtx.Create(DumpFolder, &Mbi, DumpFilePath, MAX_PATH + 1)) {
 				nDumpCount++;
 			}
 		}
@@ -264,15 +248,11 @@ bool Entity::Dump(MemDump& DmpCtx) const {
 	return nDumpCount ? true : false;
 }
 
-Entity::~Entity() {
-	for (vector<Subregion*>::const_iterator Itr = this->Subregions.begin(); Itr != this->Subregions.end(); ++Itr) {
-		delete* Itr;
-	}
-}
+Entity::~Entity() {} // Subregions are owned by the arena of the owner process
 
 void Entity::SetSubregions(vector<Subregion*> Subregions) {
 	this->Subregions = Subregions;
-	this->StartVa = static_cast<uint8_t *>((Subregions.front())->GetBasic()->BaseAddress);
-	this->EndVa = (static_cast<uint8_t *>((Subregions.back())->GetBasic()->BaseAddress) + (Subregions.back())->GetBasic()->RegionSize);
-	this->EntitySize = (static_cast<uint8_t *>((Subregions.back())->GetBasic()->BaseAddress) + (Subregions.back())->GetBasic()->RegionSize) - (Subregions.front())->GetBasic()->BaseAddress;
+	this->StartVa = static_cast<uint8_t *>((Subregions.front())->GetBase());
+	this->EndVa = (static_cast<uint8_t *>((Subregions.back())->GetBase()) + (Subregions.back())->GetSize());
+	this->EntitySize = (static_cast<uint8_t *>((Subregions.back())->GetBase()) + (Subregions.back())->GetSize()) - (Subregions.front())->GetBase();
 }
\ No newline at end of file
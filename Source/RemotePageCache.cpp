@@ -0,0 +1,143 @@
+/*
+__________________________________________________________________________________________
+| _______  _____  __   _ _______ _______ _______                                         |
+| |  |  | |     | | \  | |______    |    |_____|                                         |
+| |  |  | |_____| |  \_| |______    |    |     |                                         |
+|________________________________________________________________________________________|
+| Moneta ~ Usermode memory scanner & malware hunter                                      |
+|----------------------------------------------------------------------------------------|
+| https://www.forrest-orr.net/post/malicious-memory-artifacts-part-ii-bypassing-scanners |
+|----------------------------------------------------------------------------------------|
+| Author: Forrest Orr - 2020                                                             |
+|----------------------------------------------------------------------------------------|
+| Contact: forrest.orr@protonmail.com                                                    |
+|----------------------------------------------------------------------------------------|
+| Licensed under GNU GPLv3                                                               |
+|________________________________________________________________________________________|
+| ## Features                                                                            |
+|                                                                                        |
+| ~ Query the memory attributes of any accessible process(es).                           |
+| ~ Identify private, mapped and image memory.                                           |
+| ~ Correlate regions of memory to their underlying file on disks.                       |
+| ~ Identify PE headers and sections corresponding to image memory.                      |
+| ~ Identify modified regions of mapped image memory.                                    |
+| ~ Identify abnormal memory attributes indicative of malware.                           |
+| ~ Create memory dumps of user-specified memory ranges                                  |
+| ~ Calculate memory permission/type statistics                                          |
+|________________________________________________________________________________________|
+
+*/
+
+#include "StdAfx.h"
+#include "RemotePageCache.hpp"
+
+using namespace std;
+using namespace Processes;
+
+atomic<uint64_t> RemotePageCache::HitCount(0);
+atomic<uint64_t> RemotePageCache::MissCount(0);
+atomic<uint64_t> RemotePageCache::ReadCount(0);
+atomic<uint64_t> RemotePageCache::SyscallCount(0);
+
+RemotePageCache::RemotePageCache(HANDLE hProcess) : ProcessHandle(hProcess) {}
+
+void RemotePageCache::Clear() {
+	lock_guard<mutex> Guard(this->Lock);
+	this->Pages.clear();
+}
+
+bool RemotePageCache::FetchPages(uintptr_t qwFirstPage, size_t nPageCount) {
+	unique_ptr<uint8_t[]> RunBuf = make_unique<uint8_t[]>(nPageCount * PageSize);
+	SIZE_T cbBytesRead = 0;
+
+	MissCount += nPageCount;
+	SyscallCount++;
+
+	if (ReadProcessMemory(this->ProcessHandle, reinterpret_cast<void*>(qwFirstPage), RunBuf.get(), nPageCount * PageSize, &cbBytesRead) && cbBytesRead == nPageCount * PageSize) {
+		for (size_t nPage = 0; nPage < nPageCount; nPage++) {
+			unique_ptr<uint8_t[]> PageBuf = make_unique<uint8_t[]>(PageSize);
+			memcpy(PageBuf.get(), RunBuf.get() + nPage * PageSize, PageSize);
+			this->Pages[qwFirstPage + nPage * PageSize] = move(PageBuf);
+		}
+
+		return true;
+	}
+
+	// At least one page of the run could not be read: read each page on its own so that the readable ones are still cached. Pages which fail are cached as null
+	// so that they are not read again.
+
+	for (size_t nPage = 0; nPage < nPageCount; nPage++) {
+		unique_ptr<uint8_t[]> PageBuf = make_unique<uint8_t[]>(PageSize);
+
+		SyscallCount++;
+
+		if (ReadProcessMemory(this->ProcessHandle, reinterpret_cast<void*>(qwFirstPage + nPage * PageSize), PageBuf.get(), PageSize, &cbBytesRead) && cbBytesRead == PageSize) {
+			this->Pages[qwFirstPage + nPage * PageSize] = move(PageBuf);
+		}
+		else {
+			this->Pages[qwFirstPage + nPage * PageSize] = nullptr;
+		}
+	}
+
+	return false;
+}
+
+bool RemotePageCache::Read(const void* pAddress, void* pBuf, size_t cbSize) {
+	uintptr_t qwAddress = reinterpret_cast<uintptr_t>(pAddress);
+	uintptr_t qwFirstPage = qwAddress & ~(static_cast<uintptr_t>(PageSize) - 1);
+	size_t nPageCount = (qwAddress + cbSize - qwFirstPage + PageSize - 1) / PageSize;
+
+	ReadCount++;
+
+	if (!cbSize) {
+		return true;
+	}
+
+	if (nPageCount > MaxCoalescedPages) {
+		SIZE_T cbBytesRead = 0;
+
+		SyscallCount++;
+		return ReadProcessMemory(this->ProcessHandle, pAddress, pBuf, cbSize, &cbBytesRead) && cbBytesRead == cbSize;
+	}
+
+	lock_guard<mutex> Guard(this->Lock);
+
+	if (this->Pages.size() + nPageCount > MaxCachedPages) {
+		this->Pages.clear();
+	}
+
+	for (size_t nPage = 0; nPage < nPageCount;) { // Each run of missing pages is fetched in a single call
+		if (this->Pages.count(qwFirstPage + nPage * PageSize)) {
+			HitCount++;
+			nPage++;
+		}
+		else {
+			size_t nRunEnd = nPage + 1;
+
+			while (nRunEnd < nPageCount && !this->Pages.count(qwFirstPage + nRunEnd * PageSize)) {
+				nRunEnd++;
+			}
+
+			this->FetchPages(qwFirstPage + nPage * PageSize, nRunEnd - nPage);
+			nPage = nRunEnd;
+		}
+	}
+
+	uint8_t* pDestination = static_cast<uint8_t*>(pBuf);
+
+	for (uintptr_t qwCurrent = qwAddress; qwCurrent < qwAddress + cbSize;) {
+		uintptr_t qwPage = qwCurrent & ~(static_cast<uintptr_t>(PageSize) - 1);
+		size_t cbCopy = min(static_cast<size_t>(qwPage + PageSize - qwCurrent), static_cast<size_t>(qwAddress + cbSize - qwCurrent));
+		unordered_map<uintptr_t, unique_ptr<uint8_t[]>>::const_iterator PageItr = this->Pages.find(qwPage);
+
+		if (PageItr == this->Pages.end() || PageItr->second == nullptr) {
+			return false;
+		}
+
+		memcpy(pDestination, PageItr->second.get() + (qwCurrent - qwPage), cbCopy);
+		pDestination += cbCopy;
+		qwCurrent += cbCopy;
+	}
+
+	return true;
+}
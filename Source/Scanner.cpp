@@ -0,0 +1,127 @@
+/*
+__________________________________________________________________________________________
+| _______  _____  __   _ _______ _______ _______                                         |
+| |  |  | |     | | \  | |______    |    |_____|                                         |
+| |  |  | |_____| |  \_| |______    |    |     |                                         |
+|________________________________________________________________________________________|
+| Moneta ~ Usermode memory scanner & malware hunter                                      |
+|----------------------------------------------------------------------------------------|
+| https://www.forrest-orr.net/post/malicious-memory-artifacts-part-ii-bypassing-scanners |
+|----------------------------------------------------------------------------------------|
+| Author: Forrest Orr - 2020                                                             |
+|----------------------------------------------------------------------------------------|
+| Contact: forrest.orr@protonmail.com                                                    |
+|----------------------------------------------------------------------------------------|
+| Licensed under GNU GPLv3                                                               |
+|________________________________________________________________________________________|
+| ## Features                                                                            |
+|                                                                                        |
+| ~ Query the memory attributes of any accessible process(es).                           |
+| ~ Identify private, mapped and image memory.                                           |
+| ~ Correlate regions of memory to their underlying file on disks.                       |
+| ~ Identify PE headers and sections corresponding to image memory.                      |
+| ~ Identify modified regions of mapped image memory.                                    |
+| ~ Identify abnormal memory attributes indicative of malware.                           |
+| ~ Create memory dumps of user-specified memory ranges                                  |
+| ~ Calculate memory permission/type statistics                                          |
+|________________________________________________________________________________________|
+
+*/
+
+#include "StdAfx.h"
+#include "Processes.hpp"
+#include "Memory.hpp"
+#include "Interface.hpp"
+#include "LoaderList.hpp"
+#include "Ioc.hpp"
+#include "Scanner.hpp"
+#include "Statistics.hpp"
+#include "TaskPool.hpp"
+
+using namespace std;
+using namespace Memory;
+using namespace Processes;
+
+struct ProcessScanner::ScanSlot {
+	uint32_t Pid;
+	PermissionRecord* PermissionRecords;
+	IocRecord* IocRecords;
+};
+
+ProcessScanner::ProcessScanner(ScannerContext& ScannerCtx, const SystemSnapshot& Snapshot) : ScannerCtx(ScannerCtx), Snapshot(Snapshot), PermissionRecords(nullptr), IocRecords(nullptr) {}
+
+ProcessScanner::~ProcessScanner() {
+	delete this->PermissionRecords;
+	delete this->IocRecords;
+}
+
+void ProcessScanner::ScanTarget(ScanSlot& Slot) {
+	try {
+		Process TargetProc(Slot.Pid, this->Snapshot);
+		vector<Ioc*> SelectedIocs;
+		vector<Subregion*> SelectedSbrs;
+
+		TargetProc.Enumerate(this->ScannerCtx, &SelectedIocs, &SelectedSbrs);
+
+		if ((this->ScannerCtx.GetFlags() & PROCESS_ENUM_FLAG_STATISTICS)) { // Records are built privately per process and merged once the scan of every process is complete
+			Slot.PermissionRecords = new PermissionRecord(SelectedSbrs);
+			Slot.IocRecords = new IocRecord(&SelectedIocs);
+		}
+	}
+	catch (int32_t nError) {
+		const SystemSnapshot::ProcessEntry* SnapshotEntry = this->Snapshot.GetProcess(Slot.Pid);
+		Interface::Log(Interface::VerbosityLevel::Debug, "... failed to map address space of %d:%ws (error %d)\r\n", Slot.Pid, SnapshotEntry != nullptr ? SnapshotEntry->Name.c_str() : L"?", nError);
+	}
+	catch (...) {
+		const SystemSnapshot::ProcessEntry* SnapshotEntry = this->Snapshot.GetProcess(Slot.Pid);
+		Interface::Log(Interface::VerbosityLevel::Debug, "... scan of %d:%ws failed with an exception\r\n", Slot.Pid, SnapshotEntry != nullptr ? SnapshotEntry->Name.c_str() : L"?");
+		throw; // Reported by the scan once the remaining processes have been scanned
+	}
+}
+
+void ProcessScanner::MergeRecords(ScanSlot& Slot) {
+	if (Slot.PermissionRecords != nullptr) {
+		if (this->PermissionRecords == nullptr) {
+			this->PermissionRecords = Slot.PermissionRecords;
+		}
+		else {
+			this->PermissionRecords->Merge(*Slot.PermissionRecords);
+			delete Slot.PermissionRecords;
+		}
+
+		Slot.PermissionRecords = nullptr;
+	}
+
+	if (Slot.IocRecords != nullptr) {
+		if (this->IocRecords == nullptr) {
+			this->IocRecords = Slot.IocRecords;
+		}
+		else {
+			this->IocRecords->Merge(*Slot.IocRecords);
+			delete Slot.IocRecords;
+		}
+
+		Slot.IocRecords = nullptr;
+	}
+}
+
+void ProcessScanner::Scan(const vector<uint32_t>& Targets) {
+	vector<unique_ptr<ScanSlot>> Slots;
+
+	for (vector<uint32_t>::const_iterator Itr = Targets.begin(); Itr != Targets.end(); ++Itr) {
+		unique_ptr<ScanSlot> Slot = make_unique<ScanSlot>();
+		Slot->Pid = *Itr;
+		Slot->PermissionRecords = nullptr;
+		Slot->IocRecords = nullptr;
+		Slots.push_back(move(Slot));
+	}
+
+	// Each process is mapped and enumerated as a task on the shared pool when it has workers. Large processes split their own entity construction and inspection
+	// into subtasks on the same pool. Output is written and records merged in target list order, so the output is identical to that of a serial scan.
+
+	if (TaskPool::GetWorkerCount() && Slots.size() > 1) {
+		Interface::Log(Interface::VerbosityLevel::Debug, "... scanning %Iu processes with %d threads\r\n", Slots.size(), TaskPool::GetWorkerCount() + 1);
+	}
+
+	TaskPool::OrderedFor(Slots.size(), [this, &Slots](size_t nIndex) { this->ScanTarget(*Slots[nIndex]); }, [this, &Slots](size_t nIndex) { this->MergeRecords(*Slots[nIndex]); });
+}
@@ -30,6 +30,9 @@ ________________________________________________________________________________
 
 #include "StdAfx.h"
 #include "Signing.h"
+#include "SigningStore.hpp"
+#include "CatalogIndex.hpp"
+#include "Authenticode.hpp"
 
 using namespace std;
 
@@ -43,6 +46,12 @@ bool VerifyEmbeddedSignature(const wchar_t *FilePath) {
     WINTRUST_FILE_INFO FileData = { 0 };
     GUID WVTPolicyGUID = WINTRUST_ACTION_GENERIC_VERIFY_V2;
     WINTRUST_DATA WinTrustData = { 0 };
+    AuthenticodeSignature Signature;
+
+    switch (Authenticode::CheckFile(FilePath, Signature)) {
+        case AuthenticodeStatus_t::Unsigned: return false; // Without a certificate table WinVerifyTrust would reject the file as well, so the costly policy check is skipped
+        default: break; // A digest mismatch is still left to WinVerifyTrust, whose digest is the one that counts
+    }
 
     FileData.cbStruct = sizeof(WINTRUST_FILE_INFO);
     FileData.pcwszFilePath = FilePath;
@@ -154,10 +163,49 @@ wchar_t* GetPeCatalogIssuer(const wchar_t* FilePath) {
     return CertIssuerStr;
 }
 
+static bool CalcCatalogHash(const wchar_t* FilePath, HashAlgorithm_t Algorithm, vector<uint8_t>& Hash) { // The catalog hash of a PE is its Authenticode digest: the catalog admin API is only needed for other file types
+	HCATADMIN hCatalogContext = nullptr;
+	HANDLE hFile;
+	uint32_t dwHashSize = 32;
+	bool bCalculated = false;
+
+	if (Authenticode::HashFile(FilePath, Algorithm, Hash)) {
+		return true;
+	}
+
+	if ((hFile = CreateFileW(FilePath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, 0, nullptr)) != INVALID_HANDLE_VALUE) {
+		Hash.resize(dwHashSize);
+
+		if (Algorithm == HashAlgorithm_t::Sha1) {
+			bCalculated = CryptCATAdminCalcHashFromFileHandle(hFile, reinterpret_cast<PDWORD>(&dwHashSize), Hash.data(), 0) ? true : false;
+		}
+		else if (CryptCATAdminAcquireContext2(&hCatalogContext, nullptr, BCRYPT_SHA256_ALGORITHM, nullptr, 0)) {
+			bCalculated = CryptCATAdminCalcHashFromFileHandle2(hCatalogContext, hFile, reinterpret_cast<PDWORD>(&dwHashSize), Hash.data(), 0) ? true : false;
+			CryptCATAdminReleaseContext(hCatalogContext, 0);
+		}
+
+		Hash.resize(bCalculated ? dwHashSize : 0);
+		CloseHandle(hFile);
+	}
+
+	return bCalculated;
+}
+
 bool VerifyCatalogSignature(const wchar_t* FilePath) {
+	const CatalogIndex& Index = CatalogIndex::GetSystemIndex();
     wchar_t* CertIssuer;
 
-    if ((CertIssuer = GetPeCatalogIssuer(FilePath)) != nullptr) {
+	if (Index.GetMemberCount()) { // Every catalog in the store has already been indexed: the file is catalog signed if either its SHA1 or SHA256 Authenticode hash is a member
+		vector<uint8_t> Hash;
+
+		if (CalcCatalogHash(FilePath, HashAlgorithm_t::Sha1, Hash) && Index.Find(Hash.data(), Hash.size()) != nullptr) {
+			return true;
+		}
+
+		return (Index.HasDigestSize(32) && CalcCatalogHash(FilePath, HashAlgorithm_t::Sha256, Hash) && Index.Find(Hash.data(), Hash.size()) != nullptr);
+	}
+
+    if ((CertIssuer = GetPeCatalogIssuer(FilePath)) != nullptr) { // The catalog store could not be indexed
         delete[] CertIssuer;
 		return true;
     }
@@ -179,6 +227,75 @@ Signing_t CheckSigning(const wchar_t* TargetFilePath) {
     }
 }
 
+map<FileIdentity, shared_future<Signing_t>> SigningCache::Results;
+mutex SigningCache::Lock;
+atomic<uint64_t> SigningCache::HitCount(0);
+atomic<uint64_t> SigningCache::MissCount(0);
+
+bool FileIdentity::Query(const wchar_t* FilePath, FileIdentity& Identity) {
+	HANDLE hFile = CreateFileW(FilePath, FILE_READ_ATTRIBUTES, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, 0, nullptr);
+	BY_HANDLE_FILE_INFORMATION FileInfo = { 0 };
+	bool bQueried = false;
+
+	if (hFile != INVALID_HANDLE_VALUE) {
+		if (GetFileInformationByHandle(hFile, &FileInfo)) {
+			Identity.VolumeSerial = FileInfo.dwVolumeSerialNumber;
+			Identity.FileId = (static_cast<uint64_t>(FileInfo.nFileIndexHigh) << 32) | FileInfo.nFileIndexLow;
+			Identity.LastWriteTime = (static_cast<uint64_t>(FileInfo.ftLastWriteTime.dwHighDateTime) << 32) | FileInfo.ftLastWriteTime.dwLowDateTime;
+			Identity.FileSize = (static_cast<uint64_t>(FileInfo.nFileSizeHigh) << 32) | FileInfo.nFileSizeLow;
+			bQueried = true;
+		}
+
+		CloseHandle(hFile);
+	}
+
+	return bQueried;
+}
+
+Signing_t SigningCache::Check(const wchar_t* FilePath) {
+	FileIdentity Identity = { 0 };
+	promise<Signing_t> Verification;
+
+	if (!FileIdentity::Query(FilePath, Identity)) { // Without an identity the result cannot safely be shared
+		MissCount++;
+		return CheckSigning(FilePath);
+	}
+
+	unique_lock<mutex> Guard(SigningCache::Lock);
+	map<FileIdentity, shared_future<Signing_t>>::const_iterator ResultItr = Results.find(Identity);
+
+	if (ResultItr != Results.end()) {
+		shared_future<Signing_t> Result = ResultItr->second;
+
+		Guard.unlock();
+		HitCount++;
+		return Result.get(); // Waits if the file is still being verified by another thread
+	}
+
+	Results.insert(make_pair(Identity, Verification.get_future().share()));
+	Guard.unlock();
+	MissCount++;
+
+	Signing_t Signed;
+
+	try {
+		if (!SigningStore::Lookup(Identity, Signed)) { // The verdict of an unchanged file may have been stored by a previous run
+			Signed = CheckSigning(FilePath);
+			SigningStore::Store(Identity, Signed);
+		}
+	}
+	catch (...) { // The threads waiting on this verification receive the same exception rather than a broken promise, and the entry is dropped so that later checks retry
+		Guard.lock();
+		Results.erase(Identity);
+		Guard.unlock();
+		Verification.set_exception(current_exception());
+		throw;
+	}
+
+	Verification.set_value(Signed);
+	return Signed;
+}
+
 const wchar_t* TranslateSigningLevel(uint32_t dwSigningLevel) {
     switch (dwSigningLevel) {
         case 0: return L"Unchecked";
@@ -0,0 +1,155 @@
+/*
+__________________________________________________________________________________________
+| _______  _____  __   _ _______ _______ _______                                         |
+| |  |  | |     | | \  | |______    |    |_____|                                         |
+| |  |  | |_____| |  \_| |______    |    |     |                                         |
+|________________________________________________________________________________________|
+| Moneta ~ Usermode memory scanner & malware hunter                                      |
+|----------------------------------------------------------------------------------------|
+| https://www.forrest-orr.net/post/malicious-memory-artifacts-part-ii-bypassing-scanners |
+|----------------------------------------------------------------------------------------|
+| Author: Forrest Orr - 2020                                                             |
+|----------------------------------------------------------------------------------------|
+| Contact: forrest.orr@protonmail.com                                                    |
+|----------------------------------------------------------------------------------------|
+| Licensed under GNU GPLv3                                                               |
+|________________________________________________________________________________________|
+| ## Features                                                                            |
+|                                                                                        |
+| ~ Query the memory attributes of any accessible process(es).                           |
+| ~ Identify private, mapped and image memory.                                           |
+| ~ Correlate regions of memory to their underlying file on disks.                       |
+| ~ Identify PE headers and sections corresponding to image memory.                      |
+| ~ Identify modified regions of mapped image memory.                                    |
+| ~ Identify abnormal memory attributes indicative of malware.                           |
+| ~ Create memory dumps of user-specified memory ranges                                  |
+| ~ Calculate memory permission/type statistics                                          |
+|________________________________________________________________________________________|
+
+*/
+
+#include "StdAfx.h"
+#include "Signing.h"
+#include "SigningStore.hpp"
+
+using namespace std;
+
+HANDLE SigningStore::FileHandle = INVALID_HANDLE_VALUE;
+HANDLE SigningStore::MappingHandle = nullptr;
+SigningStore::Header* SigningStore::StoreHdr = nullptr;
+SigningStore::Record* SigningStore::Records = nullptr;
+mutex SigningStore::Lock;
+atomic<uint64_t> SigningStore::HitCount(0);
+atomic<uint64_t> SigningStore::StoreCount(0);
+
+bool SigningStore::Open(const wchar_t* FilePath) {
+	uint32_t dwStoreSize = sizeof(Header) + SlotCount * sizeof(Record);
+
+	assert(!IsOpen());
+
+	if ((FileHandle = CreateFileW(FilePath, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr)) != INVALID_HANDLE_VALUE) {
+		if ((MappingHandle = CreateFileMappingW(FileHandle, nullptr, PAGE_READWRITE, 0, dwStoreSize, nullptr)) != nullptr) { // A new or short file is extended with zeros to the size of the store
+			if ((StoreHdr = static_cast<Header*>(MapViewOfFile(MappingHandle, FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, dwStoreSize))) != nullptr) {
+				Records = reinterpret_cast<Record*>(StoreHdr + 1);
+
+				if (StoreHdr->Signature != StoreSignature || StoreHdr->Version != StoreVersion || StoreHdr->SlotCount != SlotCount) { // A new store, or one written by a different version
+					memset(StoreHdr, 0, dwStoreSize);
+					StoreHdr->Signature = StoreSignature;
+					StoreHdr->Version = StoreVersion;
+					StoreHdr->SlotCount = SlotCount;
+				}
+
+				return true;
+			}
+
+			CloseHandle(MappingHandle);
+			MappingHandle = nullptr;
+		}
+
+		CloseHandle(FileHandle);
+		FileHandle = INVALID_HANDLE_VALUE;
+	}
+
+	return false;
+}
+
+void SigningStore::Close() {
+	lock_guard<mutex> Guard(SigningStore::Lock);
+
+	if (StoreHdr != nullptr) {
+		FlushViewOfFile(StoreHdr, 0);
+		UnmapViewOfFile(StoreHdr);
+		StoreHdr = nullptr;
+		Records = nullptr;
+	}
+
+	if (MappingHandle != nullptr) {
+		CloseHandle(MappingHandle);
+		MappingHandle = nullptr;
+	}
+
+	if (FileHandle != INVALID_HANDLE_VALUE) {
+		CloseHandle(FileHandle);
+		FileHandle = INVALID_HANDLE_VALUE;
+	}
+}
+
+uint32_t SigningStore::Hash(const FileIdentity& Identity) {
+	uint64_t qwHash = 0xCBF29CE484222325; // FNV-1a over the volume serial and file ID
+	uint64_t Values[2] = { Identity.VolumeSerial, Identity.FileId };
+	const uint8_t* pBytes = reinterpret_cast<const uint8_t*>(Values);
+
+	for (size_t nX = 0; nX < sizeof(Values); nX++) {
+		qwHash = (qwHash ^ pBytes[nX]) * 0x100000001B3;
+	}
+
+	return static_cast<uint32_t>(qwHash ^ (qwHash >> 32));
+}
+
+bool SigningStore::Lookup(const FileIdentity& Identity, Signing_t& Signed) {
+	lock_guard<mutex> Guard(SigningStore::Lock);
+
+	if (Records != nullptr) {
+		uint32_t dwSlot = Hash(Identity) % SlotCount;
+
+		for (uint32_t dwProbe = 0; dwProbe < MaxProbes; dwProbe++, dwSlot = (dwSlot + 1) % SlotCount) {
+			const Record& Current = Records[dwSlot];
+
+			if (!Current.Occupied) {
+				break;
+			}
+
+			if (Current.Identity.VolumeSerial == Identity.VolumeSerial && Current.Identity.FileId == Identity.FileId) {
+				if (Current.Identity.LastWriteTime == Identity.LastWriteTime && Current.Identity.FileSize == Identity.FileSize) {
+					Signed = static_cast<Signing_t>(Current.Signed);
+					HitCount++;
+					return true;
+				}
+
+				break; // The file has changed since its verdict was stored
+			}
+		}
+	}
+
+	return false;
+}
+
+void SigningStore::Store(const FileIdentity& Identity, Signing_t Signed) {
+	lock_guard<mutex> Guard(SigningStore::Lock);
+
+	if (Records != nullptr) {
+		uint32_t dwSlot = Hash(Identity) % SlotCount;
+
+		for (uint32_t dwProbe = 0; dwProbe < MaxProbes; dwProbe++, dwSlot = (dwSlot + 1) % SlotCount) {
+			Record& Current = Records[dwSlot];
+
+			if (!Current.Occupied || (Current.Identity.VolumeSerial == Identity.VolumeSerial && Current.Identity.FileId == Identity.FileId)) {
+				Current.Identity = Identity;
+				Current.Signed = static_cast<uint32_t>(Signed);
+				Current.Occupied = 1;
+				StoreCount++;
+				break;
+			}
+		}
+	}
+}
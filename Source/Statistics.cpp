@@ -31,6 +31,7 @@ ________________________________________________________________________________
 #include "StdAfx.h"
 #include "Memory.hpp"
 #include "Interface.hpp"
+#include "LoaderList.hpp"
 #include "Ioc.hpp"
 #include "Statistics.hpp"
 
@@ -39,11 +40,11 @@ using namespace Memory;
 
 void PermissionRecord::UpdateMap(vector<Subregion*> SubregionRecords) {
 	for (vector<Subregion*>::const_iterator RecordItr = SubregionRecords.begin(); RecordItr != SubregionRecords.end(); ++RecordItr) {
-		if (!PermissionMap->count((*RecordItr)->GetBasic()->Type)) {
-			PermissionMap->insert(make_pair((*RecordItr)->GetBasic()->Type, map<uint32_t, uint32_t>()));
+		if (!PermissionMap->count((*RecordItr)->GetMemoryType())) {
+			PermissionMap->insert(make_pair((*RecordItr)->GetMemoryType(), map<uint32_t, uint32_t>()));
 		}
 
-		map<uint32_t, uint32_t>& CountMap = PermissionMap->at((*RecordItr)->GetBasic()->Type);
+		map<uint32_t, uint32_t>& CountMap = PermissionMap->at((*RecordItr)->GetMemoryType());
 		uint32_t PagePermissions[] = {
 			PAGE_READONLY,
 			PAGE_READWRITE,
@@ -60,7 +61,7 @@ void PermissionRecord::UpdateMap(vector<Subregion*> SubregionRecords) {
 				CountMap.insert(make_pair(PagePermissions[dwX], 0));
 			}
 
-			if (((*RecordItr)->GetBasic()->Protect & PagePermissions[dwX])) {
+			if (((*RecordItr)->GetProtect() & PagePermissions[dwX])) {
 				CountMap[PagePermissions[dwX]]++;
 				this->TotalRegions++;
 			}
@@ -68,10 +69,26 @@ void PermissionRecord::UpdateMap(vector<Subregion*> SubregionRecords) {
 	}
 }
 
-PermissionRecord::PermissionRecord(vector<Subregion*> SubregionRecords) : PermissionMap(new map<uint32_t, map<uint32_t, uint32_t>>()) {
+PermissionRecord::PermissionRecord(vector<Subregion*> SubregionRecords) : PermissionMap(new map<uint32_t, map<uint32_t, uint32_t>>()), TotalRegions(0) {
 	UpdateMap(SubregionRecords);
 }
 
+PermissionRecord::~PermissionRecord() {
+	delete this->PermissionMap;
+}
+
+void PermissionRecord::Merge(const PermissionRecord& Records) {
+	for (map<uint32_t, map<uint32_t, uint32_t>>::const_iterator Itr = Records.PermissionMap->begin(); Itr != Records.PermissionMap->end(); ++Itr) {
+		map<uint32_t, uint32_t>& CountMap = (*this->PermissionMap)[Itr->first];
+
+		for (map<uint32_t, uint32_t>::const_iterator Itr2 = Itr->second.begin(); Itr2 != Itr->second.end(); ++Itr2) {
+			CountMap[Itr2->first] += Itr2->second;
+		}
+	}
+
+	this->TotalRegions += Records.TotalRegions;
+}
+
 void PermissionRecord::ShowRecords() const {
 	Interface::Log(Interface::VerbosityLevel::Surface, "\r\nMemory statistics\r\n");
 	for (map<uint32_t, map<uint32_t, uint32_t>>::const_iterator Itr = PermissionMap->begin(); Itr != PermissionMap->end(); ++Itr) {
@@ -157,6 +174,18 @@ void IocRecord::UpdateMap(vector<Ioc*>* Records) {
 	}
 }
 
-IocRecord::IocRecord(vector<Ioc*>* Records) : RecordMap(new map<uint32_t, uint32_t>()) {
+IocRecord::IocRecord(vector<Ioc*>* Records) : RecordMap(new map<uint32_t, uint32_t>()), TotalIoc(0) {
 	this->UpdateMap(Records);
+}
+
+IocRecord::~IocRecord() {
+	delete this->RecordMap;
+}
+
+void IocRecord::Merge(const IocRecord& Records) {
+	for (map<uint32_t, uint32_t>::const_iterator Itr = Records.RecordMap->begin(); Itr != Records.RecordMap->end(); ++Itr) {
+		(*this->RecordMap)[Itr->first] += Itr->second;
+	}
+
+	this->TotalIoc += Records.TotalIoc;
 }
\ No newline at end of file
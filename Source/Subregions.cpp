@@ -37,46 +37,19 @@ using namespace std;
 using namespace Memory;
 using namespace Processes;
 
-Subregion::Subregion(Processes::Process &OwnerProc, const MEMORY_BASIC_INFORMATION* Mbi) : ProcessHandle(OwnerProc.GetHandle()), Basic(Mbi) {
-	vector<Processes::Thread*> Threads = OwnerProc.GetThreads();
-	vector<void*> Heaps = OwnerProc.GetHeaps();
+atomic<uint64_t> Subregion::ThreadOpensSaved(0);
+static WorkingSetProvider DefaultPageProvider;
+PageAttributeProvider* Subregion::PageProvider = &DefaultPageProvider;
 
-	for (vector<Processes::Thread*>::const_iterator ThItr = Threads.begin(); ThItr != Threads.end(); ++ThItr) {
-		if ((*ThItr)->GetEntryPoint() >= this->Basic->BaseAddress && (*ThItr)->GetEntryPoint() < (static_cast<uint8_t *>(this->Basic->BaseAddress) + this->Basic->RegionSize)) {
-			this->Threads.push_back(new Processes::Thread((*ThItr)->GetTid(), OwnerProc));
-		}
-
-		if ((*ThItr)->GetStackAddress() >= this->Basic->BaseAddress && (*ThItr)->GetStackAddress() < (static_cast<uint8_t*>(this->Basic->BaseAddress) + this->Basic->RegionSize)) {
-			this->Flags |= MEMORY_SUBREGION_FLAG_STACK;
-		}
-
-		if ((*ThItr)->GetTebAddress() >= this->Basic->BaseAddress && (*ThItr)->GetTebAddress() < (static_cast<uint8_t*>(this->Basic->BaseAddress) + this->Basic->RegionSize)) {
-			this->Flags |= MEMORY_SUBREGION_FLAG_TEB;
-		}
-	}
-
-	if (OwnerProc.GetImageBase() >= this->Basic->BaseAddress && OwnerProc.GetImageBase() < (static_cast<uint8_t*>(this->Basic->BaseAddress) + this->Basic->RegionSize)) {
-		this->Flags |= MEMORY_SUBREGION_FLAG_BASE_IMAGE;
-	}
-
-	if (find(Heaps.begin(), Heaps.end(), Mbi->BaseAddress) != Heaps.end()) {
-		this->Flags |= MEMORY_SUBREGION_FLAG_HEAP;
-	}
+Subregion::Subregion(Processes::Process &OwnerProc, RegionTable* Table, size_t nIndex, const vector<Processes::Thread*>& Threads) : Table(Table), Index(nIndex), Threads(Threads), ProcessHandle(OwnerProc.GetHandle()) { // Flags and threads are attributed by the address index of the owner process
+	ThreadOpensSaved += Threads.size();
 
-	if (Mbi->State == MEM_COMMIT && Mbi->Type != MEM_PRIVATE) {
-		this->PrivateSize = this->QueryPrivateSize(); // Querying the working set is one of the greatest performance drains in the tool and should be done sparingly
+	if (this->GetState() == MEM_COMMIT && this->GetMemoryType() != MEM_PRIVATE) {
+		this->QueryPrivatePages(); // Querying the working set is one of the greatest performance drains in the tool and should be done sparingly
 	}
 }
 
-Subregion::~Subregion() {
-	if (this->Basic != nullptr) {
-		delete Basic;
-	}
-
-	for (vector<Processes::Thread*>::const_iterator Itr = this->Threads.begin(); Itr != this->Threads.end(); ++Itr) {
-		delete* Itr;
-	}
-}
+Subregion::~Subregion() {}
 
 const wchar_t* Subregion::ProtectSymbol(uint32_t dwProtect) {
 	switch (dwProtect) {
@@ -124,26 +97,33 @@ const wchar_t* Subregion::TypeSymbol(uint32_t dwType) {
 	}
 }
 
-uint32_t Subregion::QueryPrivateSize() const {
-	uint32_t dwPrivateSize = 0;
+bool Subregion::QueryPrivatePages() {
+	if (this->GetState() == MEM_COMMIT && this->GetProtect() != PAGE_NOACCESS && this->GetMemoryType() == MEM_IMAGE) { // Optimize performance by skipping working set scan for non-image memory, as this data is not valuable for private and mapped types.
+		size_t nPageCount = this->GetSize() / 0x1000;
+		unique_ptr<PSAPI_WORKING_SET_EX_INFORMATION[]> WorkingSets = make_unique<PSAPI_WORKING_SET_EX_INFORMATION[]>(nPageCount); // Every page of the subregion is queried in a single call
 
-	if (this->Basic->State == MEM_COMMIT && this->Basic->Protect != PAGE_NOACCESS && this->Basic->Type == MEM_IMAGE) { // Optimize performance by skipping working set scan for non-image memory, as this data is not valuable for private and mapped types.
-		PSAPI_WORKING_SET_EX_INFORMATION WorkingSets = { 0 };
+		for (size_t nX = 0; nX < nPageCount; nX++) {
+			WorkingSets[nX].VirtualAddress = (static_cast<uint8_t *>(this->GetBase()) + (nX * 0x1000));
+		}
 
-		for (uint32_t dwPageOffset = 0; dwPageOffset < this->Basic->RegionSize; dwPageOffset += 0x1000) {
-			WorkingSets.VirtualAddress = (static_cast<uint8_t *>(this->Basic->BaseAddress) + dwPageOffset);
-			if (K32QueryWorkingSetEx(this->ProcessHandle, &WorkingSets, sizeof(PSAPI_WORKING_SET_EX_INFORMATION))) {
-				if (!WorkingSets.VirtualAttributes.Shared) {
-					dwPrivateSize += 0x1000;
+		this->PrivatePages.Resize(nPageCount);
+
+		if (PageProvider->Query(this->ProcessHandle, WorkingSets.get(), nPageCount)) {
+			for (size_t nX = 0; nX < nPageCount; nX++) {
+				if (!WorkingSets[nX].VirtualAttributes.Shared) {
+					this->PrivatePages.Set(nX);
 				}
 			}
-			else {
-				Interface::Log(Interface::VerbosityLevel::Debug, "... failed to query working set at 0x%p\r\n", WorkingSets.VirtualAddress);
-			}
+
+			this->Table->SetPrivateSize(this->Index, static_cast<uint32_t>(this->PrivatePages.Count() * 0x1000));
+			return true;
+		}
+		else {
+			Interface::Log(Interface::VerbosityLevel::Debug, "... failed to query working set at 0x%p\r\n", this->GetBase());
 		}
 	}
 
-	return dwPrivateSize;
+	return false;
 }
 
 bool Subregion::PageExecutable(uint32_t dwProtect) {
@@ -0,0 +1,111 @@
+/*
+__________________________________________________________________________________________
+| _______  _____  __   _ _______ _______ _______                                         |
+| |  |  | |     | | \  | |______    |    |_____|                                         |
+| |  |  | |_____| |  \_| |______    |    |     |                                         |
+|________________________________________________________________________________________|
+| Moneta ~ Usermode memory scanner & malware hunter                                      |
+|----------------------------------------------------------------------------------------|
+| https://www.forrest-orr.net/post/malicious-memory-artifacts-part-ii-bypassing-scanners |
+|----------------------------------------------------------------------------------------|
+| Author: Forrest Orr - 2020                                                             |
+|----------------------------------------------------------------------------------------|
+| Contact: forrest.orr@protonmail.com                                                    |
+|----------------------------------------------------------------------------------------|
+| Licensed under GNU GPLv3                                                               |
+|________________________________________________________________________________________|
+| ## Features                                                                            |
+|                                                                                        |
+| ~ Query the memory attributes of any accessible process(es).                           |
+| ~ Identify private, mapped and image memory.                                           |
+| ~ Correlate regions of memory to their underlying file on disks.                       |
+| ~ Identify PE headers and sections corresponding to image memory.                      |
+| ~ Identify modified regions of mapped image memory.                                    |
+| ~ Identify abnormal memory attributes indicative of malware.                           |
+| ~ Create memory dumps of user-specified memory ranges                                  |
+| ~ Calculate memory permission/type statistics                                          |
+|________________________________________________________________________________________|
+
+*/
+
+#include "StdAfx.h"
+#include "FileIo.hpp"
+#include "Interface.hpp"
+#include "Processes.hpp"
+
+using namespace std;
+using namespace Processes;
+
+bool SystemSnapshot::Capture() {
+	static NtQuerySystemInformation_t NtQuerySystemInformation = reinterpret_cast<NtQuerySystemInformation_t>(GetProcAddress(GetModuleHandleW(L"ntdll.dll"), "NtQuerySystemInformation"));
+	vector<uint8_t> InfoBuf;
+	ULONG dwReturnLength = 0x40000;
+	NTSTATUS NtStatus;
+
+	// The process and thread lists may grow between the sizing query and the next attempt: keep some headroom and retry until the whole list fits.
+
+	do {
+		InfoBuf.resize(dwReturnLength + 0x10000);
+		NtStatus = NtQuerySystemInformation(SystemProcessInformation, InfoBuf.data(), static_cast<ULONG>(InfoBuf.size()), &dwReturnLength);
+	} while (NtStatus == STATUS_INFO_LENGTH_MISMATCH);
+
+	if (!NT_SUCCESS(NtStatus)) {
+		Interface::Log(Interface::VerbosityLevel::Debug, "... NtQuerySystemInformation failed for process information (0x%08x)\r\n", NtStatus);
+		return false;
+	}
+
+	this->Entries.clear();
+	this->Pids.clear();
+	this->ThreadCount = 0;
+
+	for (uint8_t* pEntry = InfoBuf.data();;) {
+		SYSTEM_PROCESS_INFORMATION* pProcInfo = reinterpret_cast<SYSTEM_PROCESS_INFORMATION*>(pEntry);
+		SYSTEM_THREAD_INFORMATION* pThreadInfo = reinterpret_cast<SYSTEM_THREAD_INFORMATION*>(pProcInfo + 1); // Thread records immediately follow the process record
+		ProcessEntry Entry;
+
+		Entry.Pid = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(pProcInfo->UniqueProcessId));
+
+		if (pProcInfo->ImageName.Buffer != nullptr) {
+			Entry.Name = wstring(pProcInfo->ImageName.Buffer, pProcInfo->ImageName.Length / sizeof(wchar_t));
+		}
+
+		for (ULONG dwX = 0; dwX < pProcInfo->NumberOfThreads; dwX++) {
+			Entry.Tids.push_back(static_cast<uint32_t>(reinterpret_cast<uintptr_t>(pThreadInfo[dwX].ClientId.UniqueThread)));
+		}
+
+		// The image path is queried by PID rather than through a process handle, so it is available even for processes which cannot be opened.
+
+		SYSTEM_PROCESS_ID_INFORMATION ProcIdInfo = { 0 };
+		wchar_t DevFilePath[MAX_PATH + 1] = { 0 };
+
+		ProcIdInfo.ProcessId = pProcInfo->UniqueProcessId;
+		ProcIdInfo.ImageName.Buffer = DevFilePath;
+		ProcIdInfo.ImageName.MaximumLength = sizeof(DevFilePath) - sizeof(wchar_t);
+
+		if (Entry.Pid && NT_SUCCESS(NtQuerySystemInformation(SystemProcessIdInformation, &ProcIdInfo, sizeof(ProcIdInfo), nullptr))) {
+			wchar_t ImageFilePath[MAX_PATH + 1] = { 0 };
+
+			if (FileBase::TranslateDevicePath(DevFilePath, ImageFilePath)) {
+				Entry.ImageFilePath = wstring(ImageFilePath);
+			}
+		}
+
+		this->ThreadCount += Entry.Tids.size();
+		this->Pids.push_back(Entry.Pid);
+		this->Entries.insert(make_pair(Entry.Pid, Entry));
+
+		if (!pProcInfo->NextEntryOffset) {
+			break;
+		}
+
+		pEntry += pProcInfo->NextEntryOffset;
+	}
+
+	Interface::Log(Interface::VerbosityLevel::Debug, "... captured system snapshot of %Iu processes and %Iu threads\r\n", this->Entries.size(), this->ThreadCount);
+	return true;
+}
+
+const SystemSnapshot::ProcessEntry* SystemSnapshot::GetProcess(uint32_t dwPid) const {
+	map<uint32_t, ProcessEntry>::const_iterator Itr = this->Entries.find(dwPid);
+	return (Itr != this->Entries.end() ? &Itr->second : nullptr);
+}
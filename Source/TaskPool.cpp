@@ -0,0 +1,380 @@
+/*
+__________________________________________________________________________________________
+| _______  _____  __   _ _______ _______ _______                                         |
+| |  |  | |     | | \  | |______    |    |_____|                                         |
+| |  |  | |_____| |  \_| |______    |    |     |                                         |
+|________________________________________________________________________________________|
+| Moneta ~ Usermode memory scanner & malware hunter                                      |
+|----------------------------------------------------------------------------------------|
+| https://www.forrest-orr.net/post/malicious-memory-artifacts-part-ii-bypassing-scanners |
+|----------------------------------------------------------------------------------------|
+| Author: Forrest Orr - 2020                                                             |
+|----------------------------------------------------------------------------------------|
+| Contact: forrest.orr@protonmail.com                                                    |
+|----------------------------------------------------------------------------------------|
+| Licensed under GNU GPLv3                                                               |
+|________________________________________________________________________________________|
+| ## Features                                                                            |
+|                                                                                        |
+| ~ Query the memory attributes of any accessible process(es).                           |
+| ~ Identify private, mapped and image memory.                                           |
+| ~ Correlate regions of memory to their underlying file on disks.                       |
+| ~ Identify PE headers and sections corresponding to image memory.                      |
+| ~ Identify modified regions of mapped image memory.                                    |
+| ~ Identify abnormal memory attributes indicative of malware.                           |
+| ~ Create memory dumps of user-specified memory ranges                                  |
+| ~ Calculate memory permission/type statistics                                          |
+|________________________________________________________________________________________|
+
+*/
+
+#include "StdAfx.h"
+#include "Interface.hpp"
+#include "TaskPool.hpp"
+#include "Privileges.h"
+
+using namespace std;
+
+vector<unique_ptr<TaskPool::Worker>> TaskPool::Workers;
+vector<thread> TaskPool::Threads;
+deque<TaskPool::Task> TaskPool::Injected;
+mutex TaskPool::InjectedLock;
+mutex TaskPool::IdleLock;
+condition_variable TaskPool::IdleSignal;
+atomic<uint64_t> TaskPool::Pending(0);
+atomic<bool> TaskPool::Stopping(false);
+thread_local int32_t TaskPool::CurrentWorker = -1;
+thread_local int32_t TaskPool::CurrentDepth = 0;
+
+void TaskPool::Initialize(uint32_t dwWorkerCount) {
+	for (uint32_t dwX = 0; dwX < dwWorkerCount; dwX++) {
+		unique_ptr<Worker> NewWorker = make_unique<Worker>();
+		NewWorker->Executed = 0;
+		NewWorker->Stolen = 0;
+		TaskPool::Workers.push_back(move(NewWorker));
+	}
+
+	for (uint32_t dwX = 0; dwX < dwWorkerCount; dwX++) { // All worker deques must exist before any worker may attempt to steal from them
+		TaskPool::Threads.push_back(thread(TaskPool::WorkerMain, dwX));
+	}
+
+	Interface::Log(Interface::VerbosityLevel::Debug, "... initialized task pool with %d worker threads\r\n", dwWorkerCount);
+}
+
+void TaskPool::Shutdown() {
+	TaskPool::Stopping = true;
+	TaskPool::Signal();
+
+	for (vector<thread>::iterator Itr = TaskPool::Threads.begin(); Itr != TaskPool::Threads.end(); ++Itr) {
+		Itr->join();
+	}
+
+	for (size_t nX = 0; nX < TaskPool::Workers.size(); nX++) {
+		Interface::Log(Interface::VerbosityLevel::Debug, "... worker %d executed %I64u tasks (%I64u stolen)\r\n", nX, TaskPool::Workers[nX]->Executed, TaskPool::Workers[nX]->Stolen);
+	}
+
+	TaskPool::Threads.clear();
+	TaskPool::Workers.clear();
+	TaskPool::Stopping = false;
+}
+
+uint32_t TaskPool::GetWorkerCount() {
+	return static_cast<uint32_t>(TaskPool::Workers.size());
+}
+
+void TaskPool::Signal() {
+	lock_guard<mutex> Guard(TaskPool::IdleLock); // Taking the lock closes the window between an idle thread evaluating its wait predicate and blocking
+	TaskPool::IdleSignal.notify_all();
+}
+
+void TaskPool::Push(Task& NewTask) {
+	TaskPool::Pending++; // Counted ahead of the push so that the count never drops below the number of queued tasks
+
+	if (TaskPool::CurrentWorker != -1) {
+		Worker& Self = *TaskPool::Workers[TaskPool::CurrentWorker];
+		lock_guard<mutex> Guard(Self.Lock);
+		Self.Tasks.push_back(move(NewTask));
+	}
+	else {
+		lock_guard<mutex> Guard(TaskPool::InjectedLock);
+		TaskPool::Injected.push_back(move(NewTask));
+	}
+
+	TaskPool::Signal();
+}
+
+bool TaskPool::Pop(Task* pTask, int32_t nMinimumDepth) {
+	assert(pTask != nullptr);
+
+	// Own deque first, newest task first: this is the work most likely to be hot in cache and the work the current thread may be waiting on.
+
+	if (TaskPool::CurrentWorker != -1) {
+		Worker& Self = *TaskPool::Workers[TaskPool::CurrentWorker];
+		lock_guard<mutex> Guard(Self.Lock);
+
+		for (deque<Task>::reverse_iterator Itr = Self.Tasks.rbegin(); Itr != Self.Tasks.rend(); ++Itr) {
+			if (Itr->Depth >= nMinimumDepth) {
+				*pTask = move(*Itr);
+				Self.Tasks.erase(next(Itr).base());
+				return true;
+			}
+		}
+	}
+
+	{
+		lock_guard<mutex> Guard(TaskPool::InjectedLock);
+
+		for (deque<Task>::iterator Itr = TaskPool::Injected.begin(); Itr != TaskPool::Injected.end(); ++Itr) {
+			if (Itr->Depth >= nMinimumDepth) {
+				*pTask = move(*Itr);
+				TaskPool::Injected.erase(Itr);
+				return true;
+			}
+		}
+	}
+
+	// Steal the oldest eligible task of another worker. The oldest task of a deque is typically the largest remaining unit of work its owner has split off.
+
+	size_t nWorkerCount = TaskPool::Workers.size();
+	size_t nStart = (TaskPool::CurrentWorker != -1 ? TaskPool::CurrentWorker + 1 : 0);
+
+	for (size_t nX = 0; nX < nWorkerCount; nX++) {
+		size_t nVictim = (nStart + nX) % nWorkerCount;
+
+		if (static_cast<int32_t>(nVictim) == TaskPool::CurrentWorker) {
+			continue;
+		}
+
+		Worker& Victim = *TaskPool::Workers[nVictim];
+		lock_guard<mutex> Guard(Victim.Lock);
+
+		for (deque<Task>::iterator Itr = Victim.Tasks.begin(); Itr != Victim.Tasks.end(); ++Itr) {
+			if (Itr->Depth >= nMinimumDepth) {
+				*pTask = move(*Itr);
+				Victim.Tasks.erase(Itr);
+
+				if (TaskPool::CurrentWorker != -1) {
+					TaskPool::Workers[TaskPool::CurrentWorker]->Stolen++;
+				}
+
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+bool TaskPool::RunOne(int32_t nMinimumDepth) {
+	Task CurrentTask;
+
+	if (!TaskPool::Pop(&CurrentTask, nMinimumDepth)) {
+		return false;
+	}
+
+	TaskPool::Pending--;
+
+	Interface::OutputCapture* PreviousCapture = Interface::SetCapture(CurrentTask.Capture);
+	int32_t nPreviousDepth = TaskPool::CurrentDepth;
+	exception_ptr Error = nullptr;
+
+	TaskPool::CurrentDepth = CurrentTask.Depth;
+
+	try {
+		CurrentTask.Routine();
+	}
+	catch (...) {
+		Error = current_exception();
+	}
+
+	TaskPool::CurrentDepth = nPreviousDepth;
+	Interface::SetCapture(PreviousCapture);
+
+	if (TaskPool::CurrentWorker != -1) {
+		TaskPool::Workers[TaskPool::CurrentWorker]->Executed++;
+	}
+
+	CurrentTask.Group->Complete(Error);
+	return true;
+}
+
+void TaskPool::WorkerMain(uint32_t dwWorkerIndex) {
+	GrantSelfSeDebug(); // SeDebug is enabled on an impersonation token of the thread which requested it: each worker must acquire its own
+	TaskPool::CurrentWorker = dwWorkerIndex;
+
+	while (!TaskPool::Stopping) {
+		if (!TaskPool::RunOne(0)) {
+			unique_lock<mutex> Guard(TaskPool::IdleLock);
+			TaskPool::IdleSignal.wait(Guard, []() { return TaskPool::Stopping || TaskPool::Pending > 0; });
+		}
+	}
+}
+
+void TaskPool::HelpUntil(const function<bool()>& Condition) {
+	while (!Condition()) {
+		if (!TaskPool::RunOne(TaskPool::CurrentDepth + 1)) {
+			// Nothing this thread is permitted to run. The tasks it is waiting on are being executed elsewhere: sleep until a task completes or new work arrives.
+			// The timeout covers work which is pending but ineligible for this thread, which does not change the pending count when it completes.
+
+			unique_lock<mutex> Guard(TaskPool::IdleLock);
+			TaskPool::IdleSignal.wait_for(Guard, chrono::milliseconds(10), [&Condition]() { return Condition(); });
+		}
+	}
+}
+
+void TaskPool::ParallelFor(size_t nCount, const function<void(size_t)>& Task) {
+	if (!nCount) {
+		return;
+	}
+
+	if (TaskPool::Workers.empty() || nCount == 1) {
+		for (size_t nX = 0; nX < nCount; nX++) {
+			Task(nX);
+		}
+
+		return;
+	}
+
+	// Split the range into several blocks per worker: enough that idle workers have something to steal when block costs are skewed, few enough to keep scheduling overhead small.
+
+	TaskGroup Group;
+	size_t nBlockSize = max<size_t>(1, nCount / (TaskPool::Workers.size() * 8));
+
+	for (size_t nStart = 0; nStart < nCount; nStart += nBlockSize) {
+		size_t nEnd = min(nCount, nStart + nBlockSize);
+
+		Group.Run([&Task, nStart, nEnd]() {
+			for (size_t nX = nStart; nX < nEnd; nX++) {
+				Task(nX);
+			}
+		});
+	}
+
+	Group.Wait();
+}
+
+void TaskPool::RetireIndex(const function<void(size_t)>& Retire, size_t nIndex, exception_ptr& Error) {
+	try {
+		Retire(nIndex);
+	}
+	catch (...) {
+		if (Error == nullptr) {
+			Error = current_exception();
+		}
+	}
+}
+
+void TaskPool::OrderedFor(size_t nCount, const function<void(size_t)>& Task, const function<void(size_t)>& Retire) {
+	vector<exception_ptr> Errors(nCount);
+	exception_ptr Error = nullptr;
+
+	if (TaskPool::Workers.empty() || nCount <= 1) { // Output is written directly to the log as each index runs
+		for (size_t nX = 0; nX < nCount; nX++) {
+			try {
+				Task(nX);
+			}
+			catch (...) {
+				Errors[nX] = current_exception();
+			}
+
+			TaskPool::RetireIndex(Retire, nX, Errors[nX]);
+		}
+	}
+	else {
+		// Each index is a task on the pool and may split its own work into further tasks, which idle workers steal rather than waiting on the tail of the loop.
+		// While the capture the calling thread is waiting on is incomplete, it executes pending tasks itself. An index is only marked complete once its capture
+		// has been restored, on every exit path of its task: the calling thread would otherwise wait on it forever.
+
+		vector<unique_ptr<Interface::OutputCapture>> Captures;
+		unique_ptr<atomic<bool>[]> Complete(new atomic<bool>[nCount]);
+		TaskGroup Group;
+
+		for (size_t nX = 0; nX < nCount; nX++) {
+			Captures.push_back(make_unique<Interface::OutputCapture>());
+			Complete[nX] = false;
+		}
+
+		for (size_t nX = 0; nX < nCount; nX++) {
+			Group.Run([&Task, &Captures, &Complete, &Errors, nX]() {
+				Interface::OutputCapture* PreviousCapture = Interface::SetCapture(Captures[nX].get());
+
+				try {
+					Task(nX);
+				}
+				catch (...) {
+					Errors[nX] = current_exception();
+				}
+
+				Interface::SetCapture(PreviousCapture);
+				Complete[nX] = true;
+				TaskPool::Signal();
+			});
+		}
+
+		for (size_t nX = 0; nX < nCount; nX++) {
+			atomic<bool>* pComplete = &Complete[nX];
+
+			TaskPool::HelpUntil([pComplete]() { return pComplete->load(); });
+			Captures[nX]->Flush();
+			TaskPool::RetireIndex(Retire, nX, Errors[nX]); // Tasks of later indexes may still be running and referencing this frame: the loop must not be left early
+		}
+
+		Group.Wait();
+	}
+
+	for (size_t nX = 0; nX < nCount && Error == nullptr; nX++) {
+		Error = Errors[nX];
+	}
+
+	if (Error != nullptr) {
+		rethrow_exception(Error);
+	}
+}
+
+TaskGroup::TaskGroup() : Outstanding(0), Error(nullptr), Depth(TaskPool::CurrentDepth + 1) {}
+
+TaskGroup::~TaskGroup() {
+	assert(this->Outstanding == 0);
+}
+
+void TaskGroup::Run(const function<void()>& Routine) {
+	TaskPool::Task NewTask;
+
+	NewTask.Routine = Routine;
+	NewTask.Group = this;
+	NewTask.Capture = Interface::GetCapture(); // Output produced on behalf of this group must reach the same destination as output of its creator
+	NewTask.Depth = this->Depth;
+	this->Outstanding++;
+
+	if (TaskPool::Workers.empty()) {
+		TaskPool::Push(NewTask);
+		TaskPool::RunOne(this->Depth); // There is no one else to run it
+	}
+	else {
+		TaskPool::Push(NewTask);
+	}
+}
+
+void TaskGroup::Complete(exception_ptr Error) {
+	if (Error != nullptr) {
+		lock_guard<mutex> Guard(this->Lock);
+
+		if (this->Error == nullptr) {
+			this->Error = Error;
+		}
+	}
+
+	if (--this->Outstanding == 0) {
+		TaskPool::Signal();
+	}
+}
+
+void TaskGroup::Wait() {
+	TaskPool::HelpUntil([this]() { return this->IsComplete(); });
+
+	if (this->Error != nullptr) {
+		exception_ptr Error = this->Error;
+		this->Error = nullptr;
+		rethrow_exception(Error);
+	}
+}
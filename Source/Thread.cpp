@@ -32,6 +32,7 @@ ________________________________________________________________________________
 #include "Interface.hpp"
 #include "Processes.hpp"
 #include "PEB.h"
+#include "RemotePageCache.hpp"
 
 using namespace std;
 using namespace Processes;
@@ -40,7 +41,7 @@ Thread::~Thread() {
 	CloseHandle(this->Handle);
 }
 
-Thread::Thread(uint32_t dwTid, Processes::Process &OwnerProc) : Id(dwTid) {
+Thread::Thread(uint32_t dwTid, Processes::Process &OwnerProc) : Id(dwTid), StartAddress(nullptr), TebAddress(nullptr), StackAddress(nullptr), StackLimit(nullptr) {
 	this->Handle = OpenThread(THREAD_QUERY_INFORMATION | THREAD_GET_CONTEXT, false, this->Id); // OpenThreadToken consistently failed even with impersonation (ERROR_NO_TOKEN). The idea was abandoned due to lack of relevance. Get-InjectedThread returns the user as SYSTEM even when it was a regular user which launched the remote thread.
 
 	if (this->Handle != nullptr) {
@@ -62,27 +63,27 @@ Thread::Thread(uint32_t dwTid, Processes::Process &OwnerProc) : Id(dwTid) {
 				Interface::Log(Interface::VerbosityLevel::Debug, "... TEB of 0x%p\r\n", Tbi.TebBaseAddress);
 				this->TebAddress = Tbi.TebBaseAddress;
 
-				if (OwnerProc.IsWow64()) {
-					unique_ptr<TEB32> LocalTeb = make_unique<TEB32>();
-					uint32_t dwTebSize = sizeof(TEB32);
+				if (OwnerProc.IsWow64()) { // Only the stack bounds are read from the TEB, through the page cache of the owner process
+					uint32_t dwStackBase = 0, dwStackLimit = 0;
 
-					if (ReadProcessMemory(OwnerProc.GetHandle(), Tbi.TebBaseAddress, LocalTeb.get(), dwTebSize, nullptr)) {
+					if (OwnerProc.GetPageCache()->ReadField(Tbi.TebBaseAddress, offsetof(TEB32, StackBase), dwStackBase) && OwnerProc.GetPageCache()->ReadField(Tbi.TebBaseAddress, offsetof(TEB32, StackLimit), dwStackLimit)) {
 						Interface::Log(Interface::VerbosityLevel::Debug, "... successfully read remote TEB to local memory.\r\n");
-						Interface::Log(Interface::VerbosityLevel::Debug, "... stack base: 0x%08x\r\n", LocalTeb->StackBase);
-						this->StackAddress = reinterpret_cast<void*>(LocalTeb->StackBase);
+						Interface::Log(Interface::VerbosityLevel::Debug, "... stack base: 0x%08x limit: 0x%08x\r\n", dwStackBase, dwStackLimit);
+						this->StackAddress = reinterpret_cast<void*>(dwStackBase);
+						this->StackLimit = reinterpret_cast<void*>(dwStackLimit);
 					}
 					else {
 						throw 4;
 					}
 				}
 				else {
-					unique_ptr<TEB64> LocalTeb = make_unique<TEB64>();
-					uint32_t dwTebSize = sizeof(TEB64);
+					void* pStackBase = nullptr, *pStackLimit = nullptr;
 
-					if (ReadProcessMemory(OwnerProc.GetHandle(), Tbi.TebBaseAddress, LocalTeb.get(), dwTebSize, nullptr)) {
+					if (OwnerProc.GetPageCache()->ReadField(Tbi.TebBaseAddress, offsetof(TEB64, StackBase), pStackBase) && OwnerProc.GetPageCache()->ReadField(Tbi.TebBaseAddress, offsetof(TEB64, StackLimit), pStackLimit)) {
 						Interface::Log(Interface::VerbosityLevel::Debug, "... successfully read remote TEB to local memory.\r\n");
-						Interface::Log(Interface::VerbosityLevel::Debug, "... stack base: 0x%p\r\n", LocalTeb->StackBase);
-						this->StackAddress = LocalTeb->StackBase;
+						Interface::Log(Interface::VerbosityLevel::Debug, "... stack base: 0x%p limit: 0x%p\r\n", pStackBase, pStackLimit);
+						this->StackAddress = pStackBase;
+						this->StackLimit = pStackLimit;
 					}
 					else {
 						throw 4;
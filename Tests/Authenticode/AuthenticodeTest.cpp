@@ -0,0 +1,183 @@
+/*
+ Checks the Authenticode digests and signature status of the sample images in the Images folder (generated by MakeImages.py) against the digests that script
+ computes section by section, as the PE/COFF specification describes. Any further files given on the command line are images signed by a real signing tool,
+ each of which must be found intact. The engine is portable, so the test builds and runs off Windows: see the Makefile alongside.
+
+ Usage: AuthenticodeTest [Images folder] [signed image...]
+*/
+
+#include "Portable.h"
+#include "Authenticode.hpp"
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+using namespace std;
+
+static int32_t nFailures = 0;
+
+#define CHECK(Condition) do { if (!(Condition)) { printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #Condition); nFailures++; } } while (0)
+
+struct KnownAnswer {
+	const char* FileName;
+	AuthenticodeStatus_t Status;
+	HashAlgorithm_t Algorithm; // Of the signature
+	const char* Sha1;
+	const char* Sha256;
+};
+
+static const KnownAnswer KnownAnswers[] = {
+	{ "Unsigned.exe", AuthenticodeStatus_t::Unsigned, HashAlgorithm_t::Unknown, "620AC79395FCD8044387242B34B63547A9AD57AE", "24606FF5F0E8ED54E9F50E4687FDEE1B659ACA3B4C8C2B7E3F2321F251200E85" },
+	{ "Sha1.exe", AuthenticodeStatus_t::Intact, HashAlgorithm_t::Sha1, "620AC79395FCD8044387242B34B63547A9AD57AE", "24606FF5F0E8ED54E9F50E4687FDEE1B659ACA3B4C8C2B7E3F2321F251200E85" }, // Signing Unsigned.exe leaves its digest unchanged
+	{ "Sha256.dll", AuthenticodeStatus_t::Intact, HashAlgorithm_t::Sha256, "2DC4D0CB1F86BB1542B6E5F594039291C5DBD662", "8255131358FDE375D75B9A2CE57D9A25150D4B81ABA116363059B6B448F8E9AC" },
+	{ "Modified.dll", AuthenticodeStatus_t::Modified, HashAlgorithm_t::Sha256, "13B6898053A3FB98340EB89B7DA8326E85E06DE8", "8E48ED96D094FC65F7281C2C6685F6FEB027DFB8F167A7C96A6BECF33832A3E8" },
+	{ "Overlay.exe", AuthenticodeStatus_t::Intact, HashAlgorithm_t::Sha256, "E14C3EFF9A5D2995EEE4891A643DEE62BCB5D425", "BFF9C5F6E0C7C04CBA4DC45D9B4B8AFA82B7CAF39714B6054175638CF8A76B33" }
+};
+
+static vector<uint8_t> ReadImage(const filesystem::path& Path) {
+	ifstream ImageFile(Path, ios::binary);
+	return vector<uint8_t>((istreambuf_iterator<char>(ImageFile)), istreambuf_iterator<char>());
+}
+
+static string Hex(const vector<uint8_t>& Data) {
+	string Text;
+	char Byte[3];
+
+	for (vector<uint8_t>::const_iterator Itr = Data.begin(); Itr != Data.end(); ++Itr) {
+		snprintf(Byte, sizeof(Byte), "%02X", *Itr);
+		Text += Byte;
+	}
+
+	return Text;
+}
+
+static string HashImage(const vector<uint8_t>& Image, HashAlgorithm_t Algorithm) {
+	vector<uint8_t> Digest;
+	return Authenticode::HashImage(Image.data(), Image.size(), Algorithm, Digest) ? Hex(Digest) : string();
+}
+
+static AuthenticodeStatus_t CheckImage(const vector<uint8_t>& Image) {
+	AuthenticodeSignature Signature;
+	return Authenticode::CheckImage(Image.data(), Image.size(), Signature);
+}
+
+static size_t OptHdrOffset(const vector<uint8_t>& Image) {
+	uint32_t dwNtHdrsOffset;
+
+	memcpy(&dwNtHdrsOffset, &Image[0x3C], sizeof(dwNtHdrsOffset));
+	return dwNtHdrsOffset + 4 + 20;
+}
+
+static size_t SecurityDirOffset(const vector<uint8_t>& Image) {
+	uint16_t wMagic;
+
+	memcpy(&wMagic, &Image[OptHdrOffset(Image)], sizeof(wMagic));
+	return OptHdrOffset(Image) + (wMagic == 0x20B ? 112 : 96) + 4 * 8;
+}
+
+static void TestKnownAnswers(const filesystem::path& Folder) {
+	for (size_t nX = 0; nX < sizeof(KnownAnswers) / sizeof(KnownAnswers[0]); nX++) {
+		const KnownAnswer& Expected = KnownAnswers[nX];
+		vector<uint8_t> Image = ReadImage(Folder / Expected.FileName);
+		AuthenticodeSignature Signature;
+
+		printf("%s\n", Expected.FileName);
+		CHECK(!Image.empty());
+		CHECK(HashImage(Image, HashAlgorithm_t::Sha1) == Expected.Sha1);
+		CHECK(HashImage(Image, HashAlgorithm_t::Sha256) == Expected.Sha256);
+		CHECK(Authenticode::CheckImage(Image.data(), Image.size(), Signature) == Expected.Status);
+
+		if (Expected.Status != AuthenticodeStatus_t::Unsigned) {
+			CHECK(Signature.Algorithm == Expected.Algorithm);
+			CHECK(Signature.Signer == L"Moneta Test Code Signer");
+			CHECK(Signature.Issuer == L"Moneta Test Root");
+		}
+
+		if (Expected.Status == AuthenticodeStatus_t::Intact) {
+			CHECK(Hex(Signature.SignedDigest) == (Expected.Algorithm == HashAlgorithm_t::Sha1 ? Expected.Sha1 : Expected.Sha256));
+		}
+	}
+}
+
+static void TestExcludedFields(const filesystem::path& Folder) { // The checksum, security directory and certificate table are outside of the digest, and every other byte is within it
+	vector<uint8_t> Original = ReadImage(Folder / "Sha256.dll");
+	vector<uint8_t> Image;
+	size_t nSecurityDir = SecurityDirOffset(Original);
+	uint32_t dwCertOffset;
+
+	memcpy(&dwCertOffset, &Original[nSecurityDir], sizeof(dwCertOffset));
+
+	Image = Original;
+	Image[OptHdrOffset(Image) + 64] ^= 0xFF; // CheckSum
+	CHECK(CheckImage(Image) == AuthenticodeStatus_t::Intact);
+
+	Image = Original;
+	Image.insert(Image.end(), 8, 0); // Padding the certificate table
+	Image[nSecurityDir + 4] += 8;
+	CHECK(CheckImage(Image) == AuthenticodeStatus_t::Intact);
+
+	for (size_t nOffset : { static_cast<size_t>(0x40), nSecurityDir - 8, nSecurityDir + 8, static_cast<size_t>(dwCertOffset) - 1 }) { // DOS stub, import directory, the directory after the security directory, last byte before the certificate table
+		Image = Original;
+		Image[nOffset] ^= 0x01;
+		CHECK(CheckImage(Image) == AuthenticodeStatus_t::Modified);
+	}
+
+	Image = Original;
+	Image.resize(dwCertOffset); // Stripping the certificate table, as signtool remove does
+	memset(&Image[nSecurityDir], 0, 8);
+	CHECK(CheckImage(Image) == AuthenticodeStatus_t::Unsigned);
+	CHECK(HashImage(Image, HashAlgorithm_t::Sha256) == HashImage(Original, HashAlgorithm_t::Sha256));
+}
+
+static void TestMalformed(const filesystem::path& Folder) {
+	vector<uint8_t> Original = ReadImage(Folder / "Sha1.exe");
+	vector<uint8_t> Image;
+	size_t nSecurityDir = SecurityDirOffset(Original);
+	uint32_t dwCertOffset;
+
+	memcpy(&dwCertOffset, &Original[nSecurityDir], sizeof(dwCertOffset));
+
+	Image = Original;
+	Image[0] = 'X';
+	CHECK(CheckImage(Image) == AuthenticodeStatus_t::NotImage);
+	CHECK(HashImage(Image, HashAlgorithm_t::Sha1).empty());
+
+	Image = Original;
+	Image[dwCertOffset + 8] = 0x31; // The PKCS #7 ContentInfo is not a sequence
+	CHECK(CheckImage(Image) == AuthenticodeStatus_t::Unsupported);
+
+	Image = Original;
+	Image[dwCertOffset + 6] = 0x01; // An X.509 certificate rather than PKCS #7 signed data
+	CHECK(CheckImage(Image) == AuthenticodeStatus_t::Unsupported);
+
+	Image = Original;
+	Image.resize(Image.size() - 16); // The certificate table runs past the end of the file
+	CHECK(CheckImage(Image) == AuthenticodeStatus_t::Unsigned);
+	CHECK(HashImage(Image, HashAlgorithm_t::Sha1).empty() == false);
+}
+
+int main(int nArgc, char** pArgv) {
+	filesystem::path Folder = nArgc > 1 ? filesystem::path(pArgv[1]) : filesystem::path(pArgv[0]).parent_path() / "Images";
+
+	TestKnownAnswers(Folder);
+	TestExcludedFields(Folder);
+	TestMalformed(Folder);
+
+	for (int32_t nX = 2; nX < nArgc; nX++) { // Images signed by a real signing tool
+		vector<uint8_t> Image = ReadImage(pArgv[nX]);
+		AuthenticodeSignature Signature;
+		AuthenticodeStatus_t Status = Authenticode::CheckImage(Image.data(), Image.size(), Signature);
+
+		if (Status != AuthenticodeStatus_t::Intact) {
+			printf("%s: status %d\n", pArgv[nX], static_cast<int32_t>(Status));
+			nFailures++;
+		}
+	}
+
+	if (nArgc > 2) {
+		printf("%d signed images\n", nArgc - 2);
+	}
+
+	printf("%s\n", nFailures ? "FAILED" : "PASSED");
+	return nFailures ? 1 : 0;
+}
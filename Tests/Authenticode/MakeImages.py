@@ -0,0 +1,170 @@
+# Generates the sample images used by AuthenticodeTest: small PE32 and PE32+ images laid out as a linker lays them out, each followed by a certificate table
+# holding a PKCS #7 SignedData whose SPC_INDIRECT_DATA content carries the SHA-1 or SHA-256 Authenticode digest of the image. The digests are computed here
+# as the PE/COFF specification describes (the headers, then each section in order of its raw data, then any data up to the certificate table) rather than
+# by hashing the file linearly as Authenticode.cpp does. The signatures are placeholders: the engine never validates them. The images are deterministic,
+# and the digests printed are those expected by AuthenticodeTest.cpp.
+#
+# Usage: python3 MakeImages.py [output folder]
+
+import hashlib
+import os
+import struct
+import sys
+
+def Der(Tag, Content):
+    if len(Content) < 0x80:
+        Length = bytes([len(Content)])
+    else:
+        Encoded = len(Content).to_bytes((len(Content).bit_length() + 7) // 8, "big")
+        Length = bytes([0x80 | len(Encoded)]) + Encoded
+    return bytes([Tag]) + Length + Content
+
+def Seq(*Items): return Der(0x30, b"".join(Items))
+def Set(*Items): return Der(0x31, b"".join(Items))
+def Oid(Value): return Der(0x06, Value)
+def Octets(Value): return Der(0x04, Value)
+def Integer(Value): return Der(0x02, bytes([Value]))
+def Explicit(Number, Item): return Der(0xA0 | Number, Item)
+
+OidSignedData = bytes([0x2A, 0x86, 0x48, 0x86, 0xF7, 0x0D, 0x01, 0x07, 0x02])
+OidIndirectData = bytes([0x2B, 0x06, 0x01, 0x04, 0x01, 0x82, 0x37, 0x02, 0x01, 0x04])
+OidPeImageData = bytes([0x2B, 0x06, 0x01, 0x04, 0x01, 0x82, 0x37, 0x02, 0x01, 0x0F])
+OidSha1 = bytes([0x2B, 0x0E, 0x03, 0x02, 0x1A])
+OidSha256 = bytes([0x60, 0x86, 0x48, 0x01, 0x65, 0x03, 0x04, 0x02, 0x01])
+OidRsa = bytes([0x2A, 0x86, 0x48, 0x86, 0xF7, 0x0D, 0x01, 0x01, 0x01])
+OidSha256Rsa = bytes([0x2A, 0x86, 0x48, 0x86, 0xF7, 0x0D, 0x01, 0x01, 0x0B])
+OidCommonName = bytes([0x55, 0x04, 0x03])
+OidOrganization = bytes([0x55, 0x04, 0x0A])
+
+FileAlignment = 0x200
+SectionAlignment = 0x1000
+HeadersSize = 0x400
+
+def Align(Value, Alignment):
+    return (Value + Alignment - 1) // Alignment * Alignment
+
+def Name(Attributes):
+    return Seq(*[Set(Seq(Oid(Type), Der(0x13, Value.encode()))) for Type, Value in Attributes])
+
+def Certificate(Serial, Issuer, Subject):
+    Algorithm = Seq(Oid(OidSha256Rsa), b"\x05\x00")
+    Validity = Seq(Der(0x17, b"260101000000Z"), Der(0x17, b"360101000000Z"))
+    PublicKey = Seq(Seq(Oid(OidRsa), b"\x05\x00"), Der(0x03, b"\x00" + Seq(Integer(1), Integer(3))))
+    TbsCertificate = Seq(Explicit(0, Integer(2)), Integer(Serial), Algorithm, Name(Issuer), Validity, Name(Subject), PublicKey)
+    return Seq(TbsCertificate, Algorithm, Der(0x03, b"\x00" + bytes(32)))
+
+def CertificateTable(Digest, Sha256):
+    Algorithm = Seq(Oid(OidSha256 if Sha256 else OidSha1), b"\x05\x00")
+    IndirectData = Seq(Seq(Oid(OidPeImageData), Seq(Der(0x03, b"\x00"), Explicit(0, Explicit(2, Der(0x80, b""))))), Seq(Algorithm, Octets(Digest)))
+    Issuer = [(OidOrganization, "Moneta Test"), (OidCommonName, "Moneta Test Root")]
+    Signer = [(OidOrganization, "Moneta Test"), (OidCommonName, "Moneta Test Code Signer")]
+    Certificates = Explicit(0, Certificate(7, Issuer, Issuer) + Certificate(9, Issuer, Signer)) # The signer certificate is not the first
+    SignerInfo = Seq(Integer(1), Seq(Name(Issuer), Integer(9)), Algorithm, Seq(Oid(OidRsa), b"\x05\x00"), Octets(bytes(32)))
+    SignedData = Seq(Integer(1), Set(Algorithm), Seq(Oid(OidIndirectData), Explicit(0, IndirectData)), Certificates, Set(SignerInfo))
+    Pkcs7 = Seq(Oid(OidSignedData), Explicit(0, SignedData))
+    Entry = struct.pack("<IHH", 8 + len(Pkcs7), 0x0200, 0x0002) + Pkcs7 # WIN_CERTIFICATE of revision 2 holding PKCS #7 signed data
+    return Entry + bytes(Align(len(Entry), 8) - len(Entry))
+
+def Image(Pe32Plus, Sections, Overlay=b""):
+    OptHdrSize = 0xF0 if Pe32Plus else 0xE0
+    NtHdrsOffset = 0x80
+    OptHdrOffset = NtHdrsOffset + 4 + 20
+    Image = bytearray(HeadersSize)
+    Image[0:2] = b"MZ"
+    Image[0x3C:0x40] = struct.pack("<I", NtHdrsOffset)
+    Image[0x40:0x80] = bytes((nX * 37 + 11) & 0xFF for nX in range(0x40)) # Stands in for a DOS stub
+    Image[NtHdrsOffset:OptHdrOffset] = b"PE\0\0" + struct.pack("<HHIIIHH", 0x8664 if Pe32Plus else 0x14C, len(Sections), 0x5F000000, 0, 0, OptHdrSize, 0x2022 if Pe32Plus else 0x0102)
+
+    Rva = SectionAlignment
+    RawOffset = HeadersSize
+    SectionHeaders = b""
+    Raw = b""
+
+    for SectionName, Data, Characteristics in Sections:
+        RawSize = Align(len(Data), FileAlignment)
+        SectionHeaders += struct.pack("<8sIIIIIIHHI", SectionName, len(Data), Rva, RawSize, RawOffset, 0, 0, 0, 0, Characteristics)
+        Raw += Data + bytes(RawSize - len(Data))
+        Rva += Align(len(Data), SectionAlignment)
+        RawOffset += RawSize
+
+    if Pe32Plus:
+        Fields = struct.pack("<HBBIIIIIQIIHHHHHHIIIIHHQQQQII", 0x20B, 14, 0, 0x200, 0x200, 0, 0x1000, 0x1000, 0x180000000, SectionAlignment, FileAlignment, 6, 0, 0, 0, 6, 0, 0, Rva, HeadersSize, 0x12345678, 2, 0x8160, 0x100000, 0x1000, 0x100000, 0x1000, 0, 16)
+    else:
+        Fields = struct.pack("<HBBIIIIIIIIIHHHHHHIIIIHHIIIIII", 0x10B, 14, 0, 0x200, 0x200, 0, 0x1000, 0x1000, 0x2000, 0x400000, SectionAlignment, FileAlignment, 6, 0, 0, 0, 6, 0, 0, Rva, HeadersSize, 0x12345678, 3, 0x8140, 0x100000, 0x1000, 0x100000, 0x1000, 0, 16)
+
+    DataDirs = bytearray(16 * 8)
+    DataDirs[8:16] = struct.pack("<II", 0x2000, 0x40) # An import directory, to give the data directories other content than the security directory
+    Image[OptHdrOffset:OptHdrOffset + OptHdrSize] = Fields + DataDirs
+    Image[OptHdrOffset + OptHdrSize:OptHdrOffset + OptHdrSize + len(SectionHeaders)] = SectionHeaders
+    Image += Raw + Overlay
+    Image += bytes(Align(len(Image), 8) - len(Image)) # The certificate table is aligned to 8 bytes, and the padding before it is hashed
+    return Image
+
+def SecurityDirOffset(Image):
+    NtHdrsOffset = struct.unpack_from("<I", Image, 0x3C)[0]
+    OptHdrOffset = NtHdrsOffset + 4 + 20
+    return OptHdrOffset + (112 if struct.unpack_from("<H", Image, OptHdrOffset)[0] == 0x20B else 96) + 4 * 8
+
+def Digest(Image, Sha256):
+    # As the PE/COFF specification describes: the headers except for the checksum and security directory, then each section in order of its raw data, then any
+    # remaining data up to the certificate table
+
+    Hash = hashlib.sha256() if Sha256 else hashlib.sha1()
+    NtHdrsOffset = struct.unpack_from("<I", Image, 0x3C)[0]
+    SectionCount, OptHdrSize = struct.unpack_from("<H", Image, NtHdrsOffset + 6)[0], struct.unpack_from("<H", Image, NtHdrsOffset + 20)[0]
+    ChecksumOffset = NtHdrsOffset + 4 + 20 + 64
+    SecurityDir = SecurityDirOffset(Image)
+    CertOffset, CertSize = struct.unpack_from("<II", Image, SecurityDir)
+    End = CertOffset if CertSize else len(Image)
+    Hash.update(Image[:ChecksumOffset])
+    Hash.update(Image[ChecksumOffset + 4:SecurityDir])
+    Hash.update(Image[SecurityDir + 8:HeadersSize])
+    Hashed = HeadersSize
+    Sections = []
+
+    for nX in range(SectionCount):
+        RawSize, RawOffset = struct.unpack_from("<II", Image, NtHdrsOffset + 4 + 20 + OptHdrSize + nX * 40 + 16)
+        Sections.append((RawOffset, RawSize))
+
+    for RawOffset, RawSize in sorted(Sections):
+        Hash.update(Image[RawOffset:RawOffset + RawSize])
+        Hashed += RawSize
+
+    Hash.update(Image[Hashed:End])
+    return Hash.digest()
+
+def Sign(Image, Sha256):
+    CertTable = CertificateTable(Digest(Image, Sha256), Sha256)
+    Signed = bytearray(Image)
+    Signed[SecurityDirOffset(Signed):SecurityDirOffset(Signed) + 8] = struct.pack("<II", len(Image), len(CertTable))
+    return Signed + CertTable
+
+def Write(Folder, FileName, Data):
+    os.makedirs(Folder, exist_ok=True)
+
+    with open(os.path.join(Folder, FileName), "wb") as Output:
+        Output.write(Data)
+
+def Pattern(Seed, Size):
+    return bytes((nX * Seed + (nX >> 7)) & 0xFF for nX in range(Size))
+
+if __name__ == "__main__":
+    Folder = sys.argv[1] if len(sys.argv) > 1 else os.path.join(os.path.dirname(os.path.abspath(__file__)), "Images")
+    Sections32 = [(b".text", Pattern(3, 0x1234), 0x60000020), (b".rdata", Pattern(5, 0x321), 0x40000040), (b".data", Pattern(7, 0x80), 0xC0000040)]
+    Sections64 = [(b".text", Pattern(11, 0x2345), 0x60000020), (b".rdata", Pattern(13, 0x456), 0x40000040), (b".pdata", Pattern(17, 0x60), 0x40000040), (b".reloc", Pattern(19, 0x10), 0x42000040)]
+
+    Unsigned = Image(False, Sections32)
+    Sha1 = Sign(Image(False, Sections32), False)
+    Sha256 = Sign(Image(True, Sections64), True)
+    Modified = bytearray(Sha256)
+    Modified[HeadersSize + 0x100] ^= 0x01 # One bit of code flipped after signing
+    Overlay = Sign(Image(True, Sections64, Pattern(23, 0x777)), True) # Data appended after the last section before signing, as installers do
+
+    Write(Folder, "Unsigned.exe", Unsigned)
+    Write(Folder, "Sha1.exe", Sha1)
+    Write(Folder, "Sha256.dll", Sha256)
+    Write(Folder, "Modified.dll", Modified)
+    Write(Folder, "Overlay.exe", Overlay)
+
+    for FileName, Data in (("Unsigned.exe", Unsigned), ("Sha1.exe", Sha1), ("Sha256.dll", Sha256), ("Modified.dll", Modified), ("Overlay.exe", Overlay)):
+        print("%-13s SHA-1 %s SHA-256 %s" % (FileName, Digest(Data, False).hex().upper(), Digest(Data, True).hex().upper()))
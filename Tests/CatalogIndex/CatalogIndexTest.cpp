@@ -0,0 +1,91 @@
+/*
+ Builds a catalog index from the sample catalogs in the Catalogs folder (generated by MakeCatalogs.py) and checks the members and issuers resolved from it.
+ Only the portable parts of the index are exercised, so the test builds and runs off Windows: see the Makefile alongside.
+*/
+
+#include "Portable.h"
+#include "Digest.hpp"
+#include "CatalogIndex.hpp"
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+using namespace std;
+
+static int32_t nFailures = 0;
+
+#define CHECK(Condition) do { if (!(Condition)) { printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #Condition); nFailures++; } } while (0)
+
+static size_t AddCatalogs(CatalogIndex& Index, const filesystem::path& Folder, size_t& nRejected) { // Mirrors CatalogIndex::AddFolder: every .cat file within the folder and its subfolders
+	size_t nCatalogCount = 0;
+
+	for (filesystem::recursive_directory_iterator Itr(Folder), End; Itr != End; ++Itr) {
+		if (Itr->is_regular_file() && Itr->path().extension() == ".cat") {
+			ifstream CatalogFile(Itr->path(), ios::binary);
+			vector<uint8_t> CatalogBuf((istreambuf_iterator<char>(CatalogFile)), istreambuf_iterator<char>());
+
+			if (Index.AddCatalog(Itr->path().wstring(), CatalogBuf.data(), CatalogBuf.size())) {
+				nCatalogCount++;
+			}
+			else {
+				nRejected++;
+			}
+		}
+	}
+
+	return nCatalogCount;
+}
+
+static vector<uint8_t> MemberDigest(const string& Name, bool bSha256) { // MakeCatalogs.py uses the digest of the member name in place of that of a member file
+	unique_ptr<HashDigest> Hash(bSha256 ? static_cast<HashDigest*>(new Sha256Digest()) : static_cast<HashDigest*>(new Sha1Digest()));
+	vector<uint8_t> Digest(Hash->GetSize());
+
+	Hash->Update(reinterpret_cast<const uint8_t*>(Name.data()), Name.size());
+	Hash->Final(Digest.data());
+	return Digest;
+}
+
+static const CatalogIndex::Catalog* FindMember(const CatalogIndex& Index, const string& Name, bool bSha256) {
+	vector<uint8_t> Digest = MemberDigest(Name, bSha256);
+	return Index.Find(Digest.data(), Digest.size());
+}
+
+static bool IsCatalog(const CatalogIndex::Catalog* Target, const wchar_t* FileName, const wchar_t* Issuer) {
+	return Target != nullptr && filesystem::path(Target->Path).filename() == FileName && Target->Issuer == Issuer;
+}
+
+int main(int nArgc, char** pArgv) {
+	filesystem::path Folder = nArgc > 1 ? filesystem::path(pArgv[1]) : filesystem::path(pArgv[0]).parent_path() / "Catalogs";
+	CatalogIndex Index;
+	size_t nRejected = 0;
+
+	CHECK(AddCatalogs(Index, Folder, nRejected) == 3);
+	CHECK(nRejected == 1); // Truncated.cat
+	Index.Finalize();
+
+	CHECK(Index.GetCatalogCount() == 3);
+	CHECK(Index.GetMemberCount() == 6);
+	CHECK(Index.HasDigestSize(Sha1Digest::Size));
+	CHECK(Index.HasDigestSize(Sha256Digest::Size));
+	CHECK(!Index.HasDigestSize(16));
+
+	// Members of catalogs with the CTL encoded directly, wrapped in an octet string, and in a subfolder of the store
+
+	CHECK(IsCatalog(FindMember(Index, "alpha.dll", false), L"Sha1.cat", L"Moneta Test Sha1 Signer"));
+	CHECK(IsCatalog(FindMember(Index, "beta.dll", false), L"Sha1.cat", L"Moneta Test Sha1 Signer"));
+	CHECK(IsCatalog(FindMember(Index, "gamma.sys", false), L"Sha1.cat", L"Moneta Test Sha1 Signer"));
+	CHECK(IsCatalog(FindMember(Index, "delta.dll", true), L"Sha256.cat", L"Moneta Test Sha256 Org")); // No common name: the organization is displayed
+	CHECK(IsCatalog(FindMember(Index, "epsilon.exe", true), L"Sha256.cat", L"Moneta Test Sha256 Org"));
+	CHECK(IsCatalog(FindMember(Index, "zeta.dll", true), L"Nested.cat", L"Moneta Test Nested Signer"));
+
+	// A digest is only found under its own algorithm, and members of rejected or non-.cat files are never indexed
+
+	CHECK(FindMember(Index, "alpha.dll", true) == nullptr);
+	CHECK(FindMember(Index, "delta.dll", false) == nullptr);
+	CHECK(FindMember(Index, "eta.dll", false) == nullptr);
+	CHECK(FindMember(Index, "theta.dll", false) == nullptr);
+	CHECK(Index.Find(nullptr, 64) == nullptr);
+
+	printf("%s\n", nFailures ? "FAILED" : "PASSED");
+	return nFailures ? 1 : 0;
+}
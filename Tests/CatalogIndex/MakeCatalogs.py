@@ -0,0 +1,67 @@
+# Generates the sample catalogs used by CatalogIndexTest. Each catalog is a PKCS #7 SignedData holding a certificate trust list whose trusted subjects carry
+# the SHA-1 or SHA-256 digests of their member files, laid out as makecat lays them out. The signatures are placeholders: the index never validates them.
+#
+# Usage: python3 MakeCatalogs.py [output folder]
+
+import hashlib
+import os
+import sys
+
+def Der(Tag, Content):
+    if len(Content) < 0x80:
+        Length = bytes([len(Content)])
+    else:
+        Encoded = len(Content).to_bytes((len(Content).bit_length() + 7) // 8, "big")
+        Length = bytes([0x80 | len(Encoded)]) + Encoded
+    return bytes([Tag]) + Length + Content
+
+def Seq(*Items): return Der(0x30, b"".join(Items))
+def Set(*Items): return Der(0x31, b"".join(Items))
+def Oid(Value): return Der(0x06, Value)
+def Octets(Value): return Der(0x04, Value)
+def Integer(Value): return Der(0x02, bytes([Value]))
+def Explicit(Number, Item): return Der(0xA0 | Number, Item)
+
+OidSignedData = bytes([0x2A, 0x86, 0x48, 0x86, 0xF7, 0x0D, 0x01, 0x07, 0x02])
+OidCtl = bytes([0x2B, 0x06, 0x01, 0x04, 0x01, 0x82, 0x37, 0x0A, 0x01])
+OidCatalogList = bytes([0x2B, 0x06, 0x01, 0x04, 0x01, 0x82, 0x37, 0x0C, 0x01, 0x01]) # 1.3.6.1.4.1.311.12.1.1
+OidCatalogMember = bytes([0x2B, 0x06, 0x01, 0x04, 0x01, 0x82, 0x37, 0x0C, 0x01, 0x02]) # 1.3.6.1.4.1.311.12.1.2
+OidIndirectData = bytes([0x2B, 0x06, 0x01, 0x04, 0x01, 0x82, 0x37, 0x02, 0x01, 0x04])
+OidPeImageData = bytes([0x2B, 0x06, 0x01, 0x04, 0x01, 0x82, 0x37, 0x02, 0x01, 0x0F]) # 1.3.6.1.4.1.311.2.1.15
+OidSha1 = bytes([0x2B, 0x0E, 0x03, 0x02, 0x1A])
+OidSha256 = bytes([0x60, 0x86, 0x48, 0x01, 0x65, 0x03, 0x04, 0x02, 0x01])
+OidRsa = bytes([0x2A, 0x86, 0x48, 0x86, 0xF7, 0x0D, 0x01, 0x01, 0x01])
+OidCommonName = bytes([0x55, 0x04, 0x03])
+OidOrganization = bytes([0x55, 0x04, 0x0A])
+
+def Member(Name, Sha256):
+    Digest = hashlib.sha256(Name.encode()).digest() if Sha256 else hashlib.sha1(Name.encode()).digest()
+    Algorithm = Seq(Oid(OidSha256 if Sha256 else OidSha1), b"\x05\x00")
+    IndirectData = Seq(Seq(Oid(OidPeImageData), Seq()), Seq(Algorithm, Octets(Digest)))
+    Attribute = Seq(Oid(OidIndirectData), Set(IndirectData))
+    return Seq(Octets(hashlib.sha1(Name.encode()).hexdigest().upper().encode("utf-16-le")), Set(Attribute))
+
+def Name(Attributes):
+    return Seq(*[Set(Seq(Oid(Type), Der(0x13, Value.encode()))) for Type, Value in Attributes])
+
+def Catalog(Members, Sha256, Issuer, WrapCtl):
+    Ctl = Seq(Seq(Oid(OidCatalogList)), Octets(hashlib.md5("".join(Members).encode()).digest()), Der(0x17, b"260101000000Z"), Seq(Oid(OidCatalogMember), b"\x05\x00"), Seq(*[Member(Item, Sha256) for Item in Members]))
+    Content = Octets(Ctl) if WrapCtl else Ctl # A CMS encoder wraps the content in an octet string, makecat does not
+    SignerInfo = Seq(Integer(1), Seq(Name(Issuer), Integer(1)), Seq(Oid(OidSha256), b"\x05\x00"), Seq(Oid(OidRsa), b"\x05\x00"), Octets(bytes(32)))
+    SignedData = Seq(Integer(1), Set(Seq(Oid(OidSha256), b"\x05\x00")), Seq(Oid(OidCtl), Explicit(0, Content)), Set(SignerInfo))
+    return Seq(Oid(OidSignedData), Explicit(0, SignedData))
+
+def Write(Folder, FileName, Data):
+    os.makedirs(Folder, exist_ok=True)
+
+    with open(os.path.join(Folder, FileName), "wb") as Output:
+        Output.write(Data)
+
+if __name__ == "__main__":
+    Folder = sys.argv[1] if len(sys.argv) > 1 else os.path.join(os.path.dirname(os.path.abspath(__file__)), "Catalogs")
+
+    Write(Folder, "Sha1.cat", Catalog(["alpha.dll", "beta.dll", "gamma.sys"], False, [(OidOrganization, "Moneta Test"), (OidCommonName, "Moneta Test Sha1 Signer")], False))
+    Write(Folder, "Sha256.cat", Catalog(["delta.dll", "epsilon.exe"], True, [(OidOrganization, "Moneta Test Sha256 Org")], True))
+    Write(os.path.join(Folder, "{F750E6C3-38EE-11D1-85E5-00C04FC295EE}"), "Nested.cat", Catalog(["zeta.dll"], True, [(OidCommonName, "Moneta Test Nested Signer")], False))
+    Write(Folder, "Truncated.cat", Catalog(["eta.dll"], False, [(OidCommonName, "Truncated")], False)[:-40])
+    Write(Folder, "NotACatalog.txt", Catalog(["theta.dll"], False, [(OidCommonName, "Ignored")], False))
@@ -0,0 +1,233 @@
+/*
+ Walks synthetic loader lists laid out in a byte buffer in place of the memory of a process, with the PEB32 and PEB64 layouts, and checks the modules
+ collected from them. The walker only reads through the reader it is given, so the test builds and runs off Windows: see the Makefile alongside.
+*/
+
+#include "StdAfx.h"
+#include "PEB.h"
+#include "LoaderList.hpp"
+
+using namespace std;
+using namespace Processes;
+
+static int32_t nFailures = 0;
+
+#define CHECK(Condition) do { if (!(Condition)) { printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #Condition); nFailures++; } } while (0)
+
+static_assert(offsetof(PEB32, Ldr) == 0x0C && offsetof(PEB_LDR_DATA32, InMemoryOrderModuleList) == 0x14 && offsetof(LDR_DATA_TABLE_ENTRY32, BaseDllName) == 0x2C, "PEB32 layout");
+static_assert(offsetof(PEB64, Ldr) == 0x18 && offsetof(PEB_LDR_DATA64, InMemoryOrderModuleList) == 0x20 && offsetof(LDR_DATA_TABLE_ENTRY64, BaseDllName) == 0x58, "PEB64 layout");
+
+class RemoteBuffer { // A range of remote addresses backed by a buffer. Reads which do not lie entirely within it fail, as those of a page which is not committed.
+public:
+	RemoteBuffer(uint64_t qwBase, size_t cbSize) : Base(qwBase), Buf(cbSize, 0), EntrySize(0), EntryReads(0) {}
+	bool Read(uint64_t qwAddress, void* pBuf, size_t cbSize) {
+		if (qwAddress < this->Base || qwAddress - this->Base > this->Buf.size() || cbSize > this->Buf.size() - (qwAddress - this->Base)) {
+			return false;
+		}
+
+		if (cbSize == this->EntrySize) {
+			this->EntryReads++;
+		}
+
+		memcpy(pBuf, &this->Buf[qwAddress - this->Base], cbSize);
+		return true;
+	}
+
+	void Write(uint64_t qwAddress, const void* pData, size_t cbSize) { memcpy(&this->Buf[qwAddress - this->Base], pData, cbSize); }
+	LoaderList::Reader_t GetReader() { return [this](uint64_t qwAddress, void* pBuf, size_t cbSize) { return this->Read(qwAddress, pBuf, cbSize); }; }
+	void CountEntryReads(size_t cbEntrySize) { this->EntrySize = cbEntrySize; this->EntryReads = 0; }
+	size_t GetEntryReads() const { return this->EntryReads; }
+protected:
+	uint64_t Base;
+	vector<uint8_t> Buf;
+	size_t EntrySize; // Reads of this size are counted as reads of a loader entry
+	size_t EntryReads;
+};
+
+class TestLoaderList : public LoaderList {
+public:
+	using LoaderList::MaxEntries;
+};
+
+static void SetName(UNICODE_STRING32& Name, uint64_t qwBuffer, size_t cbLength) {
+	Name.Length = Name.MaximumLength = static_cast<WORD>(cbLength);
+	Name.Buffer = static_cast<uint32_t>(qwBuffer);
+}
+
+static void SetName(UNICODE_STRING64& Name, uint64_t qwBuffer, size_t cbLength) {
+	Name.u.Length = Name.u.MaximumLength = static_cast<WORD>(cbLength);
+	Name.Buffer = qwBuffer;
+}
+
+template<typename Peb_t, typename LdrData_t, typename Entry_t, typename Pointer_t> class LoaderImage { // A PEB, its loader data and entries with their names, laid out in a remote buffer
+public:
+	static const uint64_t BaseAddress = 0x7FF00000; // Below 4GB, so that the same addresses are valid for both layouts
+	static const uint64_t PebAddress = BaseAddress;
+	static const uint64_t LdrAddress = BaseAddress + 0x1000;
+	static const uint64_t EntrySpacing = 0x400;
+
+	LoaderImage() : Memory(BaseAddress, 0x10000), EntryCount(0) {
+		LdrData_t LdrData = { 0 };
+
+		this->SetLdr(LdrAddress);
+		LdrData.InLoadOrderModuleList.Flink = LdrData.InLoadOrderModuleList.Blink = static_cast<Pointer_t>(LoadOrderHead()); // Both lists start out empty
+		LdrData.InMemoryOrderModuleList.Flink = LdrData.InMemoryOrderModuleList.Blink = static_cast<Pointer_t>(MemoryOrderHead());
+		this->Memory.Write(LdrAddress, &LdrData, sizeof(LdrData));
+	}
+
+	static uint64_t LoadOrderHead() { return LdrAddress + offsetof(LdrData_t, InLoadOrderModuleList); }
+	static uint64_t MemoryOrderHead() { return LdrAddress + offsetof(LdrData_t, InMemoryOrderModuleList); }
+
+	uint64_t AddEntry(uint64_t qwDllBase, uint64_t qwEntryPoint, uint32_t dwImageSize, const wstring& Name, const wstring& Path) { // Names are held in the wchar_t of the build, which is what the walker reads them as
+		uint64_t qwEntry = LdrAddress + EntrySpacing * ++this->EntryCount;
+		uint64_t qwName = qwEntry + sizeof(Entry_t), qwPath = qwName + Name.size() * sizeof(wchar_t);
+		Entry_t Entry = { 0 };
+
+		Entry.DllBase = static_cast<Pointer_t>(qwDllBase);
+		Entry.EntryPoint = static_cast<Pointer_t>(qwEntryPoint);
+		Entry.SizeOfImage = dwImageSize;
+		SetName(Entry.BaseDllName, qwName, Name.size() * sizeof(wchar_t));
+		SetName(Entry.FullDllName, qwPath, Path.size() * sizeof(wchar_t));
+		this->Memory.Write(qwEntry, &Entry, sizeof(Entry));
+		this->Memory.Write(qwName, Name.data(), Name.size() * sizeof(wchar_t));
+		this->Memory.Write(qwPath, Path.data(), Path.size() * sizeof(wchar_t));
+		return qwEntry;
+	}
+
+	void SetLdr(uint64_t qwLdr) {
+		Pointer_t Ldr = static_cast<Pointer_t>(qwLdr);
+		this->Memory.Write(PebAddress + offsetof(Peb_t, Ldr), &Ldr, sizeof(Ldr));
+	}
+
+	void SetLink(uint64_t qwLinks, uint64_t qwFlink) { // Sets the Flink of the list links at an address
+		Pointer_t Flink = static_cast<Pointer_t>(qwFlink);
+		this->Memory.Write(qwLinks, &Flink, sizeof(Flink));
+	}
+
+	void LinkLoadOrder(const vector<uint64_t>& Entries) { this->Link(LoadOrderHead(), offsetof(Entry_t, InLoadOrderLinks), Entries); }
+	void LinkMemoryOrder(const vector<uint64_t>& Entries) { this->Link(MemoryOrderHead(), offsetof(Entry_t, InMemoryOrderLinks), Entries); }
+
+	void Link(uint64_t qwHead, size_t nLinksOffset, const vector<uint64_t>& Entries) { // Links the entries into the list in the order given, the last returning to the head
+		uint64_t qwLinks = qwHead;
+
+		for (vector<uint64_t>::const_iterator Itr = Entries.begin(); Itr != Entries.end(); ++Itr) {
+			this->SetLink(qwLinks, *Itr + nLinksOffset);
+			qwLinks = *Itr + nLinksOffset;
+		}
+
+		this->SetLink(qwLinks, qwHead);
+	}
+
+	RemoteBuffer Memory;
+protected:
+	size_t EntryCount;
+};
+
+template<typename Image_t> static bool Walk(LoaderList& Loader, Image_t& Image);
+
+template<> bool Walk(LoaderList& Loader, LoaderImage<PEB32, PEB_LDR_DATA32, LDR_DATA_TABLE_ENTRY32, uint32_t>& Image) {
+	return Loader.Walk32(Image.Memory.GetReader(), Image.PebAddress);
+}
+
+template<> bool Walk(LoaderList& Loader, LoaderImage<PEB64, PEB_LDR_DATA64, LDR_DATA_TABLE_ENTRY64, uint64_t>& Image) {
+	return Loader.Walk64(Image.Memory.GetReader(), Image.PebAddress);
+}
+
+static bool IsModule(const LoaderList::Module* Mod, uint64_t qwEntryPoint, uint32_t dwImageSize, const wchar_t* Name, const wchar_t* Path, bool bInLoadOrder, bool bInMemoryOrder) {
+	return Mod != nullptr && Mod->EntryPoint == qwEntryPoint && Mod->ImageSize == dwImageSize && Mod->Name == Name && Mod->Path == Path && Mod->InLoadOrder == bInLoadOrder && Mod->InMemoryOrder == bInMemoryOrder;
+}
+
+template<typename Image_t, typename Entry_t> static void TestMerge(const char* Layout) { // A module missing from one of the lists is still collected, and flagged with the lists it was found in
+	Image_t Image;
+	LoaderList Loader;
+	uint64_t qwExe = Image.AddEntry(0x400000, 0x401000, 0x20000, L"app.exe", L"C:\\App\\app.exe");
+	uint64_t qwNtdll = Image.AddEntry(0x77000000, 0, 0x1A0000, L"ntdll.dll", L"C:\\Windows\\System32\\ntdll.dll");
+	uint64_t qwUnlinked = Image.AddEntry(0x10000000, 0x10001000, 0x8000, L"hidden.dll", L"C:\\Temp\\hidden.dll");
+	uint64_t qwMemoryOnly = Image.AddEntry(0x20000000, 0x20002000, 0x4000, L"late.dll", L"C:\\Temp\\late.dll");
+
+	Image.LinkLoadOrder({ qwExe, qwNtdll, qwUnlinked });
+	Image.LinkMemoryOrder({ qwExe, qwMemoryOnly, qwNtdll }); // In another order, as memory order is that of the bases
+
+	printf("%s: merged lists\n", Layout);
+	CHECK(Walk(Loader, Image));
+	CHECK(Loader.GetModules().size() == 4);
+	CHECK(IsModule(Loader.Find(reinterpret_cast<const void*>(0x400000)), 0x401000, 0x20000, L"app.exe", L"C:\\App\\app.exe", true, true));
+	CHECK(IsModule(Loader.Find(reinterpret_cast<const void*>(0x77000000)), 0, 0x1A0000, L"ntdll.dll", L"C:\\Windows\\System32\\ntdll.dll", true, true));
+	CHECK(IsModule(Loader.Find(reinterpret_cast<const void*>(0x10000000)), 0x10001000, 0x8000, L"hidden.dll", L"C:\\Temp\\hidden.dll", true, false));
+	CHECK(IsModule(Loader.Find(reinterpret_cast<const void*>(0x20000000)), 0x20002000, 0x4000, L"late.dll", L"C:\\Temp\\late.dll", false, true));
+	CHECK(Loader.Find(reinterpret_cast<const void*>(0x400001)) == nullptr);
+}
+
+template<typename Image_t, typename Entry_t> static void TestCycle(const char* Layout) { // A list which loops back to one of its entries instead of its head is only followed for a bounded number of entries
+	Image_t Image;
+	LoaderList Loader;
+	uint64_t qwFirst = Image.AddEntry(0x400000, 0x401000, 0x20000, L"app.exe", L"C:\\App\\app.exe");
+	uint64_t qwSecond = Image.AddEntry(0x77000000, 0, 0x1A0000, L"ntdll.dll", L"C:\\Windows\\System32\\ntdll.dll");
+
+	Image.LinkLoadOrder({ qwFirst, qwSecond });
+	Image.SetLink(qwSecond + offsetof(Entry_t, InLoadOrderLinks), qwFirst + offsetof(Entry_t, InLoadOrderLinks));
+	Image.Memory.CountEntryReads(sizeof(Entry_t));
+
+	printf("%s: cyclic list\n", Layout);
+	CHECK(Walk(Loader, Image));
+	CHECK(Image.Memory.GetEntryReads() == TestLoaderList::MaxEntries);
+	CHECK(Loader.GetModules().size() == 2);
+	CHECK(IsModule(Loader.Find(reinterpret_cast<const void*>(0x77000000)), 0, 0x1A0000, L"ntdll.dll", L"C:\\Windows\\System32\\ntdll.dll", true, false));
+}
+
+template<typename Image_t, typename Entry_t> static void TestUnreadable(const char* Layout) { // The walk of a list ends at a link to an entry which cannot be read, keeping the entries before it
+	Image_t Image;
+	LoaderList Loader;
+	uint64_t qwFirst = Image.AddEntry(0x400000, 0x401000, 0x20000, L"app.exe", L"C:\\App\\app.exe");
+	uint64_t qwSecond = Image.AddEntry(0x77000000, 0, 0x1A0000, L"ntdll.dll", L"C:\\Windows\\System32\\ntdll.dll");
+	uint64_t qwUnreadable = 0x60000000;
+
+	Image.LinkLoadOrder({ qwFirst, qwSecond });
+	Image.SetLink(qwFirst + offsetof(Entry_t, InLoadOrderLinks), qwUnreadable + offsetof(Entry_t, InLoadOrderLinks));
+	Image.LinkMemoryOrder({ qwFirst, qwSecond });
+
+	printf("%s: unreadable entry\n", Layout);
+	CHECK(Walk(Loader, Image));
+	CHECK(Loader.GetModules().size() == 2);
+	CHECK(IsModule(Loader.Find(reinterpret_cast<const void*>(0x400000)), 0x401000, 0x20000, L"app.exe", L"C:\\App\\app.exe", true, true));
+	CHECK(IsModule(Loader.Find(reinterpret_cast<const void*>(0x77000000)), 0, 0x1A0000, L"ntdll.dll", L"C:\\Windows\\System32\\ntdll.dll", false, true));
+
+	// An entry whose names cannot be read is still collected, with empty names
+
+	Image_t NamelessImage;
+	LoaderList NamelessLoader;
+	Entry_t Entry = { 0 };
+	uint64_t qwNameless = NamelessImage.AddEntry(0x400000, 0x401000, 0x20000, L"app.exe", L"C:\\App\\app.exe");
+
+	NamelessImage.Memory.Read(qwNameless, &Entry, sizeof(Entry));
+	SetName(Entry.BaseDllName, qwUnreadable, 14);
+	NamelessImage.Memory.Write(qwNameless, &Entry, sizeof(Entry));
+	NamelessImage.LinkLoadOrder({ qwNameless });
+
+	CHECK(Walk(NamelessLoader, NamelessImage));
+	CHECK(IsModule(NamelessLoader.Find(reinterpret_cast<const void*>(0x400000)), 0x401000, 0x20000, L"", L"C:\\App\\app.exe", true, false));
+
+	// A PEB whose loader data cannot be read has no list to walk
+
+	Image_t NoLdrImage;
+	LoaderList NoLdrLoader;
+
+	NoLdrImage.SetLdr(qwUnreadable);
+	CHECK(Walk(NoLdrLoader, NoLdrImage));
+	CHECK(NoLdrLoader.GetModules().empty());
+	CHECK(!NoLdrLoader.Walk32(NoLdrImage.Memory.GetReader(), 0x60000000));
+	CHECK(!NoLdrLoader.Walk64(NoLdrImage.Memory.GetReader(), 0x60000000));
+}
+
+template<typename Image_t, typename Entry_t> static void TestLayout(const char* Layout) {
+	TestMerge<Image_t, Entry_t>(Layout);
+	TestCycle<Image_t, Entry_t>(Layout);
+	TestUnreadable<Image_t, Entry_t>(Layout);
+}
+
+int main() {
+	TestLayout<LoaderImage<PEB32, PEB_LDR_DATA32, LDR_DATA_TABLE_ENTRY32, uint32_t>, LDR_DATA_TABLE_ENTRY32>("PEB32");
+	TestLayout<LoaderImage<PEB64, PEB_LDR_DATA64, LDR_DATA_TABLE_ENTRY64, uint64_t>, LDR_DATA_TABLE_ENTRY64>("PEB64");
+	printf("%s\n", nFailures ? "FAILED" : "PASSED");
+	return nFailures ? 1 : 0;
+}
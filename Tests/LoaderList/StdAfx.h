@@ -0,0 +1,49 @@
+#pragma once
+
+// Stands in for the precompiled header of the project when the loader list is built off Windows by the Makefile alongside: the C++ headers it uses, and the
+// Win32 types named by PEB.h with their Windows sizes. Only the PEB, loader data and loader entry layouts are relied upon, and the test checks their offsets.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <functional>
+#include <algorithm>
+#include <memory>
+
+typedef uint8_t BYTE;
+typedef uint8_t BOOLEAN;
+typedef char CHAR;
+typedef uint16_t WORD;
+typedef uint16_t WCHAR;
+typedef uint32_t DWORD;
+typedef int32_t INT32;
+typedef int32_t NTSTATUS;
+typedef uint32_t LCID;
+typedef void* HANDLE;
+typedef uintptr_t KAFFINITY;
+
+typedef union _LARGE_INTEGER { struct { DWORD LowPart; INT32 HighPart; } u; int64_t QuadPart; } LARGE_INTEGER;
+typedef union _ULARGE_INTEGER { struct { DWORD LowPart; DWORD HighPart; } u; uint64_t QuadPart; } ULARGE_INTEGER;
+typedef struct _LIST_ENTRY { struct _LIST_ENTRY* Flink; struct _LIST_ENTRY* Blink; } LIST_ENTRY;
+typedef struct LIST_ENTRY32 { DWORD Flink; DWORD Blink; } LIST_ENTRY32;
+typedef struct LIST_ENTRY64 { uint64_t Flink; uint64_t Blink; } LIST_ENTRY64;
+typedef struct _STRING { WORD Length; WORD MaximumLength; CHAR* Buffer; } STRING;
+typedef struct _UNICODE_STRING { WORD Length; WORD MaximumLength; WCHAR* Buffer; } UNICODE_STRING;
+typedef struct _GUID { DWORD Data1; WORD Data2; WORD Data3; BYTE Data4[8]; } GUID;
+typedef struct _PROCESSOR_NUMBER { WORD Group; BYTE Number; BYTE Reserved; } PROCESSOR_NUMBER;
+typedef struct _CLIENT_ID { HANDLE UniqueProcess; HANDLE UniqueThread; } CLIENT_ID;
+typedef enum _EXCEPTION_DISPOSITION { ExceptionContinueExecution, ExceptionContinueSearch, ExceptionNestedException, ExceptionCollidedUnwind } EXCEPTION_DISPOSITION;
+typedef struct _EXCEPTION_RECORD EXCEPTION_RECORD;
+typedef struct _EXCEPTION_POINTERS EXCEPTION_POINTERS;
+typedef struct _CONTEXT CONTEXT;
+typedef struct _DISPATCHER_CONTEXT DISPATCHER_CONTEXT;
+typedef struct _TEB TEB;
+typedef struct _PEB PEB;
+
+#define STDCALL
+#define CDECL
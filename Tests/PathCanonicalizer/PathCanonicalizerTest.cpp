@@ -0,0 +1,123 @@
+/*
+ Translates device paths and redirects Wow64 paths through canonicalizers built from injected tables, in place of those GetSystem builds from the object
+ manager and the environment. The canonicalizer does not otherwise use the Win32 API, so the test builds and runs off Windows: see the Makefile alongside.
+*/
+
+#include "Portable.h"
+#include "PathCanonicalizer.hpp"
+
+using namespace std;
+
+static int32_t nFailures = 0;
+
+#define CHECK(Condition) do { if (!(Condition)) { printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #Condition); nFailures++; } } while (0)
+
+static const size_t MaxPath = 260;
+
+static bool Translates(const PathCanonicalizer& Paths, const wchar_t* DevicePath, const wchar_t* Expected) { // An expected path of nullptr requires the translation to fail
+	wchar_t TranslatedPath[MaxPath + 1] = { 0 };
+	bool bTranslated = Paths.TranslateDevicePath(DevicePath, TranslatedPath, MaxPath + 1);
+	return Expected != nullptr ? bTranslated && wcscmp(TranslatedPath, Expected) == 0 : !bTranslated;
+}
+
+static bool Redirects(const PathCanonicalizer& Paths, const wchar_t* TargetFilePath, const wchar_t* Expected) {
+	wchar_t OutputPath[MaxPath + 1] = { 0 };
+	return Paths.Wow64Redirect(TargetFilePath, OutputPath, MaxPath + 1) && wcscmp(OutputPath, Expected) == 0;
+}
+
+static void TestComponentBoundary() { // A prefix only matches whole components: HarddiskVolume1 is not a prefix of HarddiskVolume10
+	PathCanonicalizer Paths;
+
+	Paths.AddDevice(L"\\Device\\HarddiskVolume1", L"C:");
+	CHECK(Translates(Paths, L"\\Device\\HarddiskVolume1\\Windows\\notepad.exe", L"C:\\Windows\\notepad.exe"));
+	CHECK(Translates(Paths, L"\\Device\\HarddiskVolume1", L"C:"));
+	CHECK(Translates(Paths, L"\\Device\\HarddiskVolume10\\Windows\\notepad.exe", nullptr));
+	CHECK(Translates(Paths, L"\\Device\\HarddiskVolume", nullptr));
+
+	Paths.AddDevice(L"\\Device\\HarddiskVolume10", L"D:");
+	CHECK(Translates(Paths, L"\\Device\\HarddiskVolume10\\Windows\\notepad.exe", L"D:\\Windows\\notepad.exe"));
+	CHECK(Translates(Paths, L"\\Device\\HarddiskVolume1\\Windows\\notepad.exe", L"C:\\Windows\\notepad.exe"));
+	CHECK(Translates(Paths, L"\\Device\\HarddiskVolume100\\Windows\\notepad.exe", nullptr));
+	CHECK(Paths.GetDeviceCount() == 2);
+}
+
+static void TestLongestMatch() { // Whatever the order in which overlapping prefixes are added
+	PathCanonicalizer ShortFirst, LongFirst;
+
+	ShortFirst.AddDevice(L"\\Device\\LanmanRedirector", L"\\");
+	ShortFirst.AddDevice(L"\\Device\\LanmanRedirector\\;Z:0000000000012345\\server\\share", L"Z:");
+	LongFirst.AddDevice(L"\\Device\\LanmanRedirector\\;Z:0000000000012345\\server\\share", L"Z:");
+	LongFirst.AddDevice(L"\\Device\\LanmanRedirector", L"\\");
+
+	CHECK(Translates(ShortFirst, L"\\Device\\LanmanRedirector\\;Z:0000000000012345\\server\\share\\tool.dll", L"Z:\\tool.dll"));
+	CHECK(Translates(LongFirst, L"\\Device\\LanmanRedirector\\;Z:0000000000012345\\server\\share\\tool.dll", L"Z:\\tool.dll"));
+	CHECK(Translates(ShortFirst, L"\\Device\\LanmanRedirector\\other\\share\\tool.dll", L"\\\\other\\share\\tool.dll"));
+	CHECK(Translates(LongFirst, L"\\Device\\LanmanRedirector\\;Z:0000000000012345\\server\\shared\\tool.dll", L"\\\\;Z:0000000000012345\\server\\shared\\tool.dll"));
+}
+
+static void TestCaseFolding() { // Prefixes match in any case, and the remainder of the path keeps its own
+	PathCanonicalizer Paths;
+
+	Paths.AddDevice(L"\\Device\\HarddiskVolume3", L"C:");
+	Paths.AddWow64Redirect(L"C:\\Windows\\System32", L"C:\\Windows\\SysWOW64");
+	CHECK(Translates(Paths, L"\\DEVICE\\harddiskvolume3\\Windows\\Explorer.EXE", L"C:\\Windows\\Explorer.EXE"));
+	CHECK(Redirects(Paths, L"c:\\WINDOWS\\system32\\Ntdll.dll", L"C:\\Windows\\SysWOW64\\Ntdll.dll"));
+
+	Paths.AddDevice(L"\\DEVICE\\HARDDISKVOLUME3", L"E:"); // The same prefix in another case: the first entry is kept, as with the first drive letter of a device
+	CHECK(Paths.GetDeviceCount() == 1);
+	CHECK(Translates(Paths, L"\\Device\\HarddiskVolume3\\a.dll", L"C:\\a.dll"));
+}
+
+static void TestTrailingSeparator() { // A prefix given with a trailing separator matches the same components as one without
+	PathCanonicalizer Paths;
+
+	Paths.AddWow64Redirect(L"C:\\Windows\\System32\\", L"C:\\Windows\\SysWOW64");
+	CHECK(Redirects(Paths, L"C:\\Windows\\System32\\kernel32.dll", L"C:\\Windows\\SysWOW64\\kernel32.dll"));
+	CHECK(Redirects(Paths, L"C:\\Windows\\System32", L"C:\\Windows\\SysWOW64"));
+	CHECK(Redirects(Paths, L"C:\\Windows\\System32x\\kernel32.dll", L"C:\\Windows\\System32x\\kernel32.dll"));
+
+	Paths.AddWow64Redirect(L"\\\\", L"X:"); // Nothing but separators: there is no component to match
+	CHECK(Paths.GetRedirectCount() == 1);
+}
+
+static void TestOutputSize() { // The output must hold the rewritten path and its terminator
+	PathCanonicalizer Paths;
+	const wchar_t* DevicePath = L"\\Device\\HarddiskVolume2\\Tools\\a.exe";
+	const wchar_t* ExpectedPath = L"C:\\Tools\\a.exe";
+	size_t ccExact = wcslen(ExpectedPath) + 1;
+	wchar_t OutputPath[MaxPath + 1];
+
+	Paths.AddDevice(L"\\Device\\HarddiskVolume2", L"C:");
+	wmemset(OutputPath, L'#', MaxPath + 1);
+	CHECK(Paths.TranslateDevicePath(DevicePath, OutputPath, ccExact) && wcscmp(OutputPath, ExpectedPath) == 0);
+
+	wmemset(OutputPath, L'#', MaxPath + 1);
+	CHECK(!Paths.TranslateDevicePath(DevicePath, OutputPath, ccExact - 1));
+	CHECK(OutputPath[0] == L'#'); // Nothing is written on failure
+
+	CHECK(Paths.Wow64Redirect(ExpectedPath, OutputPath, ccExact) && wcscmp(OutputPath, ExpectedPath) == 0); // Copied unchanged
+	CHECK(!Paths.Wow64Redirect(ExpectedPath, OutputPath, ccExact - 1));
+}
+
+static void TestProgramFiles() { // The 64-bit program files folder is a prefix of the name of the 32-bit one, but not of its path
+	PathCanonicalizer Paths;
+
+	Paths.AddWow64Redirect(L"C:\\Windows\\System32", L"C:\\Windows\\SysWOW64");
+	Paths.AddWow64Redirect(L"C:\\Program Files", L"C:\\Program Files (x86)");
+	CHECK(Redirects(Paths, L"C:\\Program Files\\Vendor\\app.exe", L"C:\\Program Files (x86)\\Vendor\\app.exe"));
+	CHECK(Redirects(Paths, L"C:\\Program Files (x86)\\Vendor\\app.exe", L"C:\\Program Files (x86)\\Vendor\\app.exe"));
+	CHECK(Redirects(Paths, L"C:\\Program Files (x86)", L"C:\\Program Files (x86)"));
+	CHECK(Redirects(Paths, L"D:\\Program Files\\Vendor\\app.exe", L"D:\\Program Files\\Vendor\\app.exe"));
+	CHECK(Paths.GetRedirectCount() == 2);
+}
+
+int main() {
+	TestComponentBoundary();
+	TestLongestMatch();
+	TestCaseFolding();
+	TestTrailingSeparator();
+	TestOutputSize();
+	TestProgramFiles();
+	printf("%s\n", nFailures ? "FAILED" : "PASSED");
+	return nFailures ? 1 : 0;
+}
@@ -0,0 +1,113 @@
+/*
+ Measures the throughput of PointerScan::Find in GB/s with each instruction set the CPU supports, against the scalar kernel, on two kinds of buffer: random
+ data, in which almost no value shares the high bits of the target range, and pointer-dense data resembling a heap, in which every pointer-sized value is an
+ address near the target range and roughly one in four thousand falls within it. The offsets found by every kernel are checked against those of the scalar
+ one, so that a faster kernel which misses hits does not go unnoticed.
+
+ Usage: PointerScanBench [buffer size in MB] [runs]
+*/
+
+#include "StdAfx.h"
+#include "PointerScan.hpp"
+#include <chrono>
+#include <random>
+
+using namespace std;
+
+static int32_t nFailures = 0;
+
+static const uint64_t qwTargetBase = 0x000001F0C4350000; // A target range within a heap-like region of 256MB, with the same high dword as every address in it
+static const uint32_t dwTargetSize = 0x10000;
+static const uint32_t dwRegionSize = 0x10000000;
+
+static vector<uint8_t> RandomBuffer(size_t cbBuf, mt19937_64& Generator) {
+	vector<uint8_t> Buf(cbBuf);
+
+	for (size_t nOffset = 0; nOffset + 8 <= cbBuf; nOffset += 8) {
+		uint64_t qwValue = Generator();
+		memcpy(&Buf[nOffset], &qwValue, 8);
+	}
+
+	return Buf;
+}
+
+static vector<uint8_t> PointerDenseBuffer(size_t cbBuf, uint32_t dwPointerSize, mt19937_64& Generator) {
+	uint64_t qwRegionBase = (qwTargetBase & ~static_cast<uint64_t>(dwRegionSize - 1));
+	vector<uint8_t> Buf(cbBuf);
+
+	if (dwPointerSize == 4) {
+		qwRegionBase &= 0xFFFFFFFF;
+	}
+
+	for (size_t nOffset = 0; nOffset + dwPointerSize <= cbBuf; nOffset += dwPointerSize) {
+		uint64_t qwRandom = Generator();
+		uint64_t qwValue = ((qwRandom >> 32) % 4096 == 0) ? qwTargetBase + (qwRandom % dwTargetSize) : qwRegionBase + (qwRandom % dwRegionSize);
+
+		memcpy(&Buf[nOffset], &qwValue, dwPointerSize);
+	}
+
+	return Buf;
+}
+
+static double Bench(const PointerScan& Scanner, const vector<uint8_t>& Buf, const uint8_t* pTarget, int32_t nRuns, vector<uint32_t>& Offsets) { // Returns the throughput of the fastest run in GB/s
+	double dBestSeconds = 0.0;
+
+	for (int32_t nRun = 0; nRun < nRuns; nRun++) {
+		Offsets.clear();
+		chrono::steady_clock::time_point StartTime = chrono::steady_clock::now();
+		Scanner.Find(Buf.data(), Buf.size(), pTarget, dwTargetSize, Offsets);
+		double dSeconds = chrono::duration<double>(chrono::steady_clock::now() - StartTime).count();
+
+		if (!nRun || dSeconds < dBestSeconds) {
+			dBestSeconds = dSeconds;
+		}
+	}
+
+	return Buf.size() / dBestSeconds / 1e9;
+}
+
+int main(int nArgc, char** pArgv) {
+	size_t cbBuf = (nArgc > 1 ? strtoul(pArgv[1], nullptr, 10) : 64) * 0x100000;
+	int32_t nRuns = (nArgc > 2 ? atoi(pArgv[2]) : 5);
+	PointerScan::Isa_t DetectedIsa = PointerScan::GetIsa();
+	mt19937_64 Generator(0x4D6F6E657461); // Fixed seed, so that runs are comparable
+	const uint8_t* pTarget = reinterpret_cast<const uint8_t*>(static_cast<uintptr_t>(qwTargetBase));
+
+	printf("%d MB buffers, best of %d runs, detected kernel %ls\n\n", static_cast<int32_t>(cbBuf / 0x100000), nRuns, PointerScan::IsaSymbol(DetectedIsa));
+	printf("%-14s %-8s %-9s %-7s %10s %10s %8s\n", "Buffer", "Pointer", "Offsets", "Kernel", "Hits", "GB/s", "Speedup");
+
+	for (uint32_t dwPointerSize : { 4u, 8u }) {
+		vector<uint8_t> RandomBuf = RandomBuffer(cbBuf, Generator), DenseBuf = PointerDenseBuffer(cbBuf, dwPointerSize, Generator);
+		const pair<const char*, const vector<uint8_t>*> Buffers[] = { make_pair("Random", &RandomBuf), make_pair("Pointer-dense", &DenseBuf) };
+
+		for (size_t nBuf = 0; nBuf < sizeof(Buffers) / sizeof(Buffers[0]); nBuf++) {
+			for (bool bAligned : { true, false }) {
+				PointerScan Scanner(dwPointerSize, bAligned);
+				vector<uint32_t> ScalarOffsets, Offsets;
+				double dScalarRate = 0.0;
+
+				for (PointerScan::Isa_t Isa : { PointerScan::Isa_t::Scalar, PointerScan::Isa_t::Sse2, PointerScan::Isa_t::Avx2 }) {
+					if (Isa > DetectedIsa) {
+						continue;
+					}
+
+					PointerScan::SetIsa(Isa);
+					double dRate = Bench(Scanner, *Buffers[nBuf].second, pTarget, nRuns, Isa == PointerScan::Isa_t::Scalar ? ScalarOffsets : Offsets);
+
+					if (Isa == PointerScan::Isa_t::Scalar) {
+						dScalarRate = dRate;
+					}
+					else if (Offsets != ScalarOffsets) {
+						printf("%ls kernel offsets differ from those of the scalar kernel\n", PointerScan::IsaSymbol(Isa));
+						nFailures++;
+					}
+
+					printf("%-14s %-8d %-9s %-7ls %10d %10.2f %7.2fx\n", Buffers[nBuf].first, static_cast<int32_t>(dwPointerSize), bAligned ? "Aligned" : "Any", PointerScan::IsaSymbol(Isa), static_cast<int32_t>(ScalarOffsets.size()), dRate, dRate / dScalarRate);
+				}
+			}
+		}
+	}
+
+	PointerScan::SetIsa(DetectedIsa);
+	return nFailures ? 1 : 0;
+}
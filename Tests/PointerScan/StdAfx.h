@@ -0,0 +1,19 @@
+#pragma once
+
+// Stands in for the precompiled header of the project when the pointer scan is built off Windows by the Makefile alongside: the portable headers, the
+// intrinsics, and the MSVC CPUID and XGETBV intrinsics in terms of those of GCC and Clang.
+
+#include "Portable.h"
+#include <limits.h>
+#include <immintrin.h>
+#include <cpuid.h>
+
+#undef __cpuid
+
+static inline void MsvcCpuidEx(int32_t* pCpuInfo, int32_t nLeaf, int32_t nSubleaf) {
+	__cpuid_count(nLeaf, nSubleaf, pCpuInfo[0], pCpuInfo[1], pCpuInfo[2], pCpuInfo[3]);
+}
+
+#define __cpuid(CpuInfo, Leaf) MsvcCpuidEx(CpuInfo, Leaf, 0)
+#define __cpuidex(CpuInfo, Leaf, Subleaf) MsvcCpuidEx(CpuInfo, Leaf, Subleaf)
+#define _xgetbv(Register) __builtin_ia32_xgetbv(Register)
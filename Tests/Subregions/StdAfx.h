@@ -0,0 +1,87 @@
+#pragma once
+
+// Stands in for the precompiled header of the project when the subregions are built off Windows by the Makefile alongside: the C++ headers they use, and the
+// Win32 types and constants named by Memory.hpp and Processes.hpp. The working set query of psapi is supplied by the test.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <string.h>
+#include <assert.h>
+#include <string>
+#include <vector>
+#include <list>
+#include <map>
+#include <memory>
+#include <bitset>
+#include <atomic>
+#include <mutex>
+#include <algorithm>
+#include <type_traits>
+
+typedef void* HANDLE;
+typedef int32_t BOOL;
+typedef uint32_t DWORD;
+typedef uintptr_t SIZE_T;
+typedef uintptr_t ULONG_PTR;
+
+#define TRUE 1
+#define FALSE 0
+
+#define MEM_COMMIT 0x1000
+#define MEM_RESERVE 0x2000
+#define MEM_FREE 0x10000
+#define MEM_PRIVATE 0x20000
+#define MEM_MAPPED 0x40000
+#define MEM_IMAGE 0x1000000
+
+#define PAGE_NOACCESS 0x01
+#define PAGE_READONLY 0x02
+#define PAGE_READWRITE 0x04
+#define PAGE_WRITECOPY 0x08
+#define PAGE_EXECUTE 0x10
+#define PAGE_EXECUTE_READ 0x20
+#define PAGE_EXECUTE_READWRITE 0x40
+#define PAGE_EXECUTE_WRITECOPY 0x80
+#define PAGE_GUARD 0x100
+#define PAGE_NOCACHE 0x200
+#define PAGE_WRITECOMBINE 0x400
+
+typedef struct _MEMORY_BASIC_INFORMATION {
+	void* BaseAddress;
+	void* AllocationBase;
+	DWORD AllocationProtect;
+	SIZE_T RegionSize;
+	DWORD State;
+	DWORD Protect;
+	DWORD Type;
+} MEMORY_BASIC_INFORMATION;
+
+typedef union _PSAPI_WORKING_SET_EX_BLOCK {
+	ULONG_PTR Flags;
+	struct {
+		ULONG_PTR Valid : 1;
+		ULONG_PTR ShareCount : 3;
+		ULONG_PTR Win32Protection : 11;
+		ULONG_PTR Shared : 1;
+		ULONG_PTR Node : 6;
+		ULONG_PTR Locked : 1;
+		ULONG_PTR LargePage : 1;
+	};
+} PSAPI_WORKING_SET_EX_BLOCK;
+
+typedef struct _PSAPI_WORKING_SET_EX_INFORMATION {
+	void* VirtualAddress;
+	PSAPI_WORKING_SET_EX_BLOCK VirtualAttributes;
+} PSAPI_WORKING_SET_EX_INFORMATION;
+
+typedef struct _MODULEINFO {
+	void* lpBaseOfDll;
+	DWORD SizeOfImage;
+	void* EntryPoint;
+} MODULEINFO;
+
+struct _IMAGE_SECTION_HEADER;
+typedef struct _IMAGE_SECTION_HEADER IMAGE_SECTION_HEADER;
+
+BOOL K32QueryWorkingSetEx(HANDLE hProcess, void* pv, DWORD cb); // Supplied by the test, which counts the calls made
@@ -0,0 +1,234 @@
+/*
+ Counts the K32QueryWorkingSetEx calls made to find the private pages of the subregions of a synthetic address space, and compares them with those of the
+ page by page query which Subregion::QueryPrivatePages replaced. The address space holds image subregions of various sizes and protections alongside
+ mapped, private and reserved ones, and each page of it is either shared or private according to a fixed pattern, so that the private page bitmap and
+ private size of every subregion can also be checked against the pattern. A replacement page attribute provider is then checked to receive every query.
+
+ The test supplies K32QueryWorkingSetEx, Interface::Log and the constructor of Process (which only opens a fake handle), so that the subregions build and
+ run off Windows: see the Makefile alongside.
+*/
+
+#include "StdAfx.h"
+#include "Memory.hpp"
+#include "Interface.hpp"
+#include "Processes.hpp"
+#include "Arena.hpp"
+
+using namespace std;
+using namespace Memory;
+using namespace Processes;
+
+static int32_t nFailures = 0;
+
+#define CHECK(Condition) do { if (!(Condition)) { printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #Condition); nFailures++; } } while (0)
+
+//
+// Fake process
+//
+
+static HANDLE const hFakeProcess = reinterpret_cast<HANDLE>(static_cast<uintptr_t>(0x1234));
+static uint8_t* const pUnqueryableBase = reinterpret_cast<uint8_t*>(static_cast<uintptr_t>(0x7FF700000000)); // The working set query of the subregion at this base fails
+static uint64_t qwQueryCalls = 0;
+static uint64_t qwQueriedPages = 0;
+static int32_t nLogCount = 0;
+
+static bool IsPrivatePage(const void* pPage) { // Roughly one page in five has been written to since the image was mapped
+	uintptr_t nPage = reinterpret_cast<uintptr_t>(pPage) / 0x1000;
+	return (nPage * 2654435761U) % 5 == 0;
+}
+
+BOOL K32QueryWorkingSetEx(HANDLE hProcess, void* pv, DWORD cb) {
+	PSAPI_WORKING_SET_EX_INFORMATION* pPages = static_cast<PSAPI_WORKING_SET_EX_INFORMATION*>(pv);
+	size_t nPageCount = cb / sizeof(PSAPI_WORKING_SET_EX_INFORMATION);
+
+	qwQueryCalls++;
+	qwQueriedPages += nPageCount;
+
+	if (hProcess != hFakeProcess || (nPageCount && static_cast<uint8_t*>(pPages[0].VirtualAddress) == pUnqueryableBase)) {
+		return FALSE;
+	}
+
+	for (size_t nX = 0; nX < nPageCount; nX++) {
+		pPages[nX].VirtualAttributes.Flags = 0;
+		pPages[nX].VirtualAttributes.Valid = 1;
+		pPages[nX].VirtualAttributes.Shared = IsPrivatePage(pPages[nX].VirtualAddress) ? 0 : 1;
+	}
+
+	return TRUE;
+}
+
+bool Interface::Log(VerbosityLevel MsgVlvl, const char* LogFormat, ...) {
+	nLogCount++;
+	return true;
+}
+
+Process::Process(uint32_t dwPid, const SystemSnapshot& Snapshot) : Pid(dwPid), Handle(hFakeProcess), Wow64(FALSE), DmpCtx(nullptr), Regions(nullptr), RefIndex(nullptr), PageCache(nullptr), Loader(nullptr), ClrVersion(0), ImageBase(nullptr) {}
+
+Process::~Process() {}
+
+//
+// Address space
+//
+
+struct SyntheticRegion {
+	uintptr_t Base;
+	SIZE_T Size;
+	uint32_t State;
+	uint32_t Type;
+	uint32_t Protect;
+	bool Queried; // Whether the private pages of the subregion are expected to be queried
+};
+
+static const SyntheticRegion Regions[] = {
+	{ 0x7FF600000000, 0x1000, MEM_COMMIT, MEM_IMAGE, PAGE_READONLY, true }, // Headers
+	{ 0x7FF600001000, 0x1E00000, MEM_COMMIT, MEM_IMAGE, PAGE_EXECUTE_READ, true }, // A 30MB .text section
+	{ 0x7FF601E01000, 0x3000, MEM_COMMIT, MEM_IMAGE, PAGE_READWRITE, true },
+	{ 0x7FF601E04000, 0x2000, MEM_COMMIT, MEM_IMAGE, PAGE_WRITECOPY, true },
+	{ 0x7FF601E06000, 0x1000, MEM_COMMIT, MEM_IMAGE, PAGE_NOACCESS, false },
+	{ 0x7FF601E07000, 0x9000, MEM_RESERVE, MEM_IMAGE, 0, false },
+	{ 0x7FF700000000, 0x4000, MEM_COMMIT, MEM_IMAGE, PAGE_EXECUTE_READ, true }, // Unqueryable
+	{ 0x7FF800000000, 0x12000, MEM_COMMIT, MEM_IMAGE, PAGE_EXECUTE_WRITECOPY, true },
+	{ 0x000001F000000000, 0x100000, MEM_COMMIT, MEM_MAPPED, PAGE_READONLY, false },
+	{ 0x000001F100000000, 0x40000, MEM_COMMIT, MEM_PRIVATE, PAGE_READWRITE, false }
+};
+
+static const size_t RegionCount = sizeof(Regions) / sizeof(Regions[0]);
+
+static uint32_t ExpectedPrivateSize(const SyntheticRegion& Region) {
+	uint32_t dwPrivateSize = 0;
+
+	for (uintptr_t nPage = Region.Base; nPage < Region.Base + Region.Size; nPage += 0x1000) {
+		dwPrivateSize += IsPrivatePage(reinterpret_cast<void*>(nPage)) ? 0x1000 : 0;
+	}
+
+	return dwPrivateSize;
+}
+
+static uint32_t QueryPrivateSizeByPage(HANDLE hProcess, const MEMORY_BASIC_INFORMATION& Mbi) { // The query which Subregion::QueryPrivatePages replaced: one call per page
+	uint32_t dwPrivateSize = 0;
+
+	if (Mbi.State == MEM_COMMIT && Mbi.Protect != PAGE_NOACCESS && Mbi.Type == MEM_IMAGE) {
+		PSAPI_WORKING_SET_EX_INFORMATION WorkingSets = { 0 };
+
+		for (uint32_t dwPageOffset = 0; dwPageOffset < Mbi.RegionSize; dwPageOffset += 0x1000) {
+			WorkingSets.VirtualAddress = (static_cast<uint8_t*>(Mbi.BaseAddress) + dwPageOffset);
+
+			if (K32QueryWorkingSetEx(hProcess, &WorkingSets, sizeof(PSAPI_WORKING_SET_EX_INFORMATION))) {
+				if (!WorkingSets.VirtualAttributes.Shared) {
+					dwPrivateSize += 0x1000;
+				}
+			}
+		}
+	}
+
+	return dwPrivateSize;
+}
+
+class CountingProvider : public PageAttributeProvider { // Marks every page as private without calling K32QueryWorkingSetEx
+public:
+	bool Query(HANDLE hProcess, PSAPI_WORKING_SET_EX_INFORMATION* pPages, size_t nPageCount) {
+		this->QueryCount++;
+		this->PageCount += nPageCount;
+
+		for (size_t nX = 0; nX < nPageCount; nX++) {
+			pPages[nX].VirtualAttributes.Flags = 0;
+		}
+
+		return true;
+	}
+};
+
+int main() {
+	SystemSnapshot Snapshot;
+	Process FakeProc(4321, Snapshot);
+	RegionTable Table;
+	vector<unique_ptr<Subregion>> Subregions;
+	uint64_t qwExpectedQueries = 0, qwExpectedPages = 0;
+
+	for (size_t nX = 0; nX < RegionCount; nX++) {
+		MEMORY_BASIC_INFORMATION Mbi = { 0 };
+
+		Mbi.BaseAddress = reinterpret_cast<void*>(Regions[nX].Base);
+		Mbi.AllocationBase = Mbi.BaseAddress;
+		Mbi.RegionSize = Regions[nX].Size;
+		Mbi.State = Regions[nX].State;
+		Mbi.Type = Regions[nX].Type;
+		Mbi.Protect = Regions[nX].Protect;
+		Table.Append(Mbi);
+
+		if (Regions[nX].Queried) {
+			qwExpectedQueries++;
+			qwExpectedPages += Regions[nX].Size / 0x1000;
+		}
+	}
+
+	// After: the private pages of each subregion are queried once, when it is constructed
+
+	uint64_t qwProviderQueries = Subregion::GetPageProvider()->GetQueryCount(), qwProviderPages = Subregion::GetPageProvider()->GetPageCount();
+
+	for (size_t nX = 0; nX < RegionCount; nX++) {
+		Subregions.push_back(unique_ptr<Subregion>(new Subregion(FakeProc, &Table, nX, vector<Processes::Thread*>())));
+	}
+
+	uint64_t qwBatchedCalls = qwQueryCalls;
+
+	CHECK(qwQueryCalls == qwExpectedQueries);
+	CHECK(qwQueriedPages == qwExpectedPages);
+	CHECK(Subregion::GetPageProvider()->GetQueryCount() - qwProviderQueries == qwExpectedQueries);
+	CHECK(Subregion::GetPageProvider()->GetPageCount() - qwProviderPages == qwExpectedPages);
+	CHECK(nLogCount == 1); // The failed query of the unqueryable subregion
+
+	for (size_t nX = 0; nX < RegionCount; nX++) {
+		const Subregion& Sbr = *Subregions[nX];
+		bool bQueryable = Regions[nX].Queried && static_cast<uint8_t*>(Sbr.GetBase()) != pUnqueryableBase;
+
+		CHECK(Sbr.GetPrivateSize() == (bQueryable ? ExpectedPrivateSize(Regions[nX]) : 0));
+		CHECK(Sbr.GetPrivatePages().GetPageCount() == (Regions[nX].Queried ? Regions[nX].Size / 0x1000 : 0));
+
+		if (bQueryable) {
+			size_t nMismatches = 0;
+
+			for (size_t nPage = 0; nPage < Regions[nX].Size / 0x1000; nPage++) {
+				nMismatches += (Sbr.GetPrivatePages().Test(nPage) != IsPrivatePage(static_cast<uint8_t*>(Sbr.GetBase()) + nPage * 0x1000)) ? 1 : 0;
+			}
+
+			CHECK(nMismatches == 0);
+		}
+	}
+
+	// Before: one call per page of each subregion, with the same private sizes
+
+	qwQueryCalls = 0;
+
+	for (size_t nX = 0; nX < RegionCount; nX++) {
+		uint32_t dwPrivateSize = QueryPrivateSizeByPage(hFakeProcess, Table.GetBasic(nX));
+
+		if (static_cast<uint8_t*>(Table.GetBase(nX)) != pUnqueryableBase) {
+			CHECK(dwPrivateSize == Subregions[nX]->GetPrivateSize());
+		}
+	}
+
+	uint64_t qwPageCalls = qwQueryCalls;
+
+	CHECK(qwPageCalls == qwExpectedPages);
+	printf("%llu pages in %d queried subregions: %llu K32QueryWorkingSetEx calls page by page, %llu batched\n", static_cast<unsigned long long>(qwExpectedPages), static_cast<int32_t>(qwExpectedQueries), static_cast<unsigned long long>(qwPageCalls), static_cast<unsigned long long>(qwBatchedCalls));
+
+	// A replacement provider receives every query in place of K32QueryWorkingSetEx
+
+	CountingProvider Provider;
+	PageAttributeProvider* DefaultProvider = Subregion::GetPageProvider();
+
+	qwQueryCalls = 0;
+	Subregion::SetPageProvider(&Provider);
+	Subregion Text(FakeProc, &Table, 1, vector<Processes::Thread*>());
+	Subregion::SetPageProvider(DefaultProvider);
+
+	CHECK(qwQueryCalls == 0);
+	CHECK(Provider.GetQueryCount() == 1);
+	CHECK(Provider.GetPageCount() == Regions[1].Size / 0x1000);
+	CHECK(Text.GetPrivateSize() == Regions[1].Size);
+	CHECK(Text.GetPrivatePages().GetRuns().size() == 1 && Text.GetPrivatePages().GetRuns()[0].second == Regions[1].Size / 0x1000);
+
+	printf("%s\n", nFailures ? "FAILED" : "PASSED");
+	return nFailures ? 1 : 0;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+// Stands in for the precompiled header of the project when the task pool is built off Windows by the Makefile alongside: the C++ headers it uses, and the
+// Win32 handle type named by Interface.hpp.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <string.h>
+#include <assert.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <chrono>
+#include <exception>
+#include <stdexcept>
+
+typedef void* HANDLE;
@@ -0,0 +1,229 @@
+/*
+ Runs a synthetic scan through TaskPool::OrderedFor without workers and then on pools of several sizes, and checks that the log written by each parallel
+ run is identical to that of the serial one, including when targets fail. Each target logs, splits its work into subtasks with ParallelFor and takes a
+ different time to complete, so that the parallel runs complete their targets out of order.
+
+ The test supplies its own Interface::Log and Interface::Write, which append to a string in place of the console, so that the task pool builds and runs
+ off Windows: see the Makefile alongside. The output capture is the same as that of Interface.cpp.
+*/
+
+#include "StdAfx.h"
+#include "Interface.hpp"
+#include "TaskPool.hpp"
+#include "Privileges.h"
+
+using namespace std;
+
+static int32_t nFailures = 0;
+
+#define CHECK(Condition) do { if (!(Condition)) { printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #Condition); nFailures++; } } while (0)
+
+//
+// Log
+//
+
+static string LogText;
+
+thread_local Interface::OutputCapture* Interface::ActiveCapture = nullptr;
+mutex Interface::WriteLock;
+Interface::VerbosityLevel Interface::VerbosityLvl = Interface::VerbosityLevel::Surface;
+
+bool Interface::Write(const char* Text, bool bColored, ConsoleColor Color) {
+	if (Interface::ActiveCapture != nullptr) {
+		Interface::ActiveCapture->Append(Text, bColored, Color);
+		return true;
+	}
+
+	lock_guard<mutex> Guard(Interface::WriteLock);
+
+	if (bColored) {
+		LogText += "[" + to_string(static_cast<int32_t>(Color)) + "]";
+	}
+
+	LogText += Text;
+	return true;
+}
+
+bool Interface::Log(VerbosityLevel MsgVlvl, const char* LogFormat, ...) {
+	if (MsgVlvl <= Interface::VerbosityLvl) {
+		char LogBuffer[4000] = { 0 };
+		va_list VarList;
+
+		va_start(VarList, LogFormat);
+		vsnprintf(LogBuffer, sizeof(LogBuffer), LogFormat, VarList);
+		va_end(VarList);
+		return Interface::Write(LogBuffer, false, ConsoleColor::Turquoise);
+	}
+
+	return false;
+}
+
+bool Interface::Log(VerbosityLevel MsgVlvl, ConsoleColor Color, const char* LogFormat, ...) {
+	if (MsgVlvl <= Interface::VerbosityLvl) {
+		char LogBuffer[4000] = { 0 };
+		va_list VarList;
+
+		va_start(VarList, LogFormat);
+		vsnprintf(LogBuffer, sizeof(LogBuffer), LogFormat, VarList);
+		va_end(VarList);
+		return Interface::Write(LogBuffer, true, Color);
+	}
+
+	return false;
+}
+
+Interface::OutputCapture* Interface::SetCapture(OutputCapture* Capture) {
+	OutputCapture* PreviousCapture = Interface::ActiveCapture;
+	Interface::ActiveCapture = Capture;
+	return PreviousCapture;
+}
+
+void Interface::OutputCapture::Append(const char* Text, bool bColored, ConsoleColor Color) {
+	lock_guard<mutex> Guard(this->Lock);
+
+	if (!bColored && !this->Segments.empty() && !this->Segments.back().Colored) {
+		this->Segments.back().Text += Text;
+	}
+	else {
+		this->Segments.push_back(Segment{ Text, bColored, Color });
+	}
+}
+
+void Interface::OutputCapture::Flush() {
+	lock_guard<mutex> Guard(this->Lock);
+	OutputCapture* PreviousCapture = Interface::SetCapture(nullptr);
+
+	for (vector<Segment>::const_iterator Itr = this->Segments.begin(); Itr != this->Segments.end(); ++Itr) {
+		Interface::Write(Itr->Text.c_str(), Itr->Colored, Itr->Color);
+	}
+
+	Interface::SetCapture(PreviousCapture);
+	this->Segments.clear();
+}
+
+bool GrantSelfSeDebug() {
+	return true;
+}
+
+//
+// Synthetic scan
+//
+
+static const size_t TargetCount = 48;
+
+struct ScanResult {
+	string Log;
+	string Error; // Message of the exception re-thrown by OrderedFor
+	vector<size_t> Retired;
+	bool RetiredOnCaller;
+};
+
+static void ScanTarget(size_t nIndex) { // Mirrors ProcessScanner::ScanTarget: a target which cannot be scanned throws an integer, which is logged and does not fail the scan
+	Interface::Log(Interface::VerbosityLevel::Surface, "... scanning target %d\r\n", static_cast<int32_t>(nIndex));
+
+	try {
+		size_t nSubtaskCount = (nIndex % 5) * 40;
+		vector<uint64_t> Sums(nSubtaskCount, 0);
+
+		if (nIndex % 7 == 3) {
+			throw static_cast<int32_t>(nIndex);
+		}
+
+		if (nIndex == 20 || nIndex == 33) { // Any other exception fails the scan once every target has been written
+			throw runtime_error("target " + to_string(nIndex));
+		}
+
+		TaskPool::ParallelFor(nSubtaskCount, [nIndex, &Sums](size_t nSubtask) {
+			if (nIndex == 41 && nSubtask == 17) {
+				throw logic_error("subtask of target 41");
+			}
+
+			for (uint64_t qwX = 0; qwX < 1000 * (nSubtask % 3 + 1); qwX++) {
+				Sums[nSubtask] += qwX * nIndex;
+			}
+		});
+
+		this_thread::sleep_for(chrono::microseconds(((TargetCount - nIndex) % 4) * 500)); // Earlier targets tend to complete later
+		uint64_t qwTotal = 0;
+
+		for (vector<uint64_t>::const_iterator Itr = Sums.begin(); Itr != Sums.end(); ++Itr) {
+			qwTotal += *Itr;
+		}
+
+		Interface::Log(Interface::VerbosityLevel::Surface, Interface::ConsoleColor::Gold, "... target %d: %d subtasks, total %llu\r\n", static_cast<int32_t>(nIndex), static_cast<int32_t>(nSubtaskCount), static_cast<unsigned long long>(qwTotal));
+	}
+	catch (int32_t nError) {
+		Interface::Log(Interface::VerbosityLevel::Surface, Interface::ConsoleColor::Red, "... failed to scan target %d (error %d)\r\n", static_cast<int32_t>(nIndex), nError);
+	}
+}
+
+static ScanResult Scan(size_t nCount) {
+	ScanResult Result;
+	thread::id CallerId = this_thread::get_id();
+
+	LogText.clear();
+	Result.RetiredOnCaller = true;
+
+	try {
+		TaskPool::OrderedFor(nCount, ScanTarget, [&Result, CallerId](size_t nIndex) {
+			Interface::Log(Interface::VerbosityLevel::Surface, "... retired target %d\r\n", static_cast<int32_t>(nIndex));
+			Result.Retired.push_back(nIndex);
+			Result.RetiredOnCaller = Result.RetiredOnCaller && this_thread::get_id() == CallerId;
+		});
+	}
+	catch (const exception& Error) {
+		Result.Error = Error.what();
+	}
+
+	Result.Log = LogText;
+	return Result;
+}
+
+int main() {
+	thread([]() { // A lost completion shows up as a hang of OrderedFor
+		this_thread::sleep_for(chrono::minutes(2));
+		printf("TIMED OUT\n");
+		fflush(stdout);
+		_Exit(1);
+	}).detach();
+
+	vector<size_t> AllTargets;
+
+	for (size_t nX = 0; nX < TargetCount; nX++) {
+		AllTargets.push_back(nX);
+	}
+
+	ScanResult Serial = Scan(TargetCount);
+
+	CHECK(Serial.Error == "target 20");
+	CHECK(Serial.Retired == AllTargets);
+	CHECK(Serial.RetiredOnCaller);
+	CHECK(Serial.Log.find("[12]... failed to scan target 3 (error 3)\r\n... retired target 3\r\n") != string::npos);
+	CHECK(Serial.Log.find("... scanning target 33\r\n... retired target 33\r\n") != string::npos);
+	CHECK(Serial.Log.find("... target 41") == string::npos);
+	CHECK(Serial.Log.find("... retired target 47\r\n") != string::npos);
+
+	const uint32_t WorkerCounts[] = { 1, 3, 8 };
+
+	for (size_t nX = 0; nX < sizeof(WorkerCounts) / sizeof(WorkerCounts[0]); nX++) {
+		TaskPool::Initialize(WorkerCounts[nX]);
+		printf("%d workers\n", static_cast<int32_t>(WorkerCounts[nX]));
+
+		for (int32_t nRun = 0; nRun < 10; nRun++) {
+			ScanResult Parallel = Scan(TargetCount);
+
+			CHECK(Parallel.Log == Serial.Log);
+			CHECK(Parallel.Error == Serial.Error);
+			CHECK(Parallel.Retired == AllTargets);
+			CHECK(Parallel.RetiredOnCaller);
+		}
+
+		ScanResult Single = Scan(1); // A single target is scanned serially, as is an empty list
+		CHECK(Single.Log == Serial.Log.substr(0, Single.Log.size()) && Single.Retired.size() == 1 && Single.Error.empty());
+		CHECK(Scan(0).Log.empty());
+		TaskPool::Shutdown();
+	}
+
+	printf("%s\n", nFailures ? "FAILED" : "PASSED");
+	return nFailures ? 1 : 0;
+}